@@ -6,16 +6,17 @@
 //
 #include "P256.h"
 #include <assert.h>
+#include <stdatomic.h>
 
 const int use_toy_curve = 0;
 const int kill_randomness = 0;
 
 #ifdef DEBUG
-// temporary utilitary functions for simple allocation/deallocation check
-static int num_bn_allocated = 0;
-static int num_bn_freed = 0;
-static int num_point_allocated = 0;
-static int num_point_freed = 0;
+// temporary utilitary functions for simple allocation/deallocation check (atomic, since worker threads allocate too)
+static atomic_int num_bn_allocated = 0;
+static atomic_int num_bn_freed = 0;
+static atomic_int num_point_allocated = 0;
+static atomic_int num_point_freed = 0;
 // print utilitary information about bn_new/bn_free and point_new/point_free
 void print_allocation_status(void) {
     printf("BIGNUM allocation: %d new, %d free (%d unfreed)\n", num_bn_allocated, num_bn_freed, num_bn_allocated-num_bn_freed);
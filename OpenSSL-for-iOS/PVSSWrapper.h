@@ -16,6 +16,12 @@
 #import "nizk_dl_eq.h"
 #import "nizk_reshare.h"
 #import "dh_pvss.h"
+#import "dh_pvss_wire.h"
+#import "dh_pvss_cache.h"
+#import "dh_pvss_accumulator.h"
+#import "dh_pvss_handover.h"
+#import "dh_pvss_registry.h"
+#import "dh_pvss_remote.h"
 
 @interface PVSSWrapper: NSObject
 
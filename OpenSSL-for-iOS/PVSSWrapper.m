@@ -109,6 +109,12 @@ void* threadPerformanceTest(void* arg) {
     ret += nizk_dl_eq_test_suite(1);
     ret += nizk_reshare_test_suite(1);
     ret += dh_pvss_test_suite(1);
+    ret += dh_pvss_wire_test_suite(1);
+    ret += dh_pvss_cache_test_suite(1);
+    ret += dh_pvss_accumulator_test_suite(1);
+    ret += dh_pvss_handover_test_suite(1);
+    ret += dh_pvss_registry_test_suite(1);
+    ret += dh_pvss_remote_test_suite(1);
     clock_t end_time_total = clock();
     double elapsed_time_total = (double)(end_time_total - start_time_total) / CLOCKS_PER_SEC;
     
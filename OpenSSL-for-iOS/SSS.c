@@ -7,45 +7,55 @@
 #include "SSS.h"
 
 void shamir_shares_generate(const EC_GROUP *group, EC_POINT *shares[], const EC_POINT *secret, const int t, const int n, BN_CTX *ctx) {
-    const BIGNUM *order = get0_order(group);
-
     // sample coefficients
     BIGNUM *coeffs[t+1]; // coefficient container (on stack)
+    shamir_coeffs_generate(group, coeffs, t, ctx);
+
+    // make shares
+    shamir_shares_eval(group, shares, secret, (const BIGNUM **)coeffs, t, 0, n, ctx);
+
+    // cleanup
+    shamir_coeffs_free(coeffs, t);
+}
+
+void shamir_coeffs_generate(const EC_GROUP *group, BIGNUM *coeffs[], const int t, BN_CTX *ctx) {
+    const BIGNUM *order = get0_order(group);
+
     coeffs[0] = bn_new();
     BN_set_word(coeffs[0], 0);
     for (int i = 1; i < t + 1; i++){
         coeffs[i] = bn_random(order, ctx);
     }
+}
+
+void shamir_coeffs_free(BIGNUM *coeffs[], const int t) {
+    for (int i=0; i<t+1; i++){
+        bn_free(coeffs[i]);
+        coeffs[i] = NULL;
+    }
+}
+
+void shamir_shares_eval(const EC_GROUP *group, EC_POINT *shares[], const EC_POINT *secret, const BIGNUM *coeffs[], const int t, const int from, const int to, BN_CTX *ctx) {
+    const BIGNUM *order = get0_order(group);
 
-    // make shares
     BIGNUM *peval = bn_new(); // space for evaluating polynomial
-    BIGNUM *pterm = bn_new(); // space for storing polynomial terms
-    BIGNUM *base = bn_new(); // space for storing polynomial terms
-    BIGNUM *exp = bn_new(); // space for storing polynomial terms
     // make shares for user i, counting starts from 1, not 0
-    for (int i=1; i<=n; i++){
+    for (int i=from+1; i<=to; i++){
         BN_set_word(peval, 0); // reset space for reuse
 
-        // evaluate polynomial
-        for (int j=0; j<t+1; j++) { // coeff * i ** j
-            BN_set_word(base, i);
-            BN_set_word(exp, j);
-            BN_mod_exp(pterm, base, exp, order, ctx); // pterm = i^j mod order
-            BN_mod_mul(pterm, coeffs[j], pterm, order, ctx); // pterm *= coeff
-            BN_mod_add(peval, peval, pterm, order, ctx); // peval += pterm mod order
+        // evaluate polynomial (Horner's rule, i is a small integer)
+        for (int j=t; j>=0; j--) { // peval = peval * i + coeff
+            BN_mul_word(peval, (BN_ULONG)i);
+            BN_add(peval, peval, coeffs[j]);
+            BN_nnmod(peval, peval, order, ctx);
         }
-        shares[i-1] = bn2point(group, peval, ctx); // allocate new share = generator ^ peval
-        point_add(group, shares[i - 1], shares[i - 1], secret, ctx);
+        EC_POINT *share = bn2point(group, peval, ctx); // allocate new share = generator ^ peval
+        point_add(group, share, share, secret, ctx);
+        shares[i - from - 1] = share;
     }
 
     // cleanup
-    for (int i=0; i<t+1; i++){
-        bn_free(coeffs[i]);
-    }
     bn_free(peval);
-    bn_free(pterm);
-    bn_free(base);
-    bn_free(exp);
 }
 
 void lagX(const EC_GROUP *group, BIGNUM *prod, const int share_indexes[], int length, int i, BN_CTX *ctx) {
@@ -11,6 +11,10 @@
 
 // array of size n for resulting shares, the secret, and t and n
 void shamir_shares_generate(const EC_GROUP *group, EC_POINT *shares[], const EC_POINT *secret, const int t, const int n, BN_CTX *ctx);
+// the same in steps: sample the t+1 coefficients (coeffs[0] = 0), then evaluate shares for users from+1..to into shares[0..to-from-1]
+void shamir_coeffs_generate(const EC_GROUP *group, BIGNUM *coeffs[], const int t, BN_CTX *ctx);
+void shamir_shares_eval(const EC_GROUP *group, EC_POINT *shares[], const EC_POINT *secret, const BIGNUM *coeffs[], const int t, const int from, const int to, BN_CTX *ctx);
+void shamir_coeffs_free(BIGNUM *coeffs[], const int t);
 EC_POINT *shamir_shares_reconstruct(const EC_GROUP *group, const EC_POINT *shares[], const int shareIndexes[], const int t, const int length, BN_CTX *ctx);
 int shamir_shares_test_suite(int print);
 
@@ -6,8 +6,16 @@
 //
 #include "dh_pvss.h"
 #include <assert.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <openssl/rand.h>
 #include "SSS.h"
+#include "dh_pvss_wire.h"
 #include "openssl_hashing_tools.h"
+#include "parallel_tools.h"
 #include "platform_measurement_utils.h"
 
 #ifdef DEBUG
@@ -18,30 +26,69 @@ void nizk_print_allocation_status(void) {
 }
 #endif
 
+/* compact layout, the struct and all vectors live in a single allocation
+ *   alphas, betas:  n+1 evaluation points as plain integers, lifted to BIGNUMs on demand
+ *   vs, v_primes:   n scrape coefficients each, stored as contiguous fixed-width (scalar_len bytes, big endian) scalars */
+struct dh_pvss_params {
+    atomic_int references;
+    const EC_GROUP *group;
+    int n;
+    int scalar_len;
+    int *alphas;
+    int *betas;
+    unsigned char *vs;
+    unsigned char *v_primes;
+};
+
+// lift i:th fixed-width scalar of vector v to a BIGNUM
+static void params_scalar_lift(BIGNUM *r, const unsigned char *v, int i, int scalar_len) {
+    BIGNUM *ret = BN_bin2bn(v + (size_t)i * scalar_len, scalar_len, r);
+    assert(ret && "params_scalar_lift: BN_bin2bn failed");
+}
+
+dh_pvss_params *dh_pvss_params_up_ref(dh_pvss_params *params) {
+    assert(params && "dh_pvss_params_up_ref: usage error, no params passed");
+    atomic_fetch_add(&params->references, 1);
+    return params;
+}
+
+void dh_pvss_params_free(dh_pvss_params *params) {
+    if (params == NULL) {
+        return;
+    }
+    if (atomic_fetch_sub(&params->references, 1) > 1) {
+        return; // still referenced by other contexts
+    }
+    free(params); // vectors are part of the same allocation
+}
+
 void dh_pvss_ctx_free(dh_pvss_ctx *pp) {
-    bn_free_array(pp->n+1, pp->alphas);
-    bn_free_array(pp->n+1, pp->betas);
-    bn_free_array(pp->n+1, pp->v_primes);
-    bn_free_array(pp->n, pp->vs);
+    dh_pvss_params_free(pp->params);
+    pp->params = NULL; // superfluous assignment, increases likelihood of catching misusage
+}
+
+/* initialize dh pvss ctx with a (shared) reference to existing public parameters
+ * the context holds only t, the group and the reference, so no vectors are copied or allocated here */
+void dh_pvss_ctx_init(dh_pvss_ctx *pp, dh_pvss_params *params, const int t, BN_CTX *bn_ctx) {
+    assert(params && "dh_pvss_ctx_init: usage error, no params specified");
+    assert(bn_ctx && "dh_pvss_ctx_init: usage error, no BIGNUM context specified");
+    const int n = params->n;
+    assert( (n - t - 2) > 0 && "dh_pvss_ctx_init: usage error, n and t badly chosen");
+    pp->group = params->group;
+    pp->bn_ctx = bn_ctx;
+    pp->t = t;
+    pp->n = n;
+    pp->num_threads = 1;
+    pp->params = dh_pvss_params_up_ref(params);
 }
 
-/* make deep copy of dh pvss ctx
+/* make dh pvss ctx for a new t sharing the public parameters of src
  * useful when initializing dh pvss ctx for next epoch, when the same n is used, because then scrape coefficients do not need to be recalculated (they depend only on n) */
 void dh_pvss_ctx_copy(dh_pvss_ctx *dst, dh_pvss_ctx *src, int t) {
     assert(src && "dh_pvss_ctx_copy: usage error, no src");
     assert(dst && "dh_pvss_ctx_copy: usage error, no dst");
-    dst->group = src->group;
-    dst->bn_ctx = src->bn_ctx;
-    int n = src->n;
-    assert( (n - t - 2) > 0 && "dh_pvss_setup: usage error, n and t badly chosen");
-    dst->t = t;
-    dst->n = n;
-
-    // copy vectors
-    dst->alphas   = bn_copy_array(src->alphas, n+1);
-    dst->betas    = bn_copy_array(src->betas, n+1);
-    dst->v_primes = bn_copy_array(src->v_primes, n+1);
-    dst->vs       = bn_copy_array(src->vs, n);
+    dh_pvss_ctx_init(dst, src->params, t, src->bn_ctx);
+    dst->num_threads = src->num_threads;
 }
 
 /* precompute table of small inverses
@@ -74,11 +121,11 @@ static void free_precompute_inverse_table(int n, BIGNUM **inverse_table) {
   bn_free_array(2*n, inverse_table);
 }
 
-static void derive_scrape_coeffs(const EC_GROUP *group, BIGNUM **coeffs, int from, int n, BIGNUM **inverse_table, BN_CTX *ctx) {
+static void derive_scrape_coeffs(const EC_GROUP *group, unsigned char *coeffs, int scalar_len, int from, int n, BIGNUM **inverse_table, BN_CTX *ctx) {
     const BIGNUM *order = get0_order(group);
 
+    BIGNUM *coeff = bn_new();
     for (int i = 1; i <= n; i++) {
-        BIGNUM *coeff = coeffs[i - 1];
         BN_set_word(coeff, 1);
         for (int j = from; j <= n; j++) {
             if (i == j) {
@@ -89,153 +136,753 @@ static void derive_scrape_coeffs(const EC_GROUP *group, BIGNUM **coeffs, int fro
             assert(index < 2*n && "bad index (too big)");
             BN_mod_mul(coeff, coeff, inverse_table[index], order, ctx);
         }
+        int ret = BN_bn2binpad(coeff, coeffs + (size_t)(i - 1) * scalar_len, scalar_len);
+        assert(ret == scalar_len && "derive_scrape_coeffs: BN_bn2binpad failed");
     }
+    bn_free(coeff);
 }
 
-void dh_pvss_setup(dh_pvss_ctx *pp, const EC_GROUP *group, const int t, const int n, BN_CTX *bn_ctx) {
-    assert(group && "dh_pvss_setup: usage error, no group specified");
-    pp->group = group;
-    assert(bn_ctx && "dh_pvss_setup: usage error, no BIGNUM context specified");
-    pp->bn_ctx = bn_ctx;
-    assert( (n - t - 2) > 0 && "dh_pvss_setup: usage error, n and t badly chosen");
-    pp->t = t;
-    pp->n = n;
-
-    // allocate vectors
-    pp->alphas   = bn_new_array(n+1);
-    pp->betas    = bn_new_array(n+1);
-    pp->v_primes = bn_new_array(n+1);
-    pp->vs       = bn_new_array(n);
+dh_pvss_params *dh_pvss_params_new(const EC_GROUP *group, const int n, BN_CTX *bn_ctx) {
+    assert(group && "dh_pvss_params_new: usage error, no group specified");
+    assert(bn_ctx && "dh_pvss_params_new: usage error, no BIGNUM context specified");
+    const int scalar_len = BN_num_bytes(get0_order(group));
+
+    // allocate struct and vectors in one block
+    size_t points_size = 2 * (size_t)(n+1) * sizeof(int);
+    size_t scalars_size = 2 * (size_t)n * scalar_len;
+    dh_pvss_params *params = malloc(sizeof(dh_pvss_params) + points_size + scalars_size);
+    assert(params && "dh_pvss_params_new: allocation error");
+    atomic_init(&params->references, 1);
+    params->group = group;
+    params->n = n;
+    params->scalar_len = scalar_len;
+    params->alphas   = (int *)(params + 1);
+    params->betas    = params->alphas + (n+1);
+    params->vs       = (unsigned char *)(params->betas + (n+1));
+    params->v_primes = params->vs + (size_t)n * scalar_len;
 
     // fill alphas and betas
     for (int i=0; i<n+1; i++) {
-        BN_set_word(pp->alphas[i], i);
-        BN_set_word(pp->betas[i], i);
+        params->alphas[i] = i;
+        params->betas[i] = i;
     }
 
     // fill vs and v_primes
     BIGNUM **inverse_table = precompute_inverse_table(group, n, bn_ctx);
-    derive_scrape_coeffs(group, pp->vs, 1, n, inverse_table, bn_ctx);
-    derive_scrape_coeffs(group, pp->v_primes, 0, n, inverse_table, bn_ctx);
+    derive_scrape_coeffs(group, params->vs, scalar_len, 1, n, inverse_table, bn_ctx);
+    derive_scrape_coeffs(group, params->v_primes, scalar_len, 0, n, inverse_table, bn_ctx);
     free_precompute_inverse_table(n, inverse_table);
+
+    return params;
+}
+
+void dh_pvss_setup(dh_pvss_ctx *pp, const EC_GROUP *group, const int t, const int n, BN_CTX *bn_ctx) {
+    assert(group && "dh_pvss_setup: usage error, no group specified");
+    assert(bn_ctx && "dh_pvss_setup: usage error, no BIGNUM context specified");
+    assert( (n - t - 2) > 0 && "dh_pvss_setup: usage error, n and t badly chosen");
+    dh_pvss_params *params = dh_pvss_params_new(group, n, bn_ctx);
+    dh_pvss_ctx_init(pp, params, t, bn_ctx);
+    dh_pvss_params_free(params); // pp now holds the only reference
 }
 
-static void generate_scrape_sum_terms(const EC_GROUP *group, BIGNUM** terms, BIGNUM **eval_points, BIGNUM** code_coeffs, BIGNUM **poly_coeff, int n, int num_poly_coeffs, BN_CTX *ctx) {
+/* terms[x-from-1] = code_coeffs[x-1] * poly(eval_points[x]) for x = from+1..to
+ * the polynomial is evaluated with Horner's rule, using word multiplications since the evaluation points are small integers */
+static void generate_scrape_sum_terms(const EC_GROUP *group, BIGNUM** terms, const int *eval_points, const unsigned char *code_coeffs, int scalar_len, BIGNUM **poly_coeff, int from, int to, int num_poly_coeffs, BN_CTX *ctx) {
     const BIGNUM *order = get0_order(group);
 
-    BIGNUM *poly_eval = bn_new();
-    BIGNUM *poly_term = bn_new();
-    BIGNUM *exp       = bn_new();
-    for (int x=1; x<=n; x++) {
-        BIGNUM *eval_point = eval_points[x];
+    BIGNUM *poly_eval  = bn_new();
+    BIGNUM *code_coeff = bn_new();
+    for (int x=from+1; x<=to; x++) {
+        BN_ULONG eval_point = (BN_ULONG)eval_points[x];
         BN_set_word(poly_eval, 0);
-        for (int i=0; i<num_poly_coeffs; i++) {
-            BN_set_word(exp, i);
-            BN_mod_exp(poly_term, eval_point, exp, order, ctx);
-            BN_mod_mul(poly_term, poly_term, poly_coeff[i], order, ctx);
-            BN_mod_add(poly_eval, poly_eval, poly_term, order, ctx);
+        for (int i=num_poly_coeffs-1; i>=0; i--) {
+            BN_mul_word(poly_eval, eval_point);
+            BN_add(poly_eval, poly_eval, poly_coeff[i]);
+            BN_nnmod(poly_eval, poly_eval, order, ctx);
         }
-        terms[x - 1] = bn_new();
-        BN_mod_mul(terms[x - 1], code_coeffs[x - 1], poly_eval, order, ctx);
+        params_scalar_lift(code_coeff, code_coeffs, x - 1, scalar_len);
+        BIGNUM *term = bn_new();
+        BN_mod_mul(term, code_coeff, poly_eval, order, ctx);
+        terms[x - from - 1] = term;
     }
 
     // cleanup
     bn_free(poly_eval);
-    bn_free(poly_term);
-    bn_free(exp);
+    bn_free(code_coeff);
 }
 
-void dh_pvss_distribute_prove(dh_pvss_ctx *pp, EC_POINT **encrypted_shares, dh_key_pair *dist_key, const EC_POINT *com_keys[], EC_POINT *secret, nizk_dl_eq_proof *pi) {
+/* state shared by the chunks of a (possibly parallel) distribution proof
+ * every chunk writes only to its own index range and to its own partial sum slot
+ * the job covers users first_index+1.., and all per-user arrays are indexed relative to first_index */
+typedef struct {
+    const dh_pvss_ctx *pp;
+    int first_index;
+    const BIGNUM *dist_key_priv;
+    const EC_POINT *secret;
+    const BIGNUM **share_coeffs;
+    const EC_POINT **com_keys;
+    EC_POINT **encrypted_shares; // output when proving, read only when verifying
+    size_t encoding_len;
+    unsigned char *com_key_encodings;
+    unsigned char *encrypted_share_encodings;
+    BIGNUM **poly_coeffs;
+    int num_poly_coeffs;
+    BIGNUM **scrape_terms;
+    EC_POINT **partial_U;
+    EC_POINT **partial_V; // NULL when only U is needed
+    int *chunk_failed; // per chunk, set when verifying from encodings that turn out malformed
+} dh_pvss_distribute_job;
+
+// encode committee keys and encrypted shares of users from+1..to for hashing (a list is skipped if its buffer is NULL)
+static void distribute_encode_chunk(int chunk, int from, int to, BN_CTX *ctx, void *arg) {
+    (void)chunk;
+    dh_pvss_distribute_job *job = (dh_pvss_distribute_job *)arg;
+    const EC_GROUP *group = job->pp->group;
+
+    for (int i=from; i<to; i++) {
+        if (job->com_key_encodings) {
+            openssl_point_encode(group, job->com_keys[i], job->com_key_encodings + (size_t)i * job->encoding_len, ctx);
+        }
+        if (job->encrypted_share_encodings) {
+            openssl_point_encode(group, job->encrypted_shares[i], job->encrypted_share_encodings + (size_t)i * job->encoding_len, ctx);
+        }
+    }
+}
+
+// make, encrypt and encode the shares of users from+1..to
+static void distribute_prove_encrypt_chunk(int chunk, int from, int to, BN_CTX *ctx, void *arg) {
+    dh_pvss_distribute_job *job = (dh_pvss_distribute_job *)arg;
+    const EC_GROUP *group = job->pp->group;
+
+    shamir_shares_eval(group, job->encrypted_shares + from, job->secret, job->share_coeffs, job->pp->t, job->first_index + from, job->first_index + to, ctx); // shares allocated here
+    EC_POINT *shared_key = point_new(group);
+    for (int i=from; i<to; i++) {
+        EC_POINT *encrypted_share = job->encrypted_shares[i]; // encrypt share in place
+        point_mul(group, shared_key, job->dist_key_priv, job->com_keys[i], ctx);
+        point_add(group, encrypted_share, encrypted_share, shared_key, ctx);
+    }
+    distribute_encode_chunk(chunk, from, to, ctx, arg);
+
+    // cleanup
+    point_free(shared_key);
+}
+
+// scrape sum terms and partial sums of U and V for users from+1..to
+static void distribute_scrape_chunk(int chunk, int from, int to, BN_CTX *ctx, void *arg) {
+    dh_pvss_distribute_job *job = (dh_pvss_distribute_job *)arg;
+    const dh_pvss_ctx *pp = job->pp;
     const EC_GROUP *group = pp->group;
-    BN_CTX *ctx = pp->bn_ctx;
-    const int n = pp->n;
-    const int t = pp->t;
 
-    // create shares
-    EC_POINT *shares[n]; // share container
-    shamir_shares_generate(group, shares, secret, t, n, ctx); // shares allocated here
+    generate_scrape_sum_terms(group, job->scrape_terms + from, pp->params->alphas, pp->params->vs, pp->params->scalar_len, job->poly_coeffs, job->first_index + from, job->first_index + to, job->num_poly_coeffs, ctx);
+    job->partial_U[chunk] = point_new(group);
+    point_weighted_sum(group, job->partial_U[chunk], to - from, (const BIGNUM**)job->scrape_terms + from, job->com_keys + from, ctx);
+    if (job->partial_V) {
+        job->partial_V[chunk] = point_new(group);
+        point_weighted_sum(group, job->partial_V[chunk], to - from, (const BIGNUM**)job->scrape_terms + from, (const EC_POINT**)job->encrypted_shares + from, ctx);
+    }
+}
+
+#define DH_PVSS_DECODE_BATCH 64 // encrypted shares decoded at a time when verifying from encodings
 
-    // encrypt shares
-    for (int i=0; i<n; i++) {
-        EC_POINT *encrypted_share = encrypted_shares[i] = point_new(group);
-        point_mul(group, encrypted_share, dist_key->priv, com_keys[i], ctx);
-        point_add(group, encrypted_share, encrypted_share, shares[i], ctx);
+// same as distribute_scrape_chunk, but the encrypted shares are decoded from job->encrypted_share_encodings batch by batch
+// (unlike the other chunk functions, the per-user arrays of the job are indexed absolutely, from user 1)
+static void distribute_scrape_encoded_chunk(int chunk, int from, int to, BN_CTX *ctx, void *arg) {
+    dh_pvss_distribute_job *job = (dh_pvss_distribute_job *)arg;
+    const dh_pvss_ctx *pp = job->pp;
+    const EC_GROUP *group = pp->group;
+
+    job->partial_U[chunk] = point_new(group);
+    job->partial_V[chunk] = point_new(group);
+    job->chunk_failed[chunk] = 0;
+    BIGNUM *terms[DH_PVSS_DECODE_BATCH];
+    EC_POINT *shares[DH_PVSS_DECODE_BATCH];
+    EC_POINT *sum = point_new(group);
+    const int end = job->first_index + to;
+    for (int first=job->first_index+from; first<end; first+=DH_PVSS_DECODE_BATCH) {
+        const int num = end - first < DH_PVSS_DECODE_BATCH ? end - first : DH_PVSS_DECODE_BATCH;
+        if (dh_pvss_wire_decode_points_validated(group, job->encrypted_share_encodings + (size_t)first * job->encoding_len, num, shares, 0, ctx)) {
+            job->chunk_failed[chunk] = 1;
+            break;
+        }
+        generate_scrape_sum_terms(group, terms, pp->params->alphas, pp->params->vs, pp->params->scalar_len, job->poly_coeffs, first, first + num, job->num_poly_coeffs, ctx);
+        point_weighted_sum(group, sum, num, (const BIGNUM**)terms, job->com_keys + first, ctx);
+        point_add(group, job->partial_U[chunk], job->partial_U[chunk], sum, ctx);
+        point_weighted_sum(group, sum, num, (const BIGNUM**)terms, (const EC_POINT**)shares, ctx);
+        point_add(group, job->partial_V[chunk], job->partial_V[chunk], sum, ctx);
+        for (int i=0; i<num; i++) {
+            bn_free(terms[i]);
+            point_free(shares[i]);
+        }
     }
 
-    // degree n-t-2 polynomial = hash(dist_key->pub, com_keys)
+    // cleanup
+    point_free(sum);
+}
+
+void dh_pvss_ctx_set_num_threads(dh_pvss_ctx *pp, int num_threads) {
+    assert(num_threads > 0 && "dh_pvss_ctx_set_num_threads: usage error, at least one thread needed");
+    pp->num_threads = num_threads;
+}
+
+/* the work is done in chunks of users, in pp->num_threads worker threads
+ * all randomness is drawn on the calling thread in the same order regardless of the number of threads,
+ * so the output is bit-identical to the serial (single thread) case for a fixed random number generator
+ * com_keys_digest may be passed if already known (see dh_pvss_committee), otherwise pass NULL */
+static void distribute_prove(dh_pvss_ctx *pp, EC_POINT **encrypted_shares, dh_key_pair *dist_key, const EC_POINT *com_keys[], const BIGNUM *com_keys_digest, EC_POINT *secret, nizk_dl_eq_proof *pi) {
+    const EC_GROUP *group = pp->group;
+    BN_CTX *ctx = pp->bn_ctx;
+    const int n = pp->n;
+    const int t = pp->t;
+    const int num_chunks = parallel_num_chunks(pp->num_threads, n);
+
+    // sample sharing polynomial
+    BIGNUM *share_coeffs[t+1];
+    shamir_coeffs_generate(group, share_coeffs, t, ctx);
+
+    // create and encrypt shares
+    dh_pvss_distribute_job job;
+    job.pp = pp;
+    job.first_index = 0;
+    job.dist_key_priv = dist_key->priv;
+    job.secret = secret;
+    job.share_coeffs = (const BIGNUM **)share_coeffs;
+    job.com_keys = com_keys;
+    job.encrypted_shares = encrypted_shares;
+    job.encoding_len = openssl_point_encoding_len(group);
+    unsigned char *encodings = malloc((com_keys_digest ? 1 : 2) * (size_t)n * job.encoding_len);
+    assert(encodings && "dh_pvss_distribute_prove: allocation error (encodings)");
+    job.encrypted_share_encodings = encodings;
+    job.com_key_encodings = com_keys_digest ? NULL : encodings + (size_t)n * job.encoding_len;
+    parallel_for(pp->num_threads, n, distribute_prove_encrypt_chunk, &job, ctx);
+
+    // degree n-t-2 polynomial = hash(dist_key->pub, com_keys, encrypted_shares)
     const int num_poly_coeffs = n - t - 1;
     BIGNUM *poly_coeffs[num_poly_coeffs]; // polynomial container
-    const int num_point_lists = 3;
-//    int num_points[num_point_lists] = {1, n, n};
-//    const EC_POINT **point_lists[num_point_lists] = { (const EC_POINT **)&(dist_key->pub), com_keys, (const EC_POINT **)encrypted_shares};
-    int num_points[3] = {1, n, n};
-    const EC_POINT **point_lists[3] = { (const EC_POINT **)&(dist_key->pub), com_keys, (const EC_POINT **)encrypted_shares};
-    openssl_hash_points2poly(group, ctx, num_poly_coeffs, poly_coeffs, num_point_lists, num_points, point_lists);
+    BIGNUM *list_digests[3];
+    list_digests[0] = openssl_hash_point2bn(group, ctx, dist_key->pub);
+    if (com_keys_digest) {
+        list_digests[1] = bn_new();
+        BN_copy(list_digests[1], com_keys_digest);
+    } else {
+        list_digests[1] = openssl_hash_encoded_points2bn(job.encoding_len, n, job.com_key_encodings);
+    }
+    list_digests[2] = openssl_hash_encoded_points2bn(job.encoding_len, n, job.encrypted_share_encodings);
+    openssl_hash_digests2poly(group, ctx, num_poly_coeffs, poly_coeffs, 3, (const BIGNUM **)list_digests);
 
-    // generate scrape sum terms
+    // generate scrape sum terms, and compute U and V
     BIGNUM *scrape_terms[n];
-    generate_scrape_sum_terms(group, scrape_terms, pp->alphas, pp->vs, poly_coeffs, n, num_poly_coeffs, ctx);
-
-    // compute U and V
-    EC_POINT *U = point_new(group);
-    EC_POINT *V = point_new(group);
-    point_weighted_sum(group, U, n, (const BIGNUM**)scrape_terms, com_keys, ctx);
-    point_weighted_sum(group, V, n, (const BIGNUM**)scrape_terms, (const EC_POINT**)encrypted_shares, ctx);
+    EC_POINT *partial_U[num_chunks];
+    EC_POINT *partial_V[num_chunks];
+    job.poly_coeffs = poly_coeffs;
+    job.num_poly_coeffs = num_poly_coeffs;
+    job.scrape_terms = scrape_terms;
+    job.partial_U = partial_U;
+    job.partial_V = partial_V;
+    parallel_for(pp->num_threads, n, distribute_scrape_chunk, &job, ctx);
+    EC_POINT *U = partial_U[0];
+    EC_POINT *V = partial_V[0];
+    for (int c=1; c<num_chunks; c++) {
+        point_add(group, U, U, partial_U[c], ctx);
+        point_add(group, V, V, partial_V[c], ctx);
+    }
 
     // generate dl eq proof
     const EC_POINT *generator = get0_generator(group);
     nizk_dl_eq_prove(group, dist_key->priv, generator, dist_key->pub, U, V, pi, ctx);
 
     // cleanup
-    point_free(U);
-    point_free(V);
+    for (int c=0; c<num_chunks; c++) {
+        point_free(partial_U[c]);
+        point_free(partial_V[c]);
+    }
     for (int i=0; i<n; i++) {
         bn_free(scrape_terms[i]);
-        point_free(shares[i]);
     }
     for (int i=0; i<num_poly_coeffs; i++) {
         bn_free(poly_coeffs[i]);
     }
+    for (int i=0; i<3; i++) {
+        bn_free(list_digests[i]);
+    }
+    free(encodings);
+    shamir_coeffs_free(share_coeffs, t);
 
     // implicitly return (pi, encrypted_shares)
 }
 
-int dh_pvss_distribute_verify(dh_pvss_ctx *pp, nizk_dl_eq_proof *pi, const EC_POINT **encrypted_shares, const EC_POINT *pub_dist, const EC_POINT **com_keys) {
+void dh_pvss_distribute_prove(dh_pvss_ctx *pp, EC_POINT **encrypted_shares, dh_key_pair *dist_key, const EC_POINT *com_keys[], EC_POINT *secret, nizk_dl_eq_proof *pi) {
+    distribute_prove(pp, encrypted_shares, dist_key, com_keys, NULL, secret, pi);
+}
+
+// dh_pvss_distribute_prove for a committee of registered keys, whose digest is not recomputed
+void dh_pvss_distribute_prove_committee(dh_pvss_ctx *pp, EC_POINT **encrypted_shares, dh_key_pair *dist_key, const dh_pvss_committee *com, EC_POINT *secret, nizk_dl_eq_proof *pi) {
+    assert(com->n == pp->n && "dh_pvss_distribute_prove_committee: usage error, committee size differs from n");
+    distribute_prove(pp, encrypted_shares, dist_key, com->keys, com->digest, secret, pi);
+}
+
+/* streaming variant of dh_pvss_distribute_prove, producing the same shares and proof for the same randomness
+ * the encrypted shares are handed to sink chunk_size at a time and are not kept, so that beyond the two polynomials
+ * (t+1 and n-t-1 coefficients) the memory used is O(chunk_size) instead of O(n)
+ * first pass: make, encrypt, emit and hash the shares of a chunk, second pass: U = sum scrape_term_i * com_key_i
+ * there is no need to revisit the encrypted shares for V, since honestly made shares give V = dist_key->priv * U
+ * (the scrape terms are a codeword of the dual code, orthogonal to the degree t sharing polynomial)
+ * returns 0 on success, otherwise the (non-zero) value returned by sink, in which case no proof is produced */
+int dh_pvss_distribute_prove_streaming(dh_pvss_ctx *pp, int chunk_size, dh_pvss_share_sink sink, void *sink_arg, dh_key_pair *dist_key, const EC_POINT *com_keys[], EC_POINT *secret, nizk_dl_eq_proof *pi) {
+    assert(chunk_size > 0 && "dh_pvss_distribute_prove_streaming: usage error, chunk size must be positive");
+    assert(sink && "dh_pvss_distribute_prove_streaming: usage error, no sink specified");
+    const EC_GROUP *group = pp->group;
+    BN_CTX *ctx = pp->bn_ctx;
+    const int n = pp->n;
+    const int t = pp->t;
+    if (chunk_size > n) {
+        chunk_size = n;
+    }
+    const int num_sub_chunks = parallel_num_chunks(pp->num_threads, chunk_size);
+
+    // sample sharing polynomial
+    BIGNUM **share_coeffs = malloc((t+1) * sizeof(BIGNUM *));
+    assert(share_coeffs && "dh_pvss_distribute_prove_streaming: allocation error (coefficients)");
+    shamir_coeffs_generate(group, share_coeffs, t, ctx);
+
+    // chunk buffers
+    dh_pvss_distribute_job job;
+    job.pp = pp;
+    job.dist_key_priv = dist_key->priv;
+    job.secret = secret;
+    job.share_coeffs = (const BIGNUM **)share_coeffs;
+    job.encoding_len = openssl_point_encoding_len(group);
+    job.encrypted_shares = malloc(chunk_size * sizeof(EC_POINT *));
+    job.scrape_terms = malloc(chunk_size * sizeof(BIGNUM *));
+    job.com_key_encodings = malloc(2 * (size_t)chunk_size * job.encoding_len);
+    assert(job.encrypted_shares && job.scrape_terms && job.com_key_encodings && "dh_pvss_distribute_prove_streaming: allocation error (chunk buffers)");
+    job.encrypted_share_encodings = job.com_key_encodings + (size_t)chunk_size * job.encoding_len;
+    EC_POINT *partial_U[num_sub_chunks];
+    job.partial_U = partial_U;
+    job.partial_V = NULL;
+
+    // first pass, create, encrypt, emit and hash shares
+    int ret = 0;
+    SHA256_CTX com_keys_sha_ctx, encrypted_shares_sha_ctx;
+    openssl_hash_init(&com_keys_sha_ctx);
+    openssl_hash_init(&encrypted_shares_sha_ctx);
+    for (int first=0; first<n && ret==0; first+=chunk_size) {
+        const int num = n - first < chunk_size ? n - first : chunk_size;
+        job.first_index = first;
+        job.com_keys = com_keys + first;
+        parallel_for(pp->num_threads, num, distribute_prove_encrypt_chunk, &job, ctx);
+        openssl_hash_update_encoded_points(&com_keys_sha_ctx, job.encoding_len, num, job.com_key_encodings);
+        openssl_hash_update_encoded_points(&encrypted_shares_sha_ctx, job.encoding_len, num, job.encrypted_share_encodings);
+        ret = sink(sink_arg, first, num, (const EC_POINT **)job.encrypted_shares);
+        for (int i=0; i<num; i++) {
+            point_free(job.encrypted_shares[i]);
+        }
+    }
+    unsigned char com_keys_md[SHA256_DIGEST_LENGTH], encrypted_shares_md[SHA256_DIGEST_LENGTH];
+    openssl_hash_final(com_keys_md, &com_keys_sha_ctx);
+    openssl_hash_final(encrypted_shares_md, &encrypted_shares_sha_ctx);
+    if (ret == 0) { // not aborted by sink
+
+        // degree n-t-2 polynomial = hash(dist_key->pub, com_keys, encrypted_shares)
+        const int num_poly_coeffs = n - t - 1;
+        BIGNUM **poly_coeffs = malloc(num_poly_coeffs * sizeof(BIGNUM *));
+        assert(poly_coeffs && "dh_pvss_distribute_prove_streaming: allocation error (polynomial)");
+        BIGNUM *list_digests[3];
+        list_digests[0] = openssl_hash_point2bn(group, ctx, dist_key->pub);
+        list_digests[1] = openssl_hash2bignum(com_keys_md);
+        list_digests[2] = openssl_hash2bignum(encrypted_shares_md);
+        openssl_hash_digests2poly(group, ctx, num_poly_coeffs, poly_coeffs, 3, (const BIGNUM **)list_digests);
+        job.poly_coeffs = poly_coeffs;
+        job.num_poly_coeffs = num_poly_coeffs;
+
+        // second pass, U = sum of scrape terms times committee keys, and V = dist_key->priv * U
+        EC_POINT *U = point_new(group);
+        for (int first=0; first<n; first+=chunk_size) {
+            const int num = n - first < chunk_size ? n - first : chunk_size;
+            job.first_index = first;
+            job.com_keys = com_keys + first;
+            parallel_for(pp->num_threads, num, distribute_scrape_chunk, &job, ctx);
+            for (int c=0; c<parallel_num_chunks(pp->num_threads, num); c++) {
+                point_add(group, U, U, partial_U[c], ctx);
+                point_free(partial_U[c]);
+            }
+            for (int i=0; i<num; i++) {
+                bn_free(job.scrape_terms[i]);
+            }
+        }
+        EC_POINT *V = point_new(group);
+        point_mul(group, V, dist_key->priv, U, ctx);
+
+        // generate dl eq proof
+        const EC_POINT *generator = get0_generator(group);
+        nizk_dl_eq_prove(group, dist_key->priv, generator, dist_key->pub, U, V, pi, ctx);
+
+        point_free(U);
+        point_free(V);
+        for (int i=0; i<num_poly_coeffs; i++) {
+            bn_free(poly_coeffs[i]);
+        }
+        free(poly_coeffs);
+        for (int i=0; i<3; i++) {
+            bn_free(list_digests[i]);
+        }
+    }
+
+    // cleanup
+    free(job.encrypted_shares);
+    free(job.scrape_terms);
+    free(job.com_key_encodings);
+    shamir_coeffs_free(share_coeffs, t);
+    free(share_coeffs);
+
+    return ret;
+}
+
+// digest of the committee keys, as hashed into the scrape polynomial
+static BIGNUM *distribute_com_keys_digest(dh_pvss_ctx *pp, const EC_POINT **com_keys) {
+    dh_pvss_distribute_job job;
+    job.pp = pp;
+    job.com_keys = com_keys;
+    job.encoding_len = openssl_point_encoding_len(pp->group);
+    job.com_key_encodings = malloc((size_t)pp->n * job.encoding_len);
+    assert(job.com_key_encodings && "distribute_com_keys_digest: allocation error (encodings)");
+    job.encrypted_share_encodings = NULL;
+    parallel_for(pp->num_threads, pp->n, distribute_encode_chunk, &job, pp->bn_ctx);
+    BIGNUM *digest = openssl_hash_encoded_points2bn(job.encoding_len, pp->n, job.com_key_encodings);
+    free(job.com_key_encodings);
+    return digest;
+}
+
+/* digests of the lists hashed into the scrape polynomial of a distribution: pub_dist, com_keys and encrypted_shares
+ * the points are encoded in pp->num_threads worker threads
+ * com_keys_digest may be passed if already known (see distribute_com_keys_digest), otherwise pass NULL */
+static void distribute_list_digests(dh_pvss_ctx *pp, const EC_POINT **encrypted_shares, const EC_POINT *pub_dist, const EC_POINT **com_keys, const BIGNUM *com_keys_digest, BIGNUM *list_digests[3]) {
+    const int n = pp->n;
+
+    // encode points for hashing
+    dh_pvss_distribute_job job;
+    job.pp = pp;
+    job.com_keys = com_keys;
+    job.encrypted_shares = (EC_POINT **)encrypted_shares; // read only
+    job.encoding_len = openssl_point_encoding_len(pp->group);
+    unsigned char *encodings = malloc((com_keys_digest ? 1 : 2) * (size_t)n * job.encoding_len);
+    assert(encodings && "distribute_list_digests: allocation error (encodings)");
+    job.encrypted_share_encodings = encodings;
+    job.com_key_encodings = com_keys_digest ? NULL : encodings + (size_t)n * job.encoding_len;
+    parallel_for(pp->num_threads, n, distribute_encode_chunk, &job, pp->bn_ctx);
+
+    list_digests[0] = openssl_hash_point2bn(pp->group, pp->bn_ctx, pub_dist);
+    if (com_keys_digest) {
+        list_digests[1] = bn_new();
+        BN_copy(list_digests[1], com_keys_digest);
+    } else {
+        list_digests[1] = openssl_hash_encoded_points2bn(job.encoding_len, n, job.com_key_encodings);
+    }
+    list_digests[2] = openssl_hash_encoded_points2bn(job.encoding_len, n, job.encrypted_share_encodings);
+
+    // cleanup
+    free(encodings);
+}
+
+/* U and V of a distribution, as checked by its proof, using the same chunking as dh_pvss_distribute_prove:
+ * scrape terms and partial sums of U and V are computed in pp->num_threads worker threads, then combined */
+static void distribute_verify_sums(dh_pvss_ctx *pp, const EC_POINT **encrypted_shares, const EC_POINT **com_keys, const BIGNUM *list_digests[3], EC_POINT **U, EC_POINT **V) {
     const EC_GROUP *group = pp->group;
     BN_CTX *ctx = pp->bn_ctx;
-    const EC_POINT *generator = get0_generator(group);
     const int n = pp->n;
     const int t = pp->t;
+    const int num_chunks = parallel_num_chunks(pp->num_threads, n);
 
-    // degree n-t-2 polynomial <- hash(dist_key->pub, com_keys)
+    // degree n-t-2 polynomial <- hash(pub_dist, com_keys, encrypted_shares)
     const int num_poly_coeffs = n - t - 1;
     BIGNUM *poly_coeffs[num_poly_coeffs]; // polynomial container
-    const int num_point_lists = 3;
-//    int num_points[num_point_lists] = {1, n, n};
-//    const EC_POINT **point_lists[num_point_lists] = { &(pub_dist), com_keys, (const EC_POINT **)encrypted_shares};
-    int num_points[3] = {1, n, n};
-    const EC_POINT **point_lists[3] = { &(pub_dist), com_keys, (const EC_POINT **)encrypted_shares};
-    openssl_hash_points2poly(group, ctx, num_poly_coeffs, poly_coeffs, num_point_lists, num_points, point_lists);
+    openssl_hash_digests2poly(group, ctx, num_poly_coeffs, poly_coeffs, 3, list_digests);
 
-    // generate scrape sum terms
+    // generate scrape sum terms, and partial sums of U and V
     BIGNUM *scrape_terms[n];
-    generate_scrape_sum_terms(group, scrape_terms, pp->alphas, pp->vs, poly_coeffs, n, num_poly_coeffs, ctx);
+    EC_POINT *partial_U[num_chunks];
+    EC_POINT *partial_V[num_chunks];
+    dh_pvss_distribute_job job;
+    job.pp = pp;
+    job.first_index = 0;
+    job.com_keys = com_keys;
+    job.encrypted_shares = (EC_POINT **)encrypted_shares; // read only
+    job.poly_coeffs = poly_coeffs;
+    job.num_poly_coeffs = num_poly_coeffs;
+    job.scrape_terms = scrape_terms;
+    job.partial_U = partial_U;
+    job.partial_V = partial_V;
+    parallel_for(pp->num_threads, n, distribute_scrape_chunk, &job, ctx);
+
+    // combine partial sums
+    for (int c=1; c<num_chunks; c++) {
+        point_add(group, partial_U[0], partial_U[0], partial_U[c], ctx);
+        point_add(group, partial_V[0], partial_V[0], partial_V[c], ctx);
+        point_free(partial_U[c]);
+        point_free(partial_V[c]);
+    }
+    *U = partial_U[0];
+    *V = partial_V[0];
 
-    // compute U and V
-    EC_POINT *U = point_new(group);
-    EC_POINT *V = point_new(group);
-    point_weighted_sum(group, U, n, (const BIGNUM**)scrape_terms, com_keys, ctx);
-    point_weighted_sum(group, V, n, (const BIGNUM**)scrape_terms, encrypted_shares, ctx);
+    // cleanup
+    for (int i=0; i<n; i++) {
+        bn_free(scrape_terms[i]);
+    }
+    for (int i=0; i<num_poly_coeffs; i++) {
+        bn_free(poly_coeffs[i]);
+    }
+}
+
+// com_keys_digest may be passed if already known, otherwise pass NULL
+static int distribute_verify(dh_pvss_ctx *pp, nizk_dl_eq_proof *pi, const EC_POINT **encrypted_shares, const EC_POINT *pub_dist, const EC_POINT **com_keys, const BIGNUM *com_keys_digest) {
+    BIGNUM *list_digests[3];
+    distribute_list_digests(pp, encrypted_shares, pub_dist, com_keys, com_keys_digest, list_digests);
+    EC_POINT *U, *V;
+    distribute_verify_sums(pp, encrypted_shares, com_keys, (const BIGNUM **)list_digests, &U, &V);
 
     // verify dl eq proof
-    int ret = nizk_dl_eq_verify(group, generator, pub_dist, U, V, pi, ctx);
+    const EC_POINT *generator = get0_generator(pp->group);
+    int ret = nizk_dl_eq_verify(pp->group, generator, pub_dist, U, V, pi, pp->bn_ctx);
 
     // cleanup
     point_free(U);
     point_free(V);
-    for (int i=0; i<n; i++) {
-        bn_free(scrape_terms[i]);
+    for (int i=0; i<3; i++) {
+        bn_free(list_digests[i]);
+    }
+
+    return ret;
+}
+
+int dh_pvss_distribute_verify(dh_pvss_ctx *pp, nizk_dl_eq_proof *pi, const EC_POINT **encrypted_shares, const EC_POINT *pub_dist, const EC_POINT **com_keys) {
+    return distribute_verify(pp, pi, encrypted_shares, pub_dist, com_keys, NULL);
+}
+
+// dh_pvss_distribute_verify for a committee of registered keys, whose digest is not recomputed
+int dh_pvss_distribute_verify_committee(dh_pvss_ctx *pp, nizk_dl_eq_proof *pi, const EC_POINT **encrypted_shares, const EC_POINT *pub_dist, const dh_pvss_committee *com) {
+    assert(com->n == pp->n && "dh_pvss_distribute_verify_committee: usage error, committee size differs from n");
+    return distribute_verify(pp, pi, encrypted_shares, pub_dist, com->keys, com->digest);
+}
+
+/* digest identifying a distribution transcript (and the committee it is for), from the list digests of its scrape polynomial
+ * returns 0 on success, and 1 if the proof does not fit the encoding (z wider than a scalar), in which case there is no digest */
+static int distribute_transcript_digest(const dh_pvss_ctx *pp, const nizk_dl_eq_proof *pi, const BIGNUM *list_digests[3], unsigned char *digest) {
+    const int scalar_len = pp->params->scalar_len;
+    SHA256_CTX sha_ctx;
+    openssl_hash_init(&sha_ctx);
+    const unsigned char sizes[] = {
+        (unsigned char)(pp->t >> 24), (unsigned char)(pp->t >> 16), (unsigned char)(pp->t >> 8), (unsigned char)pp->t,
+        (unsigned char)(pp->n >> 24), (unsigned char)(pp->n >> 16), (unsigned char)(pp->n >> 8), (unsigned char)pp->n
+    };
+    openssl_hash_update(&sha_ctx, sizes, sizeof(sizes));
+    unsigned char buf[scalar_len > SHA256_DIGEST_LENGTH ? scalar_len : SHA256_DIGEST_LENGTH];
+    for (int i=0; i<3; i++) {
+        BN_bn2binpad(list_digests[i], buf, SHA256_DIGEST_LENGTH);
+        openssl_hash_update(&sha_ctx, buf, SHA256_DIGEST_LENGTH);
+    }
+    openssl_hash_update_point(&sha_ctx, pp->group, pi->Ra, pp->bn_ctx);
+    openssl_hash_update_point(&sha_ctx, pp->group, pi->Rb, pp->bn_ctx);
+    if (BN_bn2binpad(pi->z, buf, scalar_len) < 0) {
+        openssl_hash_final(digest, &sha_ctx); // discarded
+        return 1;
+    }
+    openssl_hash_update(&sha_ctx, buf, scalar_len);
+    openssl_hash_final(digest, &sha_ctx);
+    return 0;
+}
+
+// digest of a distribution transcript (DH_PVSS_CACHE_DIGEST_LEN bytes), as used to key dh_pvss_cache
+// returns 0 on success, and 1 if the transcript has no digest (see distribute_transcript_digest)
+int dh_pvss_distribute_digest(dh_pvss_ctx *pp, nizk_dl_eq_proof *pi, const EC_POINT **encrypted_shares, const EC_POINT *pub_dist, const EC_POINT **com_keys, unsigned char *digest) {
+    BIGNUM *list_digests[3];
+    distribute_list_digests(pp, encrypted_shares, pub_dist, com_keys, NULL, list_digests);
+    int ret = distribute_transcript_digest(pp, pi, (const BIGNUM **)list_digests, digest);
+    for (int i=0; i<3; i++) {
+        bn_free(list_digests[i]);
+    }
+    return ret;
+}
+
+/* dh_pvss_distribute_verify, with the verdict looked up in (or else stored in) cache
+ * hashing the transcript is needed either way, but a cache hit skips the polynomial, the scrape terms and the weighted sums
+ * a transcript without a digest is verified without the cache */
+int dh_pvss_distribute_verify_cached(dh_pvss_ctx *pp, dh_pvss_cache *cache, nizk_dl_eq_proof *pi, const EC_POINT **encrypted_shares, const EC_POINT *pub_dist, const EC_POINT **com_keys) {
+    BIGNUM *list_digests[3];
+    distribute_list_digests(pp, encrypted_shares, pub_dist, com_keys, NULL, list_digests);
+    unsigned char digest[DH_PVSS_CACHE_DIGEST_LEN];
+    int uncached = distribute_transcript_digest(pp, pi, (const BIGNUM **)list_digests, digest);
+
+    int ret;
+    if (uncached || !dh_pvss_cache_lookup(cache, digest, &ret)) {
+        EC_POINT *U, *V;
+        distribute_verify_sums(pp, encrypted_shares, com_keys, (const BIGNUM **)list_digests, &U, &V);
+        const EC_POINT *generator = get0_generator(pp->group);
+        ret = nizk_dl_eq_verify(pp->group, generator, pub_dist, U, V, pi, pp->bn_ctx);
+        if (!uncached) {
+            dh_pvss_cache_insert(cache, digest, ret);
+        }
+        point_free(U);
+        point_free(V);
+    }
+
+    // cleanup
+    for (int i=0; i<3; i++) {
+        bn_free(list_digests[i]);
+    }
+
+    return ret;
+}
+
+/* the encrypted shares of a distribution transcript in wire format, if its header and length are right (or else NULL)
+ * the shares start after pub_dist, i.e., pub_dist | enc_shares[n] | Ra | Rb | z */
+static const unsigned char *distribute_encoded_shares(const dh_pvss_ctx *pp, const unsigned char *transcript, size_t len) {
+    int count;
+    if (dh_pvss_wire_decode_header(transcript, len, DH_PVSS_WIRE_DISTRIBUTION, &count) || count != pp->n || len != dh_pvss_wire_distribution_len(pp->group, pp->n)) {
+        return NULL;
+    }
+    return transcript + DH_PVSS_WIRE_HEADER_LEN + dh_pvss_wire_point_len(pp->group);
+}
+
+/* first step of verifying an encoded distribution: structural checks of all encodings, and the scrape polynomial
+ * (n-t-1 coefficients, allocated for the caller), returns 0 on success and 1 if the transcript is malformed */
+int dh_pvss_distribute_encoded_poly(dh_pvss_ctx *pp, const unsigned char *transcript, size_t len, const EC_POINT **com_keys, BIGNUM *poly_coeffs[]) {
+    const EC_GROUP *group = pp->group;
+    BN_CTX *ctx = pp->bn_ctx;
+    const int n = pp->n;
+    const unsigned char *encoded_shares = distribute_encoded_shares(pp, transcript, len);
+    if (!encoded_shares) {
+        return 1;
+    }
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    const unsigned char *encoded_pub_dist = encoded_shares - point_len;
+    if (dh_pvss_wire_scan_points(group, encoded_pub_dist, n + 3, 0, ctx)) {
+        return 1; // malformed encodings are rejected before any other work
+    }
+    EC_POINT *pub_dist;
+    if (dh_pvss_wire_decode_points_validated(group, encoded_pub_dist, 1, &pub_dist, 0, ctx)) {
+        return 1;
+    }
+
+    // degree n-t-2 polynomial <- hash(pub_dist, com_keys, encrypted_shares)
+    BIGNUM *pub_dist_digest = openssl_hash_point2bn(group, ctx, pub_dist);
+    BIGNUM *com_keys_digest = distribute_com_keys_digest(pp, com_keys);
+    BIGNUM *encrypted_shares_digest = openssl_hash_encoded_points2bn(point_len, n, encoded_shares);
+    const BIGNUM *list_digests[] = { pub_dist_digest, com_keys_digest, encrypted_shares_digest };
+    openssl_hash_digests2poly(group, ctx, n - pp->t - 1, poly_coeffs, 3, list_digests);
+
+    // cleanup
+    bn_free(pub_dist_digest);
+    bn_free(com_keys_digest);
+    bn_free(encrypted_shares_digest);
+    point_free(pub_dist);
+
+    return 0;
+}
+
+/* second step: the sums of U and V over users from+1..to only, decoding their encrypted shares on the way
+ * the sums over disjoint ranges add up, so the ranges may be done anywhere, e.g., in other processes (see dh_pvss_remote.h)
+ * returns 0 on success, and 1 if the transcript or an encrypted share in the range is malformed */
+int dh_pvss_distribute_encoded_partial_sums(dh_pvss_ctx *pp, const unsigned char *transcript, size_t len, const EC_POINT **com_keys, const BIGNUM *poly_coeffs[], int from, int to, EC_POINT *U, EC_POINT *V) {
+    assert(0 <= from && from <= to && to <= pp->n && "dh_pvss_distribute_encoded_partial_sums: usage error, range out of bounds");
+    const EC_GROUP *group = pp->group;
+    BN_CTX *ctx = pp->bn_ctx;
+    const unsigned char *encoded_shares = distribute_encoded_shares(pp, transcript, len);
+    if (!encoded_shares) {
+        return 1;
+    }
+    EC_POINT_set_to_infinity(group, U);
+    EC_POINT_set_to_infinity(group, V);
+    if (from == to) {
+        return 0;
+    }
+
+    // scrape terms, and partial sums of U and V, in pp->num_threads threads
+    const int num_chunks = parallel_num_chunks(pp->num_threads, to - from);
+    dh_pvss_distribute_job job;
+    job.pp = pp;
+    job.first_index = from;
+    job.com_keys = com_keys;
+    job.encoding_len = dh_pvss_wire_point_len(group);
+    job.encrypted_share_encodings = (unsigned char *)encoded_shares; // read only
+    job.poly_coeffs = (BIGNUM **)poly_coeffs; // read only
+    job.num_poly_coeffs = pp->n - pp->t - 1;
+    EC_POINT *partial_U[num_chunks];
+    EC_POINT *partial_V[num_chunks];
+    int chunk_failed[num_chunks];
+    job.partial_U = partial_U;
+    job.partial_V = partial_V;
+    job.chunk_failed = chunk_failed;
+    parallel_for(pp->num_threads, to - from, distribute_scrape_encoded_chunk, &job, ctx);
+
+    // combine partial sums
+    int ret = 0;
+    for (int c=0; c<num_chunks; c++) {
+        ret |= chunk_failed[c];
+        point_add(group, U, U, partial_U[c], ctx);
+        point_add(group, V, V, partial_V[c], ctx);
+        point_free(partial_U[c]);
+        point_free(partial_V[c]);
+    }
+
+    return ret;
+}
+
+/* last step: check the proof of the transcript against U and V summed over all users
+ * returns 0 if the proof is valid, and 1 if it is not or the transcript is malformed */
+int dh_pvss_distribute_encoded_check(dh_pvss_ctx *pp, const unsigned char *transcript, size_t len, const EC_POINT *U, const EC_POINT *V) {
+    const EC_GROUP *group = pp->group;
+    BN_CTX *ctx = pp->bn_ctx;
+    const unsigned char *encoded_shares = distribute_encoded_shares(pp, transcript, len);
+    if (!encoded_shares) {
+        return 1;
+    }
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    const unsigned char *encoded_proof = encoded_shares + (size_t)pp->n * point_len;
+    EC_POINT *pub_dist;
+    EC_POINT *commitments[2];
+    if (dh_pvss_wire_decode_points_validated(group, encoded_shares - point_len, 1, &pub_dist, 0, ctx)) {
+        return 1;
+    }
+    if (dh_pvss_wire_decode_points_validated(group, encoded_proof, 2, commitments, 0, ctx)) {
+        point_free(pub_dist);
+        return 1;
+    }
+    nizk_dl_eq_proof pi = { commitments[0], commitments[1], dh_pvss_wire_decode_scalar(group, encoded_proof + 2 * point_len) };
+    int ret = 1;
+    if (pi.z) {
+        const EC_POINT *generator = get0_generator(group);
+        ret = nizk_dl_eq_verify(group, generator, pub_dist, U, V, &pi, ctx);
+        bn_free(pi.z);
     }
+
+    // cleanup
+    point_free(pub_dist);
+    point_free(pi.Ra);
+    point_free(pi.Rb);
+
+    return ret;
+}
+
+/* verify a distribution transcript in wire format (see dh_pvss_wire.h) directly from its encoding, e.g., a memory
+ * mapped file, without materializing the n encrypted shares first
+ * the encrypted shares are hashed as encoded (decoding only accepts canonical encodings, so this is the same hash),
+ * and are decoded batch by batch as the weighted sums consume them
+ * returns 0 if the transcript is well-formed and the distribution is valid, and 1 otherwise */
+int dh_pvss_distribute_verify_encoded(dh_pvss_ctx *pp, const unsigned char *transcript, size_t len, const EC_POINT **com_keys) {
+    const int num_poly_coeffs = pp->n - pp->t - 1;
+    BIGNUM *poly_coeffs[num_poly_coeffs]; // polynomial container
+    if (dh_pvss_distribute_encoded_poly(pp, transcript, len, com_keys, poly_coeffs)) {
+        return 1;
+    }
+    EC_POINT *U = point_new(pp->group);
+    EC_POINT *V = point_new(pp->group);
+    int ret = dh_pvss_distribute_encoded_partial_sums(pp, transcript, len, com_keys, (const BIGNUM **)poly_coeffs, 0, pp->n, U, V);
+    if (ret == 0) {
+        ret = dh_pvss_distribute_encoded_check(pp, transcript, len, U, V);
+    }
+
+    // cleanup
+    point_free(U);
+    point_free(V);
     for (int i=0; i<num_poly_coeffs; i++) {
         bn_free(poly_coeffs[i]);
     }
@@ -243,6 +890,61 @@ int dh_pvss_distribute_verify(dh_pvss_ctx *pp, nizk_dl_eq_proof *pi, const EC_PO
     return ret;
 }
 
+// memory map a distribution transcript file and verify it with dh_pvss_distribute_verify_encoded, returns 1 also if the file cannot be read
+int dh_pvss_distribute_verify_file(dh_pvss_ctx *pp, const char *path, const EC_POINT **com_keys) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return 1;
+    }
+    size_t len = (size_t)st.st_size;
+    void *transcript = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid
+    if (transcript == MAP_FAILED) {
+        return 1;
+    }
+    int ret = dh_pvss_distribute_verify_encoded(pp, (const unsigned char *)transcript, len, com_keys);
+    munmap(transcript, len);
+    return ret;
+}
+
+/* verify num_dists distributions to the same committee at once
+ * the committee keys are hashed once for all distributions, and the proofs are checked together
+ * (see nizk_dl_eq_verify_batch), U and V are still needed per distribution since they enter the proof challenges
+ * returns 0 if all distributions are valid and 1 otherwise
+ * if results is not NULL, results[i] is set to 0 (valid) or 1 (invalid) for distribution i */
+int dh_pvss_distribute_verify_batch(dh_pvss_ctx *pp, int num_dists, nizk_dl_eq_proof *pi[], const EC_POINT **encrypted_shares[], const EC_POINT *pub_dist[], const EC_POINT **com_keys, int *results) {
+    assert(num_dists > 0 && "dh_pvss_distribute_verify_batch: usage error, no distributions passed");
+    BIGNUM *com_keys_digest = distribute_com_keys_digest(pp, com_keys);
+    EC_POINT *U[num_dists];
+    EC_POINT *V[num_dists];
+    for (int i=0; i<num_dists; i++) {
+        BIGNUM *list_digests[3];
+        distribute_list_digests(pp, encrypted_shares[i], pub_dist[i], com_keys, com_keys_digest, list_digests);
+        distribute_verify_sums(pp, encrypted_shares[i], com_keys, (const BIGNUM **)list_digests, &U[i], &V[i]);
+        for (int j=0; j<3; j++) {
+            bn_free(list_digests[j]);
+        }
+    }
+
+    // verify dl eq proofs together
+    const EC_POINT *generator = get0_generator(pp->group);
+    int ret = nizk_dl_eq_verify_batch(pp->group, generator, num_dists, pub_dist, (const EC_POINT **)U, (const EC_POINT **)V, (const nizk_dl_eq_proof **)pi, results, pp->bn_ctx);
+
+    // cleanup
+    for (int i=0; i<num_dists; i++) {
+        point_free(U[i]);
+        point_free(V[i]);
+    }
+    bn_free(com_keys_digest);
+
+    return ret;
+}
+
 EC_POINT *dh_pvss_decrypt_share_prove(const EC_GROUP *group, const EC_POINT *dist_key_pub, dh_key_pair *C, const EC_POINT *encrypted_share, nizk_dl_eq_proof *pi, BN_CTX *ctx) {
     const EC_POINT *generator = get0_generator(group);
 
@@ -284,149 +986,691 @@ int dh_pvss_decrypt_share_verify(const EC_GROUP *group, const EC_POINT *dist_key
     return ret; // return proof verification result
 }
 
-EC_POINT *dh_pvss_reconstruct(const EC_GROUP *group, const EC_POINT *shares[], int share_indices[], int t, int length, BN_CTX *ctx){
-    // decrypted shares are plain shamir shares, so we just call shamir reconstruct
-    return shamir_shares_reconstruct(group, shares, share_indices, t, length, ctx);
+/* verify the decryptions of num_shares encrypted shares of one distribution at once
+ * the proofs share both bases (the generator and dist_key_pub), so they are checked with a single multi-scalar
+ * multiplication of 2 + 4*num_shares terms (see nizk_dl_eq_verify_batch_same_bases)
+ * returns 0 if all decryptions are valid and 1 otherwise
+ * if results is not NULL, a failing batch is bisected and results[i] is set to 0 (valid) or 1 (invalid) for share i */
+int dh_pvss_decrypt_share_verify_batch(const EC_GROUP *group, const EC_POINT *dist_key_pub, int num_shares, const EC_POINT *C_pub[], const EC_POINT *encrypted_shares[], const EC_POINT *decrypted_shares[], nizk_dl_eq_proof *pi[], int *results, BN_CTX *ctx) {
+    const EC_POINT *generator = get0_generator(group);
+
+    // compute differences, which are in the proof challenges
+    EC_POINT **diffs = malloc(num_shares * sizeof(EC_POINT *));
+    assert(diffs && "dh_pvss_decrypt_share_verify_batch: allocation error (diffs)");
+    for (int i=0; i<num_shares; i++) {
+        diffs[i] = point_new(group);
+        point_sub(group, diffs[i], encrypted_shares[i], decrypted_shares[i], ctx);
+    }
+
+    // verify proofs together
+    int ret = nizk_dl_eq_verify_batch_same_bases(group, generator, dist_key_pub, num_shares, C_pub, (const EC_POINT **)diffs, (const nizk_dl_eq_proof **)pi, results, ctx);
+
+    // cleanup
+    for (int i=0; i<num_shares; i++) {
+        point_free(diffs[i]);
+    }
+    free(diffs);
+
+    return ret;
 }
 
-EC_POINT *dh_pvss_committee_dist_key_calc(const EC_GROUP *group, const EC_POINT *keys[], int key_indices[], int t, int length, BN_CTX *ctx) {
-    // the implementation of this is identical to shamir reconstruct, so we call shamir reconstuct, but with keys instead of shares
-    return shamir_shares_reconstruct(group, keys, key_indices, t, length, ctx);
+/* combine the decryption statements of one member for num_dealers distributions into one, using weights r_j
+ * hashed from the member key and all distribution keys, encrypted shares and decrypted shares:
+ * dist_key_comb = sum_j r_j * dist_key_pubs[j] and diff_comb = sum_j r_j * (encrypted_shares[j] - decrypted_shares[j])
+ * every decryption is correct iff (up to a probability of error of about 1/order) log_G(C_pub) = log_dist_key_comb(diff_comb) */
+static void decrypt_shares_combine(const EC_GROUP *group, int num_dealers, const EC_POINT *C_pub, const EC_POINT *dist_key_pubs[], const EC_POINT *encrypted_shares[], const EC_POINT *decrypted_shares[], EC_POINT *dist_key_comb, EC_POINT *diff_comb, BN_CTX *ctx) {
+    const BIGNUM *order = get0_order(group);
+
+    // hash weights
+    BIGNUM *weights[num_dealers];
+    int list_len[] = { 1, num_dealers, num_dealers, num_dealers };
+    const EC_POINT **lists[] = { &C_pub, dist_key_pubs, encrypted_shares, decrypted_shares };
+    openssl_hash_points2poly(group, ctx, num_dealers, weights, 4, list_len, lists);
+
+    // combine distribution keys
+    point_weighted_sum(group, dist_key_comb, num_dealers, (const BIGNUM**)weights, dist_key_pubs, ctx);
+
+    // combine differences (NULL when the caller derives them from the private key)
+    if (diff_comb) {
+        const EC_POINT **points = malloc(2 * num_dealers * sizeof(EC_POINT *));
+        assert(points && "decrypt_shares_combine: allocation error (points)");
+        BIGNUM **scalars = bn_new_array(2 * num_dealers);
+        for (int j=0; j<num_dealers; j++) {
+            points[2*j] = encrypted_shares[j];
+            BN_copy(scalars[2*j], weights[j]);
+            points[2*j+1] = decrypted_shares[j];
+            BN_mod_sub(scalars[2*j+1], order, weights[j], order, ctx); // -r_j
+        }
+        point_weighted_sum(group, diff_comb, 2 * num_dealers, (const BIGNUM**)scalars, points, ctx);
+        bn_free_array(2 * num_dealers, scalars);
+        free(points);
+    }
+
+    // cleanup
+    for (int j=0; j<num_dealers; j++) {
+        bn_free(weights[j]);
+    }
 }
 
-void dh_pvss_reshare_prove(const EC_GROUP *group, int party_index, const dh_key_pair *party_committee_kp, const dh_key_pair *party_dist_kp, const EC_POINT *previous_dist_key, const EC_POINT *current_enc_shares[], const int current_n, const dh_pvss_ctx *next_pp, const EC_POINT *next_committee_keys[], EC_POINT *enc_re_shares[], nizk_reshare_proof *pi, BN_CTX *ctx) {
+/* decrypt one share from each of num_dealers distributions, and prove all decryptions with a single proof
+ * the proof and its verification cost do not grow with num_dealers, apart from the weighted sums (see decrypt_shares_combine) */
+void dh_pvss_decrypt_shares_prove(const EC_GROUP *group, int num_dealers, const EC_POINT *dist_key_pubs[], const dh_key_pair *C, const EC_POINT *encrypted_shares[], EC_POINT *decrypted_shares[], nizk_dl_eq_proof *pi, BN_CTX *ctx) {
     const EC_POINT *generator = get0_generator(group);
+    assert(num_dealers > 0 && "dh_pvss_decrypt_shares_prove: usage error, no dealers passed");
 
-    // compute shared key
+    // decrypt shares
     EC_POINT *shared_key = point_new(group);
-    point_mul(group, shared_key, party_committee_kp->priv, previous_dist_key, ctx);
+    for (int j=0; j<num_dealers; j++) {
+        point_mul(group, shared_key, C->priv, dist_key_pubs[j], ctx);
+        decrypted_shares[j] = point_new(group);
+        point_sub(group, decrypted_shares[j], encrypted_shares[j], shared_key, ctx);
+    }
 
-    // decrypt share
-    EC_POINT *decrypted_share = point_new(group);
-    point_sub(group, decrypted_share, current_enc_shares[party_index], shared_key, ctx);
+    // combine statements, the combined difference is simply priv times the combined distribution key
+    EC_POINT *dist_key_comb = point_new(group);
+    EC_POINT *diff_comb = point_new(group);
+    decrypt_shares_combine(group, num_dealers, C->pub, dist_key_pubs, encrypted_shares, (const EC_POINT**)decrypted_shares, dist_key_comb, NULL, ctx);
+    point_mul(group, diff_comb, C->priv, dist_key_comb, ctx);
 
-    // create shares of it for next epoch committe
-    EC_POINT *re_shares[next_pp->n];
-    shamir_shares_generate(group, re_shares, decrypted_share, next_pp->t, next_pp->n, ctx);
+    // prove correct decryptions
+    nizk_dl_eq_prove(group, C->priv, generator, C->pub, dist_key_comb, diff_comb, pi, ctx);
 
-    // encrypt the re_shares for the next epoch committee public keys
-    EC_POINT *enc_shared_key = point_new(group);
-    for (int i = 0; i<next_pp->n; i++) {
-        point_mul(group, enc_shared_key, party_dist_kp->priv, next_committee_keys[i], ctx);
-        enc_re_shares[i] = point_new(group);
-        point_add(group, enc_re_shares[i], enc_shared_key, re_shares[i], ctx);
-    }
+    // cleanup
+    point_free(diff_comb);
+    point_free(dist_key_comb);
+    point_free(shared_key);
+}
+
+int dh_pvss_decrypt_shares_verify(const EC_GROUP *group, int num_dealers, const EC_POINT *dist_key_pubs[], const EC_POINT *C_pub, const EC_POINT *encrypted_shares[], const EC_POINT *decrypted_shares[], const nizk_dl_eq_proof *pi, BN_CTX *ctx) {
+    const EC_POINT *generator = get0_generator(group);
+    assert(num_dealers > 0 && "dh_pvss_decrypt_shares_verify: usage error, no dealers passed");
+
+    // combine statements
+    EC_POINT *dist_key_comb = point_new(group);
+    EC_POINT *diff_comb = point_new(group);
+    decrypt_shares_combine(group, num_dealers, C_pub, dist_key_pubs, encrypted_shares, decrypted_shares, dist_key_comb, diff_comb, ctx);
+
+    // verify combined proof
+    int ret = nizk_dl_eq_verify(group, generator, C_pub, dist_key_comb, diff_comb, pi, ctx);
+
+    // cleanup
+    point_free(diff_comb);
+    point_free(dist_key_comb);
+
+    return ret;
+}
+
+EC_POINT *dh_pvss_reconstruct(const EC_GROUP *group, const EC_POINT *shares[], int share_indices[], int t, int length, BN_CTX *ctx){
+    // decrypted shares are plain shamir shares, so we just call shamir reconstruct
+    return shamir_shares_reconstruct(group, shares, share_indices, t, length, ctx);
+}
+
+EC_POINT *dh_pvss_committee_dist_key_calc(const EC_GROUP *group, const EC_POINT *keys[], int key_indices[], int t, int length, BN_CTX *ctx) {
+    // the implementation of this is identical to shamir reconstruct, so we call shamir reconstuct, but with keys instead of shares
+    return shamir_shares_reconstruct(group, keys, key_indices, t, length, ctx);
+}
+
+/* scrape terms hashed from the given point lists (the previous distribution(s)) for the next committee, which are
+ * returned, together with V' and the sum of the terms (modulo the group order) */
+static BIGNUM **reshare_scrape_terms(const EC_GROUP *group, int num_point_lists, int *num_points, const EC_POINT ***point_lists, const dh_pvss_ctx *next_pp, const EC_POINT *next_committee_keys[], EC_POINT *V_prime, BIGNUM *scrape_sum, BN_CTX *ctx) {
+    const BIGNUM *order = get0_order(group);
+    const int next_n = next_pp->n;
 
-    // degree n-t-1 polynomial <- hash(previous_dist_key, current_enc_shares)
-    const int num_poly_coeffs = next_pp->n - next_pp->t;
+    // degree n-t-1 polynomial <- hash(point lists)
+    const int num_poly_coeffs = next_n - next_pp->t;
     BIGNUM *poly_coeffs[num_poly_coeffs]; // polynomial container
-    const int num_point_lists = 2;
-//    int num_points[num_point_lists] = {1, current_n};
-//    const EC_POINT **point_lists[num_point_lists] = { &(previous_dist_key), current_enc_shares };
-    int num_points[2] = {1, current_n};
-    const EC_POINT **point_lists[2] = { &(previous_dist_key), current_enc_shares };
     openssl_hash_points2poly(group, ctx, num_poly_coeffs, poly_coeffs, num_point_lists, num_points, point_lists);
 
     // generate scrape sum terms
-    BIGNUM *scrape_terms[next_pp->n];
-    generate_scrape_sum_terms(group, scrape_terms, next_pp->betas, next_pp->v_primes, poly_coeffs, next_pp->n, num_poly_coeffs, ctx);
+    BIGNUM **scrape_terms = malloc(next_n * sizeof(BIGNUM *));
+    assert(scrape_terms && "reshare_scrape_terms: allocation error (scrape terms)");
+    generate_scrape_sum_terms(group, scrape_terms, next_pp->params->betas, next_pp->params->v_primes, next_pp->params->scalar_len, poly_coeffs, 0, next_n, num_poly_coeffs, ctx);
+
+    // compute V' and the sum of the terms
+    point_weighted_sum(group, V_prime, next_n, (const BIGNUM**)scrape_terms, next_committee_keys, ctx);
+    BN_zero(scrape_sum);
+    for (int i=0; i<next_n; i++) {
+        BN_mod_add(scrape_sum, scrape_sum, scrape_terms[i], order, ctx);
+    }
 
-    // compute U', V' and W'
-    EC_POINT *enc_re_share_diffs[next_pp->n];
-    for (int i=0; i<next_pp->n; i++) {
-        enc_re_share_diffs[i] = point_new(group);
-        point_sub(group, enc_re_share_diffs[i], enc_re_shares[i], current_enc_shares[party_index], ctx);
+    // cleanup
+    for (int i=0; i<num_poly_coeffs; i++) {
+        bn_free(poly_coeffs[i]);
     }
-    EC_POINT *U_prime = point_new(group);
-    EC_POINT *V_prime = point_new(group);
-    EC_POINT *W_prime = point_new(group);
 
-    point_weighted_sum(group, U_prime, next_pp->n, (const BIGNUM**)scrape_terms, (const EC_POINT**)enc_re_share_diffs, ctx);
-    point_weighted_sum(group, V_prime, next_pp->n, (const BIGNUM**)scrape_terms, next_committee_keys, ctx);
+    return scrape_terms;
+}
+
+void dh_pvss_reshare_epoch_ctx_init(dh_pvss_reshare_epoch_ctx *epoch, const EC_GROUP *group, const EC_POINT *previous_dist_key, const EC_POINT *current_enc_shares[], const int current_n, const dh_pvss_ctx *next_pp, const EC_POINT *next_committee_keys[], BN_CTX *ctx) {
+    const BIGNUM *order = get0_order(group);
+
+    epoch->group = group;
+    epoch->previous_dist_key = previous_dist_key;
+    epoch->current_enc_shares = current_enc_shares;
+    epoch->current_n = current_n;
+    epoch->next_pp = next_pp;
+    epoch->next_committee_keys = next_committee_keys;
+
+    // scrape terms <- hash(previous_dist_key, current_enc_shares), and V'
+    int num_points[2] = {1, current_n};
+    const EC_POINT **point_lists[2] = { &(previous_dist_key), current_enc_shares };
+    epoch->V_prime = point_new(group);
     BIGNUM *W_sum = bn_new();
-    for (int i=0; i<next_pp->n; i++) {
-        BN_add(W_sum, W_sum, scrape_terms[i]);
+    epoch->scrape_terms = reshare_scrape_terms(group, 2, num_points, point_lists, next_pp, next_committee_keys, epoch->V_prime, W_sum, ctx);
+
+    // compute W' and the negated sum of the scrape terms, which weighs the party's encrypted share in U'
+    epoch->W_prime = point_new(group);
+    point_mul(group, epoch->W_prime, W_sum, previous_dist_key, ctx);
+    epoch->neg_scrape_sum = bn_new();
+    BN_mod_sub(epoch->neg_scrape_sum, order, W_sum, order, ctx);
+
+    // cleanup
+    bn_free(W_sum);
+}
+
+void dh_pvss_reshare_epoch_ctx_free(dh_pvss_reshare_epoch_ctx *epoch) {
+    for (int i=0; i<epoch->next_pp->n; i++) {
+        bn_free(epoch->scrape_terms[i]);
+    }
+    free(epoch->scrape_terms);
+    point_free(epoch->V_prime);
+    point_free(epoch->W_prime);
+    bn_free(epoch->neg_scrape_sum);
+}
+
+// U' = sum_i s_i * (enc_re_shares[i] - current_enc_shares[party_index]), as one weighted sum of n+1 terms
+static void reshare_U_prime(const dh_pvss_reshare_epoch_ctx *epoch, int party_index, const EC_POINT *enc_re_shares[], EC_POINT *U_prime, BN_CTX *ctx) {
+    const int next_n = epoch->next_pp->n;
+    const BIGNUM *terms[next_n + 1];
+    const EC_POINT *points[next_n + 1];
+    for (int i=0; i<next_n; i++) {
+        terms[i] = epoch->scrape_terms[i];
+        points[i] = enc_re_shares[i];
+    }
+    terms[next_n] = epoch->neg_scrape_sum;
+    points[next_n] = epoch->current_enc_shares[party_index];
+    point_weighted_sum(epoch->group, U_prime, next_n + 1, terms, points, ctx);
+}
+
+void dh_pvss_reshare_prove_epoch(const dh_pvss_reshare_epoch_ctx *epoch, int party_index, const dh_key_pair *party_committee_kp, const dh_key_pair *party_dist_kp, EC_POINT *enc_re_shares[], nizk_reshare_proof *pi, BN_CTX *ctx) {
+    const EC_GROUP *group = epoch->group;
+    const EC_POINT *generator = get0_generator(group);
+    const dh_pvss_ctx *next_pp = epoch->next_pp;
+
+    // compute shared key
+    EC_POINT *shared_key = point_new(group);
+    point_mul(group, shared_key, party_committee_kp->priv, epoch->previous_dist_key, ctx);
+
+    // decrypt share
+    EC_POINT *decrypted_share = point_new(group);
+    point_sub(group, decrypted_share, epoch->current_enc_shares[party_index], shared_key, ctx);
+
+    // create shares of it for next epoch committe
+    EC_POINT *re_shares[next_pp->n];
+    shamir_shares_generate(group, re_shares, decrypted_share, next_pp->t, next_pp->n, ctx);
+
+    // encrypt the re_shares for the next epoch committee public keys
+    EC_POINT *enc_shared_key = point_new(group);
+    for (int i = 0; i<next_pp->n; i++) {
+        point_mul(group, enc_shared_key, party_dist_kp->priv, epoch->next_committee_keys[i], ctx);
+        enc_re_shares[i] = point_new(group);
+        point_add(group, enc_re_shares[i], enc_shared_key, re_shares[i], ctx);
     }
-    point_mul(group, W_prime, W_sum, previous_dist_key, ctx);
+
+    // compute U' (V' and W' are shared by all parties)
+    EC_POINT *U_prime = point_new(group);
+    reshare_U_prime(epoch, party_index, (const EC_POINT**)enc_re_shares, U_prime, ctx);
 
     // prove correctness
-    nizk_reshare_prove(group, party_committee_kp->priv, party_dist_kp->priv, generator, V_prime, W_prime, party_committee_kp->pub, party_dist_kp->pub, U_prime, pi, ctx);
+    nizk_reshare_prove(group, party_committee_kp->priv, party_dist_kp->priv, generator, epoch->V_prime, epoch->W_prime, party_committee_kp->pub, party_dist_kp->pub, U_prime, pi, ctx);
 
     // cleanup
-    for (int i=0; i<num_poly_coeffs; i++) {
-        bn_free(poly_coeffs[i]);
-    }
     for (int i=0; i<next_pp->n; i++) {
         point_free(re_shares[i]);
-        bn_free(scrape_terms[i]);
-        point_free(enc_re_share_diffs[i]);
     }
     point_free(enc_shared_key);
     point_free(U_prime);
-    point_free(V_prime);
-    bn_free(W_sum);
-    point_free(W_prime);
     point_free(decrypted_share);
     point_free(shared_key);
 }
 
-int dh_pvss_reshare_verify(const dh_pvss_ctx *pp, const dh_pvss_ctx *next_pp, int party_index, const EC_POINT *party_committee_pub_key, const EC_POINT *party_dist_pub_key, const EC_POINT *previous_dist_key, const EC_POINT *current_enc_shares[], const EC_POINT *next_committee_keys[], EC_POINT *enc_re_shares[], nizk_reshare_proof *pi) {
-    const EC_GROUP *group = pp->group; // TODO: use next group where appropriate
+int dh_pvss_reshare_verify_epoch(const dh_pvss_reshare_epoch_ctx *epoch, int party_index, const EC_POINT *party_committee_pub_key, const EC_POINT *party_dist_pub_key, const EC_POINT *enc_re_shares[], const nizk_reshare_proof *pi, BN_CTX *ctx) {
+    const EC_GROUP *group = epoch->group;
     const EC_POINT *generator = get0_generator(group);
-    BN_CTX *ctx = pp->bn_ctx; // TODO: use next bn_ctx where appropriate
-    const int current_n = pp->n;
 
-    // degree n-t-1 polynomial <- hash(previous_dist_key, current_enc_shares)
-    const int num_poly_coeffs = next_pp->n - next_pp->t;
-    BIGNUM *poly_coeffs[num_poly_coeffs]; // polynomial container
-    const int num_point_lists = 2;
-//    int num_points[num_point_lists] = {1, current_n};
-//    const EC_POINT **point_lists[num_point_lists] = { &(previous_dist_key), current_enc_shares };
-    int num_points[2] = {1, current_n};
-    const EC_POINT **point_lists[2] = { &(previous_dist_key), current_enc_shares };
-    openssl_hash_points2poly(group, ctx, num_poly_coeffs, poly_coeffs, num_point_lists, num_points, point_lists);
+    // compute U' (V' and W' are shared by all parties)
+    EC_POINT *U_prime = point_new(group);
+    reshare_U_prime(epoch, party_index, enc_re_shares, U_prime, ctx);
 
-    // generate scrape sum terms
-    BIGNUM *scrape_terms[next_pp->n];
-    generate_scrape_sum_terms(group, scrape_terms, next_pp->betas, next_pp->v_primes, poly_coeffs, next_pp->n, num_poly_coeffs, ctx);
+    // verify correctness
+    int ret = nizk_reshare_verify(group, generator, epoch->V_prime, epoch->W_prime, party_committee_pub_key, party_dist_pub_key, U_prime, pi, ctx);
 
-    // compute U', V' and W'
-    EC_POINT *enc_re_share_diffs[next_pp->n];
-    for (int i=0; i<next_pp->n; i++) {
-        enc_re_share_diffs[i] = point_new(group);
-        point_sub(group, enc_re_share_diffs[i], enc_re_shares[i], current_enc_shares[party_index], ctx);
+    // cleanup
+    point_free(U_prime);
+
+    return ret;
+}
+
+/* verify the reshares of num_parties parties of one epoch at once
+ * the U' of every party is needed for its proof challenge, so it is still computed per party, while the proofs,
+ * which share the bases G, V' and W', are checked with a single multi-scalar multiplication of 3 + 6*num_parties terms
+ * returns 0 if all reshares are valid and 1 otherwise
+ * if results is not NULL, a failing batch is bisected and results[i] is set to 0 (valid) or 1 (invalid) for party_indices[i] */
+int dh_pvss_reshare_verify_batch(const dh_pvss_reshare_epoch_ctx *epoch, int num_parties, const int party_indices[], const EC_POINT *party_committee_pub_keys[], const EC_POINT *party_dist_pub_keys[], const EC_POINT **enc_re_shares[], const nizk_reshare_proof *pi[], int *results, BN_CTX *ctx) {
+    const EC_GROUP *group = epoch->group;
+    const EC_POINT *generator = get0_generator(group);
+
+    // compute U' of every party
+    EC_POINT **U_primes = malloc(num_parties * sizeof(EC_POINT *));
+    assert(U_primes && "dh_pvss_reshare_verify_batch: allocation error (U primes)");
+    for (int i=0; i<num_parties; i++) {
+        U_primes[i] = point_new(group);
+        reshare_U_prime(epoch, party_indices[i], enc_re_shares[i], U_primes[i], ctx);
     }
-    EC_POINT *U_prime = point_new(group);
-    EC_POINT *V_prime = point_new(group);
-    EC_POINT *W_prime = point_new(group);
 
-    point_weighted_sum(group, U_prime, next_pp->n, (const BIGNUM**)scrape_terms, (const EC_POINT**)enc_re_share_diffs, ctx);
-    point_weighted_sum(group, V_prime, next_pp->n, (const BIGNUM**)scrape_terms, next_committee_keys, ctx);
+    // verify proofs together
+    int ret = nizk_reshare_verify_batch(group, generator, epoch->V_prime, epoch->W_prime, num_parties, party_committee_pub_keys, party_dist_pub_keys, (const EC_POINT**)U_primes, pi, results, ctx);
+
+    // cleanup
+    for (int i=0; i<num_parties; i++) {
+        point_free(U_primes[i]);
+    }
+    free(U_primes);
+
+    return ret;
+}
+
+// shared state of the workers of dh_pvss_reshare_verify_quorum
+typedef struct {
+    const dh_pvss_reshare_epoch_ctx *epoch;
+    int num_reshares;
+    int num_needed;
+    const int *party_indices;
+    const EC_POINT **party_committee_pub_keys;
+    const EC_POINT **party_dist_pub_keys;
+    const EC_POINT ***enc_re_shares;
+    const nizk_reshare_proof **pi;
+    atomic_int next; // position of the next reshare to verify
+    atomic_int num_valid;
+    int *status; // per position, -1 (not verified), 0 (valid) or 1 (invalid)
+} reshare_quorum_job;
+
+// one worker, which takes reshares in order until enough are valid or none are left
+static void reshare_quorum_worker(int chunk, int from, int to, BN_CTX *ctx, void *arg) {
+    (void)chunk; // every worker takes reshares from the shared position, rather than a range
+    (void)from;
+    (void)to;
+    reshare_quorum_job *job = arg;
+    while (atomic_load(&job->num_valid) < job->num_needed) {
+        int pos = atomic_fetch_add(&job->next, 1);
+        if (pos >= job->num_reshares) {
+            break;
+        }
+        int ret = dh_pvss_reshare_verify_epoch(job->epoch, job->party_indices[pos], job->party_committee_pub_keys[pos], job->party_dist_pub_keys[pos], job->enc_re_shares[pos], job->pi[pos], ctx);
+        job->status[pos] = ret;
+        if (ret == 0) {
+            atomic_fetch_add(&job->num_valid, 1);
+        }
+    }
+}
+
+/* verify reshares in the given (arrival or priority) order, using num_threads workers, until t+1 of them are valid
+ * on success, 0 is returned and valid_indices holds the t+1 first valid parties in that order, as indices starting from 1,
+ * ready for reconstruction (see dh_pvss_reconstruct_reshare), and 1 is returned if fewer than t+1 reshares are valid
+ * if num_verified is not NULL, it is set to the number of reshares that were verified */
+int dh_pvss_reshare_verify_quorum(const dh_pvss_reshare_epoch_ctx *epoch, int t, int num_threads, int num_reshares, const int party_indices[], const EC_POINT *party_committee_pub_keys[], const EC_POINT *party_dist_pub_keys[], const EC_POINT **enc_re_shares[], const nizk_reshare_proof *pi[], int *valid_indices, int *num_verified, BN_CTX *ctx) {
+    assert(num_threads > 0 && "dh_pvss_reshare_verify_quorum: usage error, num_threads must be positive");
+
+    reshare_quorum_job job;
+    job.epoch = epoch;
+    job.num_reshares = num_reshares;
+    job.num_needed = t + 1;
+    job.party_indices = party_indices;
+    job.party_committee_pub_keys = party_committee_pub_keys;
+    job.party_dist_pub_keys = party_dist_pub_keys;
+    job.enc_re_shares = enc_re_shares;
+    job.pi = pi;
+    atomic_init(&job.next, 0);
+    atomic_init(&job.num_valid, 0);
+    job.status = malloc(num_reshares * sizeof(int));
+    assert(job.status && "dh_pvss_reshare_verify_quorum: allocation error (status)");
+    for (int i=0; i<num_reshares; i++) {
+        job.status[i] = -1;
+    }
+
+    // one chunk per worker, the reshares are handed out by the workers themselves
+    int num_workers = num_threads < num_reshares ? num_threads : num_reshares;
+    parallel_for(num_workers, num_workers, reshare_quorum_worker, &job, ctx);
+
+    // collect the first t+1 valid reshares
+    int num_found = 0;
+    int count = 0;
+    for (int i=0; i<num_reshares; i++) {
+        count += job.status[i] != -1;
+        if (job.status[i] == 0 && num_found < t + 1) {
+            valid_indices[num_found++] = party_indices[i] + 1;
+        }
+    }
+    if (num_verified) {
+        *num_verified = count;
+    }
+
+    // cleanup
+    free(job.status);
+
+    return num_found == t + 1 ? 0 : 1;
+}
+
+void dh_pvss_multi_reshare_ctx_init(dh_pvss_multi_reshare_ctx *multi, const EC_GROUP *group, int num_secrets, const EC_POINT *previous_dist_keys[], const EC_POINT **current_enc_shares[], const int current_n, const dh_pvss_ctx *next_pp, const EC_POINT *next_committee_keys[], BN_CTX *ctx) {
+    const BIGNUM *order = get0_order(group);
+    assert(num_secrets > 0 && "dh_pvss_multi_reshare_ctx_init: usage error, no secrets passed");
+
+    multi->group = group;
+    multi->num_secrets = num_secrets;
+    multi->previous_dist_keys = previous_dist_keys;
+    multi->current_enc_shares = current_enc_shares;
+    multi->current_n = current_n;
+    multi->next_pp = next_pp;
+    multi->next_committee_keys = next_committee_keys;
+
+    // scrape terms <- hash(all previous distributions), and V', which are common to all secrets
+    int num_points[2 * num_secrets];
+    const EC_POINT **point_lists[2 * num_secrets];
+    for (int k=0; k<num_secrets; k++) {
+        num_points[2*k] = 1;
+        point_lists[2*k] = &previous_dist_keys[k];
+        num_points[2*k+1] = current_n;
+        point_lists[2*k+1] = current_enc_shares[k];
+    }
+    multi->V_prime = point_new(group);
     BIGNUM *W_sum = bn_new();
-    for (int i=0; i<next_pp->n; i++) {
-        BN_add(W_sum, W_sum, scrape_terms[i]);
+    multi->scrape_terms = reshare_scrape_terms(group, 2 * num_secrets, num_points, point_lists, next_pp, next_committee_keys, multi->V_prime, W_sum, ctx);
+
+    // compute W' of every secret, and the negated sum of the scrape terms
+    multi->W_primes = malloc(num_secrets * sizeof(EC_POINT *));
+    assert(multi->W_primes && "dh_pvss_multi_reshare_ctx_init: allocation error (W primes)");
+    for (int k=0; k<num_secrets; k++) {
+        multi->W_primes[k] = point_new(group);
+        point_mul(group, multi->W_primes[k], W_sum, previous_dist_keys[k], ctx);
+    }
+    multi->neg_scrape_sum = bn_new();
+    BN_mod_sub(multi->neg_scrape_sum, order, W_sum, order, ctx);
+
+    // cleanup
+    bn_free(W_sum);
+}
+
+void dh_pvss_multi_reshare_ctx_free(dh_pvss_multi_reshare_ctx *multi) {
+    for (int i=0; i<multi->next_pp->n; i++) {
+        bn_free(multi->scrape_terms[i]);
     }
-    point_mul(group, W_prime, W_sum, previous_dist_key, ctx);
+    free(multi->scrape_terms);
+    for (int k=0; k<multi->num_secrets; k++) {
+        point_free(multi->W_primes[k]);
+    }
+    free(multi->W_primes);
+    point_free(multi->V_prime);
+    bn_free(multi->neg_scrape_sum);
+}
+
+/* combine the reshare statements of one party for all secrets, which share V', using weights r_k hashed from
+ * the party's keys and re-shares: D* = sum_k r_k * D_k, W* = sum_k r_k * W'_k and U* = sum_k r_k * U'_k,
+ * the latter as one weighted sum over all re-shares and encrypted shares
+ * all reshares are correct iff (up to a probability of error of about 1/order) U* = d* * V' - c * W*,
+ * with d* = sum_k r_k * d_k, which is a single reshare proof statement */
+static void multi_reshare_combine(const dh_pvss_multi_reshare_ctx *multi, int party_index, const EC_POINT *party_committee_pub_key, const EC_POINT *party_dist_pub_keys[], const EC_POINT **enc_re_shares[], BIGNUM *weights[], EC_POINT *D_comb, EC_POINT *W_comb, EC_POINT *U_comb, BN_CTX *ctx) {
+    const EC_GROUP *group = multi->group;
+    const BIGNUM *order = get0_order(group);
+    const int m = multi->num_secrets;
+    const int next_n = multi->next_pp->n;
+
+    // hash weights
+    int num_points[4 + m];
+    const EC_POINT **point_lists[4 + m];
+    num_points[0] = 1;
+    point_lists[0] = &party_committee_pub_key;
+    num_points[1] = 1;
+    point_lists[1] = (const EC_POINT **)&multi->V_prime;
+    num_points[2] = m;
+    point_lists[2] = party_dist_pub_keys;
+    num_points[3] = m;
+    point_lists[3] = (const EC_POINT **)multi->W_primes;
+    for (int k=0; k<m; k++) {
+        num_points[4 + k] = next_n;
+        point_lists[4 + k] = enc_re_shares[k];
+    }
+    openssl_hash_points2poly(group, ctx, m, weights, 4 + m, num_points, point_lists);
+
+    // combine distribution keys and W'
+    point_weighted_sum(group, D_comb, m, (const BIGNUM**)weights, party_dist_pub_keys, ctx);
+    point_weighted_sum(group, W_comb, m, (const BIGNUM**)weights, (const EC_POINT**)multi->W_primes, ctx);
+
+    // combine U', with r_k * s_i on re-share i of secret k, and -r_k * sum_i s_i on the party's encrypted share of secret k
+    const int num_terms = m * (next_n + 1);
+    const EC_POINT **points = malloc(num_terms * sizeof(EC_POINT *));
+    assert(points && "multi_reshare_combine: allocation error (points)");
+    BIGNUM **scalars = bn_new_array(num_terms);
+    for (int k=0; k<m; k++) {
+        int j = k * (next_n + 1);
+        for (int i=0; i<next_n; i++) {
+            points[j] = enc_re_shares[k][i];
+            BN_mod_mul(scalars[j++], weights[k], multi->scrape_terms[i], order, ctx);
+        }
+        points[j] = multi->current_enc_shares[k][party_index];
+        BN_mod_mul(scalars[j], weights[k], multi->neg_scrape_sum, order, ctx);
+    }
+    point_weighted_sum(group, U_comb, num_terms, (const BIGNUM**)scalars, points, ctx);
+
+    // cleanup
+    bn_free_array(num_terms, scalars);
+    free(points);
+}
+
+/* reshare num_secrets secrets in one pass, with a single proof for all of them
+ * every secret is encrypted under its own distribution key pair (party_dist_kps[k]), as masks must not be reused,
+ * so that encryption remains num_secrets * next_n multiplications, while the proof and its verification do not grow
+ * with num_secrets, apart from the weighted sums (see multi_reshare_combine) */
+void dh_pvss_multi_reshare_prove(const dh_pvss_multi_reshare_ctx *multi, int party_index, const dh_key_pair *party_committee_kp, const dh_key_pair party_dist_kps[], EC_POINT **enc_re_shares[], nizk_reshare_proof *pi, BN_CTX *ctx) {
+    const EC_GROUP *group = multi->group;
+    const BIGNUM *order = get0_order(group);
+    const EC_POINT *generator = get0_generator(group);
+    const dh_pvss_ctx *next_pp = multi->next_pp;
+    const int m = multi->num_secrets;
+
+    // decrypt, re-share and encrypt every secret
+    EC_POINT *shared_key = point_new(group);
+    EC_POINT *decrypted_share = point_new(group);
+    EC_POINT *enc_shared_key = point_new(group);
+    EC_POINT *re_shares[next_pp->n];
+    for (int k=0; k<m; k++) {
+        point_mul(group, shared_key, party_committee_kp->priv, multi->previous_dist_keys[k], ctx);
+        point_sub(group, decrypted_share, multi->current_enc_shares[k][party_index], shared_key, ctx);
+        shamir_shares_generate(group, re_shares, decrypted_share, next_pp->t, next_pp->n, ctx);
+        for (int i=0; i<next_pp->n; i++) {
+            point_mul(group, enc_shared_key, party_dist_kps[k].priv, multi->next_committee_keys[i], ctx);
+            enc_re_shares[k][i] = point_new(group);
+            point_add(group, enc_re_shares[k][i], enc_shared_key, re_shares[i], ctx);
+            point_free(re_shares[i]);
+        }
+    }
+
+    // combine statements
+    const EC_POINT *dist_pub_keys[m];
+    for (int k=0; k<m; k++) {
+        dist_pub_keys[k] = party_dist_kps[k].pub;
+    }
+    BIGNUM *weights[m];
+    EC_POINT *D_comb = point_new(group);
+    EC_POINT *W_comb = point_new(group);
+    EC_POINT *U_comb = point_new(group);
+    multi_reshare_combine(multi, party_index, party_committee_kp->pub, dist_pub_keys, (const EC_POINT***)enc_re_shares, weights, D_comb, W_comb, U_comb, ctx);
+    BIGNUM *d_comb = bn_new();
+    BIGNUM *tmp = bn_new();
+    for (int k=0; k<m; k++) {
+        BN_mod_mul(tmp, weights[k], party_dist_kps[k].priv, order, ctx);
+        BN_mod_add(d_comb, d_comb, tmp, order, ctx);
+    }
+
+    // prove correctness
+    nizk_reshare_prove(group, party_committee_kp->priv, d_comb, generator, multi->V_prime, W_comb, party_committee_kp->pub, D_comb, U_comb, pi, ctx);
+
+    // cleanup
+    for (int k=0; k<m; k++) {
+        bn_free(weights[k]);
+    }
+    bn_free(tmp);
+    bn_free(d_comb);
+    point_free(U_comb);
+    point_free(W_comb);
+    point_free(D_comb);
+    point_free(enc_shared_key);
+    point_free(decrypted_share);
+    point_free(shared_key);
+}
+
+int dh_pvss_multi_reshare_verify(const dh_pvss_multi_reshare_ctx *multi, int party_index, const EC_POINT *party_committee_pub_key, const EC_POINT *party_dist_pub_keys[], const EC_POINT **enc_re_shares[], const nizk_reshare_proof *pi, BN_CTX *ctx) {
+    const EC_GROUP *group = multi->group;
+    const EC_POINT *generator = get0_generator(group);
+    const int m = multi->num_secrets;
+
+    // combine statements
+    BIGNUM *weights[m];
+    EC_POINT *D_comb = point_new(group);
+    EC_POINT *W_comb = point_new(group);
+    EC_POINT *U_comb = point_new(group);
+    multi_reshare_combine(multi, party_index, party_committee_pub_key, party_dist_pub_keys, enc_re_shares, weights, D_comb, W_comb, U_comb, ctx);
 
     // verify correctness
-    int ret = nizk_reshare_verify(group, generator, V_prime, W_prime, party_committee_pub_key, party_dist_pub_key, U_prime, pi, ctx);
+    int ret = nizk_reshare_verify(group, generator, multi->V_prime, W_comb, party_committee_pub_key, D_comb, U_comb, pi, ctx);
+
+    // cleanup
+    for (int k=0; k<m; k++) {
+        bn_free(weights[k]);
+    }
+    point_free(U_comb);
+    point_free(W_comb);
+    point_free(D_comb);
+
+    return ret;
+}
+
+void dh_pvss_reshare_prove(const EC_GROUP *group, int party_index, const dh_key_pair *party_committee_kp, const dh_key_pair *party_dist_kp, const EC_POINT *previous_dist_key, const EC_POINT *current_enc_shares[], const int current_n, const dh_pvss_ctx *next_pp, const EC_POINT *next_committee_keys[], EC_POINT *enc_re_shares[], nizk_reshare_proof *pi, BN_CTX *ctx) {
+    // a single reshare is an epoch of its own
+    dh_pvss_reshare_epoch_ctx epoch;
+    dh_pvss_reshare_epoch_ctx_init(&epoch, group, previous_dist_key, current_enc_shares, current_n, next_pp, next_committee_keys, ctx);
+    dh_pvss_reshare_prove_epoch(&epoch, party_index, party_committee_kp, party_dist_kp, enc_re_shares, pi, ctx);
+    dh_pvss_reshare_epoch_ctx_free(&epoch);
+}
+
+int dh_pvss_reshare_verify(const dh_pvss_ctx *pp, const dh_pvss_ctx *next_pp, int party_index, const EC_POINT *party_committee_pub_key, const EC_POINT *party_dist_pub_key, const EC_POINT *previous_dist_key, const EC_POINT *current_enc_shares[], const EC_POINT *next_committee_keys[], EC_POINT *enc_re_shares[], nizk_reshare_proof *pi) {
+    const EC_GROUP *group = pp->group; // TODO: use next group where appropriate
+    BN_CTX *ctx = pp->bn_ctx; // TODO: use next bn_ctx where appropriate
+
+    // a single reshare is an epoch of its own
+    dh_pvss_reshare_epoch_ctx epoch;
+    dh_pvss_reshare_epoch_ctx_init(&epoch, group, previous_dist_key, current_enc_shares, pp->n, next_pp, next_committee_keys, ctx);
+    int ret = dh_pvss_reshare_verify_epoch(&epoch, party_index, party_committee_pub_key, party_dist_pub_key, (const EC_POINT**)enc_re_shares, pi, ctx);
+    dh_pvss_reshare_epoch_ctx_free(&epoch);
+
+    return ret;
+}
+
+/* proactive refresh, for a committee that stays the same
+ * a party adds an encrypted sharing of zero, refresh_shares[i] = refresh_kp->priv * com_keys[i] + Z_i, which is proved
+ * with the scrape check over the evaluation points 0..n (with Z_0 at infinity), i.e., the sum of scrape terms times
+ * refresh_shares equals refresh_kp->priv * V, where V is the same sum over com_keys, which is a DLEQ proof
+ * both sides cost O(n), instead of the O(n^2) of a full reshare */
+static void refresh_U_V(const dh_pvss_ctx *pp, const EC_POINT *dist_key, const EC_POINT *com_keys[], const EC_POINT *refresh_pub, const EC_POINT *refresh_shares[], EC_POINT *U, EC_POINT *V) {
+    const EC_GROUP *group = pp->group;
+    BN_CTX *ctx = pp->bn_ctx;
+    const int n = pp->n;
+
+    // degree n-t-1 polynomial <- hash(dist_key, refresh_pub, refresh_shares, com_keys)
+    const int num_poly_coeffs = n - pp->t;
+    BIGNUM *poly_coeffs[num_poly_coeffs];
+    int num_points[4] = {1, 1, n, n};
+    const EC_POINT **point_lists[4] = { &dist_key, &refresh_pub, refresh_shares, com_keys };
+    openssl_hash_points2poly(group, ctx, num_poly_coeffs, poly_coeffs, 4, num_points, point_lists);
+
+    // scrape terms of the code over 0..n
+    BIGNUM *scrape_terms[n];
+    generate_scrape_sum_terms(group, scrape_terms, pp->params->betas, pp->params->v_primes, pp->params->scalar_len, poly_coeffs, 0, n, num_poly_coeffs, ctx);
+    point_weighted_sum(group, U, n, (const BIGNUM**)scrape_terms, refresh_shares, ctx);
+    point_weighted_sum(group, V, n, (const BIGNUM**)scrape_terms, com_keys, ctx);
 
     // cleanup
     for (int i=0; i<num_poly_coeffs; i++) {
         bn_free(poly_coeffs[i]);
     }
-    for (int i=0; i<next_pp->n; i++) {
+    for (int i=0; i<n; i++) {
         bn_free(scrape_terms[i]);
-        point_free(enc_re_share_diffs[i]);
     }
-    point_free(U_prime);
-    point_free(V_prime);
-    bn_free(W_sum);
-    point_free(W_prime);
+}
+
+void dh_pvss_refresh_prove(const dh_pvss_ctx *pp, const EC_POINT *dist_key, const EC_POINT *com_keys[], const dh_key_pair *refresh_kp, EC_POINT *refresh_shares[], nizk_dl_eq_proof *pi) {
+    const EC_GROUP *group = pp->group;
+    const EC_POINT *generator = get0_generator(group);
+    BN_CTX *ctx = pp->bn_ctx;
+    const int n = pp->n;
+
+    // share zero
+    EC_POINT *zero = point_new(group); // point at infinity
+    EC_POINT *zero_shares[n];
+    shamir_shares_generate(group, zero_shares, zero, pp->t, n, ctx);
+
+    // encrypt the shares
+    EC_POINT *shared_key = point_new(group);
+    for (int i=0; i<n; i++) {
+        point_mul(group, shared_key, refresh_kp->priv, com_keys[i], ctx);
+        refresh_shares[i] = point_new(group);
+        point_add(group, refresh_shares[i], shared_key, zero_shares[i], ctx);
+    }
+
+    // prove that zero was shared
+    EC_POINT *U = point_new(group);
+    EC_POINT *V = point_new(group);
+    refresh_U_V(pp, dist_key, com_keys, refresh_kp->pub, (const EC_POINT**)refresh_shares, U, V);
+    nizk_dl_eq_prove(group, refresh_kp->priv, generator, refresh_kp->pub, V, U, pi, ctx);
+
+    // cleanup
+    for (int i=0; i<n; i++) {
+        point_free(zero_shares[i]);
+    }
+    point_free(U);
+    point_free(V);
+    point_free(shared_key);
+    point_free(zero);
+}
+
+int dh_pvss_refresh_verify(const dh_pvss_ctx *pp, const EC_POINT *dist_key, const EC_POINT *com_keys[], const EC_POINT *refresh_pub, const EC_POINT *refresh_shares[], const nizk_dl_eq_proof *pi) {
+    const EC_GROUP *group = pp->group;
+    const EC_POINT *generator = get0_generator(group);
+
+    EC_POINT *U = point_new(group);
+    EC_POINT *V = point_new(group);
+    refresh_U_V(pp, dist_key, com_keys, refresh_pub, refresh_shares, U, V);
+    int ret = nizk_dl_eq_verify(group, generator, refresh_pub, V, U, pi, pp->bn_ctx);
+
+    // cleanup
+    point_free(U);
+    point_free(V);
 
     return ret;
 }
 
+/* add num_refreshes verified refreshes to the encrypted shares and the distribution key, in place
+ * the shares are then fresh shares of the same secret, encrypted under the new distribution key */
+void dh_pvss_refresh_apply(const dh_pvss_ctx *pp, int num_refreshes, const EC_POINT *refresh_pubs[], const EC_POINT **refresh_shares[], EC_POINT *dist_key, EC_POINT *enc_shares[]) {
+    const EC_GROUP *group = pp->group;
+    BN_CTX *ctx = pp->bn_ctx;
+    for (int j=0; j<num_refreshes; j++) {
+        point_add(group, dist_key, dist_key, refresh_pubs[j], ctx);
+        for (int i=0; i<pp->n; i++) {
+            point_add(group, enc_shares[i], enc_shares[i], refresh_shares[j][i], ctx);
+        }
+    }
+}
+
 EC_POINT *dh_pvss_reconstruct_reshare(const dh_pvss_ctx *pp, int num_valid_indices, int *valid_indices, EC_POINT *enc_re_shares[]) {
     const EC_GROUP *group = pp->group;
     const BIGNUM *order = get0_order(group);
@@ -456,26 +1700,188 @@ EC_POINT *dh_pvss_reconstruct_reshare(const dh_pvss_ctx *pp, int num_valid_indic
     return sum;
 }
 
-static int dh_pvss_test_1(int print) {
-    const EC_GROUP *group = get0_group();
-    BN_CTX *ctx = BN_CTX_new();
-
-    // setup
-    int t = 50;
-    int n = 100;
-    dh_pvss_ctx pp;
-    dh_pvss_setup(&pp, group, t, n, ctx);
-    EC_POINT *secret = point_random(group, ctx);
+// valid indices of a reconstruction (or an aggregate) are t+1 distinct indices of the committee that reshared, 1..n
+static int aggregate_indices_valid(const dh_pvss_ctx *pp, int num_valid_indices, const int *valid_indices) {
+    if (num_valid_indices != pp->t + 1) {
+        return 0;
+    }
+    for (int i=0; i<num_valid_indices; i++) {
+        if (valid_indices[i] < 1 || valid_indices[i] > pp->n) {
+            return 0;
+        }
+        for (int k=0; k<i; k++) {
+            if (valid_indices[k] == valid_indices[i]) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
 
-    // keygen
-    dh_key_pair first_dist_kp;
-    dh_key_pair_generate(group, &first_dist_kp, ctx);
-    dh_key_pair committee_key_pairs[n];
-    EC_POINT *committee_public_keys[n];
-    for (int i=0; i<n; i++) {
-        dh_key_pair *com_member_key_pair = &committee_key_pairs[i];
-        dh_key_pair_generate(group, com_member_key_pair, ctx);
-        committee_public_keys[i] = com_member_key_pair->pub;
+// reconstruct all slices [from, to) of a reshare
+typedef struct {
+    const dh_pvss_ctx *pp;
+    const int *valid_indices;
+    const EC_POINT ***enc_re_shares;
+    const BIGNUM **lambdas; // Lagrange weights of the valid parties
+    EC_POINT **reconstructed_shares;
+} reshare_reconstruct_job;
+
+static void reshare_reconstruct_chunk(int chunk, int from, int to, BN_CTX *ctx, void *arg) {
+    (void)chunk;
+    reshare_reconstruct_job *job = arg;
+    const int num_terms = job->pp->t + 1;
+    const EC_POINT *slice[num_terms];
+    for (int j=from; j<to; j++) {
+        for (int i=0; i<num_terms; i++) { // j:th re-share of every valid party
+            slice[i] = job->enc_re_shares[job->valid_indices[i] - 1][j];
+        }
+        job->reconstructed_shares[j] = point_new(job->pp->group);
+        point_weighted_sum(job->pp->group, job->reconstructed_shares[j], num_terms, job->lambdas, slice, ctx);
+    }
+}
+
+/* reconstruct all next_n encrypted shares of the next committee at once, from the reshare matrix enc_re_shares,
+ * where enc_re_shares[i] holds the next_n encrypted re-shares of party i+1 (only the rows of valid parties are read)
+ * the Lagrange weights of the valid parties are computed once, and the slices are weighted sums that share them,
+ * computed using pp->num_threads threads
+ * returns 0 on success, and 1 if reconstruction is not possible, i.e., the indices are not t+1 distinct indices in 1..n
+ * (in which case nothing is allocated) */
+int dh_pvss_reconstruct_reshares(const dh_pvss_ctx *pp, int num_valid_indices, const int *valid_indices, int next_n, const EC_POINT **enc_re_shares[], EC_POINT *reconstructed_shares[]) {
+    const EC_GROUP *group = pp->group;
+    const BIGNUM *order = get0_order(group);
+    BN_CTX *ctx = pp->bn_ctx;
+    const int t = pp->t;
+
+    if (!aggregate_indices_valid(pp, num_valid_indices, valid_indices)) {
+        return 1; // reconstruction not possible
+    }
+
+    // Lagrange weights
+    BIGNUM **lambdas = bn_new_array(t + 1);
+    for (int i=0; i<t+1; i++) {
+        lagX(group, lambdas[i], valid_indices, t+1, i, ctx);
+        BN_nnmod(lambdas[i], lambdas[i], order, ctx);
+    }
+
+    // reconstruct slices
+    reshare_reconstruct_job job;
+    job.pp = pp;
+    job.valid_indices = valid_indices;
+    job.enc_re_shares = enc_re_shares;
+    job.lambdas = (const BIGNUM **)lambdas;
+    job.reconstructed_shares = reconstructed_shares;
+    parallel_for(pp->num_threads, next_n, reshare_reconstruct_chunk, &job, ctx);
+
+    // cleanup
+    bn_free_array(t + 1, lambdas);
+
+    return 0;
+}
+
+/* aggregator role: one node calls dh_pvss_reconstruct_reshares and publishes only the next_n reconstructed shares
+ * and the valid indices, see dh_pvss_wire_encode_aggregate, instead of every member fetching the whole reshare matrix
+ * member j checks its own share against column j of the posted (and verified) reshare transcripts of the valid
+ * parties, i.e., t+1 re-shares, at the cost of one weighted sum of t+1 terms
+ * column[i] is re-share j of party valid_indices[i]
+ * returns 0 if reconstructed_share is correct, and 1 otherwise (or if the indices are not t+1 distinct indices in 1..n) */
+int dh_pvss_reshare_aggregate_verify_share(const dh_pvss_ctx *pp, int num_valid_indices, const int *valid_indices, const EC_POINT *column[], const EC_POINT *reconstructed_share) {
+    const EC_GROUP *group = pp->group;
+    const BIGNUM *order = get0_order(group);
+    BN_CTX *ctx = pp->bn_ctx;
+    const int t = pp->t;
+
+    if (!aggregate_indices_valid(pp, num_valid_indices, valid_indices)) {
+        return 1;
+    }
+
+    BIGNUM **lambdas = bn_new_array(t + 1);
+    for (int i=0; i<t+1; i++) {
+        lagX(group, lambdas[i], valid_indices, t+1, i, ctx);
+        BN_nnmod(lambdas[i], lambdas[i], order, ctx);
+    }
+    EC_POINT *expected = point_new(group);
+    point_weighted_sum(group, expected, t + 1, (const BIGNUM **)lambdas, column, ctx);
+    int ret = point_cmp(group, expected, reconstructed_share, ctx) != 0;
+
+    // cleanup
+    bn_free_array(t + 1, lambdas);
+    point_free(expected);
+
+    return ret;
+}
+
+/* audit of a whole aggregate against the reshare matrix (see dh_pvss_reconstruct_reshares for its layout)
+ * with random weights r_j the next_n reconstructions are checked at once, as
+ *   sum_j r_j reconstructed_shares[j] - sum_i sum_j lambda_i r_j enc_re_shares[i][j] = 0,
+ * which is a single weighted sum of (t+2)*next_n terms
+ * returns 0 if all reconstructed shares are correct, and 1 otherwise (or if the indices are not t+1 distinct indices in 1..n) */
+int dh_pvss_reshare_aggregate_verify(const dh_pvss_ctx *pp, int num_valid_indices, const int *valid_indices, int next_n, const EC_POINT **enc_re_shares[], const EC_POINT *reconstructed_shares[]) {
+    const EC_GROUP *group = pp->group;
+    const BIGNUM *order = get0_order(group);
+    BN_CTX *ctx = pp->bn_ctx;
+    const int t = pp->t;
+
+    if (!aggregate_indices_valid(pp, num_valid_indices, valid_indices)) {
+        return 1;
+    }
+
+    const int num_terms = (t + 2) * next_n;
+    BIGNUM **weights = malloc(num_terms * sizeof(BIGNUM *));
+    const EC_POINT **points = malloc(num_terms * sizeof(EC_POINT *));
+    assert(weights && points && "dh_pvss_reshare_aggregate_verify: allocation error");
+    BIGNUM *lambda = bn_new();
+    for (int j=0; j<next_n; j++) {
+        weights[j] = bn_random(order, ctx);
+        points[j] = reconstructed_shares[j];
+    }
+    for (int i=0; i<t+1; i++) {
+        lagX(group, lambda, valid_indices, t+1, i, ctx);
+        BN_nnmod(lambda, lambda, order, ctx);
+        BN_sub(lambda, order, lambda); // -lambda_i
+        for (int j=0; j<next_n; j++) {
+            const int k = (i + 1) * next_n + j;
+            weights[k] = bn_new();
+            BN_mod_mul(weights[k], lambda, weights[j], order, ctx);
+            points[k] = enc_re_shares[valid_indices[i] - 1][j];
+        }
+    }
+    EC_POINT *sum = point_new(group);
+    point_weighted_sum(group, sum, num_terms, (const BIGNUM **)weights, points, ctx);
+    int ret = !EC_POINT_is_at_infinity(group, sum);
+
+    // cleanup
+    for (int k=0; k<num_terms; k++) {
+        bn_free(weights[k]);
+    }
+    free(weights);
+    free(points);
+    bn_free(lambda);
+    point_free(sum);
+
+    return ret;
+}
+
+static int dh_pvss_test_1(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+
+    // setup
+    int t = 50;
+    int n = 100;
+    dh_pvss_ctx pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+    EC_POINT *secret = point_random(group, ctx);
+
+    // keygen
+    dh_key_pair first_dist_kp;
+    dh_key_pair_generate(group, &first_dist_kp, ctx);
+    dh_key_pair committee_key_pairs[n];
+    EC_POINT *committee_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair *com_member_key_pair = &committee_key_pairs[i];
+        dh_key_pair_generate(group, com_member_key_pair, ctx);
+        committee_public_keys[i] = com_member_key_pair->pub;
     }
 
     // make encrypted shares
@@ -729,7 +2135,7 @@ static int dh_pvss_test_4(int print) {
     int first = 2;
     for (int i=0; i<t+1; i++) {
         reconstruction_shares[i] = decrypted_shares[i + first];
-        int pp_alpha_as_int = (int)BN_get_word(pp.alphas[i + first + 1]); // this works since alphas were chosen small enough to fit in an int
+        int pp_alpha_as_int = pp.params->alphas[i + first + 1]; // alphas are stored as plain integers
         reconstruction_indices[i] = pp_alpha_as_int;
     }
     EC_POINT *reconstructed_secret = dh_pvss_reconstruct(group, (const EC_POINT**)reconstruction_shares, reconstruction_indices, pp.t, t+1, ctx);
@@ -813,7 +2219,7 @@ static int dh_pvss_test_4(int print) {
     EC_POINT *reshare_reconstruction_shares[next_pp.t+1];
     first = 0;
     for (int i=first; i<first+next_pp.t+1; i++) { // fill indexes and keys
-        int pp_alpha_as_int = (int)BN_get_word(pp.alphas[i+1]); // this works since alphas were chosen small enough to fit in an int
+        int pp_alpha_as_int = pp.params->alphas[i+1]; // alphas are stored as plain integers
         reshare_reconstruction_indices[i-first] = pp_alpha_as_int;
         reshare_reconstruction_keys[i-first] = next_committee_public_keys[i];
         reshare_dist_keys[i-first] = dist_public_keys[i];
@@ -882,13 +2288,1446 @@ static int dh_pvss_test_4(int print) {
     return !(ret1 == 0 && ret1b != 0 &&num_failed_decryptions == 0 && num_failed_verifications == 0 && ret3 == 0 && ret4 == 0 && ret5 != 0 && ret6 == 0);
 }
 
+static int dh_pvss_test_5(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+
+    // setup public parameters once, and contexts for three consecutive epochs sharing them
+    const int n = 20;
+    dh_pvss_params *params = dh_pvss_params_new(group, n, ctx);
+    dh_pvss_ctx epoch_pp[3];
+    dh_pvss_ctx_init(&epoch_pp[0], params, 8, ctx);
+    dh_pvss_params_free(params); // contexts hold the remaining references
+    dh_pvss_ctx_copy(&epoch_pp[1], &epoch_pp[0], 9);
+    dh_pvss_ctx_copy(&epoch_pp[2], &epoch_pp[1], 7);
+    int shared = epoch_pp[1].params == epoch_pp[0].params && epoch_pp[2].params == epoch_pp[0].params;
+    if (print) {
+        printf("%6s Test 5 - 1: DH PVSS epoch contexts %s public parameters\n", shared ? "OK" : "NOT OK", shared ? "share" : "DO NOT share");
+    }
+
+    // keygen
+    dh_key_pair dist_kp;
+    dh_key_pair_generate(group, &dist_kp, ctx);
+    dh_key_pair committee_key_pairs[n];
+    EC_POINT *committee_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &committee_key_pairs[i], ctx);
+        committee_public_keys[i] = committee_key_pairs[i].pub;
+    }
+
+    // free first epoch context, the remaining contexts must still be usable
+    dh_pvss_ctx_free(&epoch_pp[0]);
+    EC_POINT *secret = point_random(group, ctx);
+    int num_failed = 0;
+    for (int e=1; e<3; e++) {
+        EC_POINT *enc_shares[n];
+        nizk_dl_eq_proof pi;
+        dh_pvss_distribute_prove(&epoch_pp[e], enc_shares, &dist_kp, (const EC_POINT**)committee_public_keys, secret, &pi);
+        if (dh_pvss_distribute_verify(&epoch_pp[e], &pi, (const EC_POINT**)enc_shares, dist_kp.pub, (const EC_POINT**)committee_public_keys)) {
+            num_failed++;
+        }
+        for (int i=0; i<n; i++) {
+            point_free(enc_shares[i]);
+        }
+        nizk_dl_eq_proof_free(&pi);
+    }
+    if (print) {
+        printf("%6s Test 5 - 2: %d of 2 distributions with shared DH PVSS parameters accepted\n", num_failed ? "NOT OK" : "OK", 2 - num_failed);
+    }
+
+    // cleanup
+    dh_pvss_ctx_free(&epoch_pp[1]);
+    dh_pvss_ctx_free(&epoch_pp[2]);
+    point_free(secret);
+    dh_key_pair_free(&dist_kp);
+    for (int i=0; i<n; i++) {
+        dh_key_pair_free(&committee_key_pairs[i]);
+    }
+    BN_CTX_free(ctx);
+
+    return !(shared && num_failed == 0);
+}
+
+/* deterministic random number generator for tests comparing outputs of different code paths
+ * (installed with RAND_set_rand_method, SHA-256 in counter mode over a seed) */
+static unsigned char test_rand_seed[SHA256_DIGEST_LENGTH];
+static uint64_t test_rand_counter;
+
+static void test_rand_reset(unsigned char seed) {
+    memset(test_rand_seed, seed, sizeof(test_rand_seed));
+    test_rand_counter = 0;
+}
+
+static int test_rand_bytes(unsigned char *buf, int num) {
+    while (num > 0) {
+        unsigned char block[SHA256_DIGEST_LENGTH];
+        SHA256_CTX sha_ctx;
+        openssl_hash_init(&sha_ctx);
+        openssl_hash_update(&sha_ctx, test_rand_seed, sizeof(test_rand_seed));
+        openssl_hash_update(&sha_ctx, &test_rand_counter, sizeof(test_rand_counter));
+        openssl_hash_final(block, &sha_ctx);
+        test_rand_counter++;
+        int len = num < SHA256_DIGEST_LENGTH ? num : SHA256_DIGEST_LENGTH;
+        memcpy(buf, block, len);
+        buf += len;
+        num -= len;
+    }
+    return 1;
+}
+
+static int test_rand_status(void) {
+    return 1;
+}
+
+static RAND_METHOD test_rand_method = {
+    NULL,             // seed
+    test_rand_bytes,  // bytes
+    NULL,             // cleanup
+    NULL,             // add
+    test_rand_bytes,  // pseudorand
+    test_rand_status  // status
+};
+
+static int dh_pvss_test_6(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+
+    // setup
+    const int t = 20;
+    const int n = 50;
+    dh_pvss_ctx pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+    dh_pvss_ctx parallel_pp;
+    dh_pvss_ctx_copy(&parallel_pp, &pp, t);
+    dh_pvss_ctx_set_num_threads(&parallel_pp, 4);
+    EC_POINT *secret = point_random(group, ctx);
+
+    // keygen
+    dh_key_pair dist_kp;
+    dh_key_pair_generate(group, &dist_kp, ctx);
+    dh_key_pair committee_key_pairs[n];
+    EC_POINT *committee_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &committee_key_pairs[i], ctx);
+        committee_public_keys[i] = committee_key_pairs[i].pub;
+    }
+
+    // serial and parallel distribution, using the same (fixed) randomness
+    const RAND_METHOD *default_rand_method = RAND_get_rand_method();
+    RAND_set_rand_method(&test_rand_method);
+    EC_POINT *serial_enc_shares[n];
+    nizk_dl_eq_proof serial_pi;
+    test_rand_reset(0x5a);
+    dh_pvss_distribute_prove(&pp, serial_enc_shares, &dist_kp, (const EC_POINT**)committee_public_keys, secret, &serial_pi);
+    EC_POINT *parallel_enc_shares[n];
+    nizk_dl_eq_proof parallel_pi;
+    test_rand_reset(0x5a);
+    dh_pvss_distribute_prove(&parallel_pp, parallel_enc_shares, &dist_kp, (const EC_POINT**)committee_public_keys, secret, &parallel_pi);
+    RAND_set_rand_method(default_rand_method);
+
+    int ret1 = dh_pvss_distribute_verify(&pp, &parallel_pi, (const EC_POINT**)parallel_enc_shares, dist_kp.pub, (const EC_POINT**)committee_public_keys);
+    if (print) {
+        printf("%6s Test 6 - 1: Parallel DH PVSS Distribution Proof %s accepted\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT" : "indeed");
+    }
+
+    int num_differences = BN_cmp(serial_pi.z, parallel_pi.z) != 0;
+    num_differences += point_cmp(group, serial_pi.Ra, parallel_pi.Ra, ctx);
+    num_differences += point_cmp(group, serial_pi.Rb, parallel_pi.Rb, ctx);
+    for (int i=0; i<n; i++) {
+        num_differences += point_cmp(group, serial_enc_shares[i], parallel_enc_shares[i], ctx);
+    }
+    if (print) {
+        printf("%6s Test 6 - 2: Parallel DH PVSS Distribution %s identical to serial\n", num_differences ? "NOT OK" : "OK", num_differences ? "NOT" : "is");
+    }
+
+    // parallel verification, positive and negative
+    int ret3 = dh_pvss_distribute_verify(&parallel_pp, &serial_pi, (const EC_POINT**)serial_enc_shares, dist_kp.pub, (const EC_POINT**)committee_public_keys);
+    if (print) {
+        printf("%6s Test 6 - 3: DH PVSS Distribution Proof %s accepted by parallel verification\n", ret3 ? "NOT OK" : "OK", ret3 ? "NOT" : "indeed");
+    }
+    int ret4 = dh_pvss_distribute_verify(&parallel_pp, &serial_pi, (const EC_POINT**)serial_enc_shares, committee_public_keys[0], (const EC_POINT**)committee_public_keys);
+    if (print) {
+        if (ret4) {
+            printf("    OK Test 6 - 4: Incorrect DH PVSS Distribution Proof not accepted by parallel verification (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 6 - 4: Incorrect DH PVSS Distribution Proof IS accepted by parallel verification (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    for (int i=0; i<n; i++) {
+        point_free(serial_enc_shares[i]);
+        point_free(parallel_enc_shares[i]);
+        dh_key_pair_free(&committee_key_pairs[i]);
+    }
+    nizk_dl_eq_proof_free(&serial_pi);
+    nizk_dl_eq_proof_free(&parallel_pi);
+    dh_key_pair_free(&dist_kp);
+    point_free(secret);
+    dh_pvss_ctx_free(&parallel_pp);
+    dh_pvss_ctx_free(&pp);
+    BN_CTX_free(ctx);
+
+    return !(ret1 == 0 && num_differences == 0 && ret3 == 0 && ret4 != 0);
+}
+
+typedef struct {
+    const EC_GROUP *group;
+    EC_POINT **enc_shares; // collected copies
+    int num_calls;
+    int abort_after; // abort after this many calls, 0 for never
+} test_share_sink;
+
+static int test_share_sink_collect(void *arg, int first_index, int num_shares, const EC_POINT *enc_shares[]) {
+    test_share_sink *sink = (test_share_sink *)arg;
+    for (int i=0; i<num_shares; i++) {
+        EC_POINT *copy = point_new(sink->group);
+        EC_POINT_copy(copy, enc_shares[i]);
+        sink->enc_shares[first_index + i] = copy;
+    }
+    sink->num_calls++;
+    return sink->abort_after && sink->num_calls >= sink->abort_after;
+}
+
+static int dh_pvss_test_7(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+
+    // setup
+    const int t = 10;
+    const int n = 30;
+    const int chunk_size = 7; // does not divide n
+    dh_pvss_ctx pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+    dh_pvss_ctx_set_num_threads(&pp, 2);
+    EC_POINT *secret = point_random(group, ctx);
+
+    // keygen
+    dh_key_pair dist_kp;
+    dh_key_pair_generate(group, &dist_kp, ctx);
+    dh_key_pair committee_key_pairs[n];
+    EC_POINT *committee_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &committee_key_pairs[i], ctx);
+        committee_public_keys[i] = committee_key_pairs[i].pub;
+    }
+
+    // regular and streaming distribution, using the same (fixed) randomness
+    const RAND_METHOD *default_rand_method = RAND_get_rand_method();
+    RAND_set_rand_method(&test_rand_method);
+    EC_POINT *enc_shares[n];
+    nizk_dl_eq_proof pi;
+    test_rand_reset(0xa5);
+    dh_pvss_distribute_prove(&pp, enc_shares, &dist_kp, (const EC_POINT**)committee_public_keys, secret, &pi);
+    EC_POINT *streamed_enc_shares[n];
+    test_share_sink sink = { group, streamed_enc_shares, 0, 0 };
+    nizk_dl_eq_proof streamed_pi;
+    test_rand_reset(0xa5);
+    int ret1 = dh_pvss_distribute_prove_streaming(&pp, chunk_size, test_share_sink_collect, &sink, &dist_kp, (const EC_POINT**)committee_public_keys, secret, &streamed_pi);
+    RAND_set_rand_method(default_rand_method);
+
+    int ret2 = dh_pvss_distribute_verify(&pp, &streamed_pi, (const EC_POINT**)streamed_enc_shares, dist_kp.pub, (const EC_POINT**)committee_public_keys);
+    if (print) {
+        printf("%6s Test 7 - 1: Streamed DH PVSS Distribution Proof %s accepted\n", ret1 || ret2 ? "NOT OK" : "OK", ret1 || ret2 ? "NOT" : "indeed");
+    }
+
+    int num_differences = sink.num_calls != (n + chunk_size - 1) / chunk_size;
+    num_differences += BN_cmp(pi.z, streamed_pi.z) != 0;
+    num_differences += point_cmp(group, pi.Ra, streamed_pi.Ra, ctx);
+    num_differences += point_cmp(group, pi.Rb, streamed_pi.Rb, ctx);
+    for (int i=0; i<n; i++) {
+        num_differences += point_cmp(group, enc_shares[i], streamed_enc_shares[i], ctx);
+    }
+    if (print) {
+        printf("%6s Test 7 - 2: Streamed DH PVSS Distribution %s identical to regular\n", num_differences ? "NOT OK" : "OK", num_differences ? "NOT" : "is");
+    }
+
+    // sink aborts after the second chunk
+    EC_POINT *aborted_enc_shares[n];
+    test_share_sink aborting_sink = { group, aborted_enc_shares, 0, 2 };
+    nizk_dl_eq_proof aborted_pi;
+    int ret3 = dh_pvss_distribute_prove_streaming(&pp, chunk_size, test_share_sink_collect, &aborting_sink, &dist_kp, (const EC_POINT**)committee_public_keys, secret, &aborted_pi);
+    int aborted_ok = ret3 != 0 && aborting_sink.num_calls == 2;
+    if (print) {
+        printf("%6s Test 7 - 3: Streamed DH PVSS Distribution %s aborted by sink\n", aborted_ok ? "OK" : "NOT OK", aborted_ok ? "is" : "NOT");
+    }
+
+    // cleanup
+    for (int i=0; i<2*chunk_size; i++) {
+        point_free(aborted_enc_shares[i]);
+    }
+    for (int i=0; i<n; i++) {
+        point_free(enc_shares[i]);
+        point_free(streamed_enc_shares[i]);
+        dh_key_pair_free(&committee_key_pairs[i]);
+    }
+    nizk_dl_eq_proof_free(&pi);
+    nizk_dl_eq_proof_free(&streamed_pi);
+    dh_key_pair_free(&dist_kp);
+    point_free(secret);
+    dh_pvss_ctx_free(&pp);
+    BN_CTX_free(ctx);
+
+    return !(ret1 == 0 && ret2 == 0 && num_differences == 0 && aborted_ok);
+}
+
+static int dh_pvss_test_8(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+
+    // setup
+    const int t = 5;
+    const int n = 15;
+    const int num_dists = 4;
+    const int bad_dist = 2;
+    dh_pvss_ctx pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+
+    // committee keygen
+    dh_key_pair committee_key_pairs[n];
+    EC_POINT *committee_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &committee_key_pairs[i], ctx);
+        committee_public_keys[i] = committee_key_pairs[i].pub;
+    }
+
+    // distributions of several dealers
+    dh_key_pair dist_kps[num_dists];
+    EC_POINT *dist_pubs[num_dists];
+    EC_POINT *secrets[num_dists];
+    EC_POINT *enc_shares[num_dists][n];
+    const EC_POINT **enc_share_lists[num_dists];
+    nizk_dl_eq_proof pis[num_dists];
+    nizk_dl_eq_proof *pi_list[num_dists];
+    for (int d=0; d<num_dists; d++) {
+        dh_key_pair_generate(group, &dist_kps[d], ctx);
+        dist_pubs[d] = dist_kps[d].pub;
+        secrets[d] = point_random(group, ctx);
+        dh_pvss_distribute_prove(&pp, enc_shares[d], &dist_kps[d], (const EC_POINT**)committee_public_keys, secrets[d], &pis[d]);
+        enc_share_lists[d] = (const EC_POINT **)enc_shares[d];
+        pi_list[d] = &pis[d];
+    }
+
+    int ret1 = dh_pvss_distribute_verify_batch(&pp, num_dists, pi_list, enc_share_lists, (const EC_POINT**)dist_pubs, (const EC_POINT**)committee_public_keys, NULL);
+    if (print) {
+        printf("%6s Test 8 - 1: Batch of DH PVSS Distribution Proofs %s accepted\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT" : "indeed");
+    }
+
+    // negative test, tamper with one encrypted share of one distribution
+    point_add(group, enc_shares[bad_dist][3], enc_shares[bad_dist][3], get0_generator(group), ctx);
+    int results[num_dists];
+    int ret2 = dh_pvss_distribute_verify_batch(&pp, num_dists, pi_list, enc_share_lists, (const EC_POINT**)dist_pubs, (const EC_POINT**)committee_public_keys, results);
+    int num_misplaced = 0;
+    for (int d=0; d<num_dists; d++) {
+        num_misplaced += results[d] != (d == bad_dist);
+    }
+    if (print) {
+        if (ret2 && num_misplaced == 0) {
+            printf("    OK Test 8 - 2: Batch with incorrect DH PVSS Distribution not accepted, and bad distribution located (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 8 - 2: Batch with incorrect DH PVSS Distribution IS accepted, or bad distribution not located (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    for (int d=0; d<num_dists; d++) {
+        for (int i=0; i<n; i++) {
+            point_free(enc_shares[d][i]);
+        }
+        nizk_dl_eq_proof_free(&pis[d]);
+        dh_key_pair_free(&dist_kps[d]);
+        point_free(secrets[d]);
+    }
+    for (int i=0; i<n; i++) {
+        dh_key_pair_free(&committee_key_pairs[i]);
+    }
+    dh_pvss_ctx_free(&pp);
+    BN_CTX_free(ctx);
+
+    return !(ret1 == 0 && ret2 != 0 && num_misplaced == 0);
+}
+
+static int dh_pvss_test_9(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+
+    // setup
+    const int t = 20;
+    const int n = 150; // more than one decoding batch per chunk
+    dh_pvss_ctx pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+    dh_pvss_ctx_set_num_threads(&pp, 2);
+    EC_POINT *secret = point_random(group, ctx);
+
+    // keygen
+    dh_key_pair dist_kp;
+    dh_key_pair_generate(group, &dist_kp, ctx);
+    dh_key_pair committee_key_pairs[n];
+    EC_POINT *committee_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &committee_key_pairs[i], ctx);
+        committee_public_keys[i] = committee_key_pairs[i].pub;
+    }
+
+    // distribute and encode
+    EC_POINT *enc_shares[n];
+    nizk_dl_eq_proof pi;
+    dh_pvss_distribute_prove(&pp, enc_shares, &dist_kp, (const EC_POINT**)committee_public_keys, secret, &pi);
+    size_t len = dh_pvss_wire_distribution_len(group, n);
+    unsigned char *transcript = malloc(len);
+    dh_pvss_wire_encode_distribution(group, transcript, n, dist_kp.pub, (const EC_POINT**)enc_shares, &pi, ctx);
+
+    int ret1 = dh_pvss_distribute_verify_encoded(&pp, transcript, len, (const EC_POINT**)committee_public_keys);
+    if (print) {
+        printf("%6s Test 9 - 1: Encoded DH PVSS Distribution %s accepted\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT" : "indeed");
+    }
+
+    // memory mapped from file
+    const char *tmp_dir = getenv("TMPDIR");
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/dh_pvss_test_XXXXXX", tmp_dir ? tmp_dir : "/tmp");
+    int fd = mkstemp(path);
+    int ret2 = fd < 0 || write(fd, transcript, len) != (ssize_t)len;
+    if (fd >= 0) {
+        close(fd);
+        ret2 |= dh_pvss_distribute_verify_file(&pp, path, (const EC_POINT**)committee_public_keys);
+        unlink(path);
+    }
+    if (print) {
+        printf("%6s Test 9 - 2: Memory mapped DH PVSS Distribution %s accepted\n", ret2 ? "NOT OK" : "OK", ret2 ? "NOT" : "indeed");
+    }
+
+    // negative tests, replace one encrypted share, and corrupt the encoding of another
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    unsigned char *encoded_shares = transcript + DH_PVSS_WIRE_HEADER_LEN + point_len;
+    memcpy(encoded_shares + 70 * point_len, encoded_shares + 71 * point_len, point_len);
+    int ret3 = dh_pvss_distribute_verify_encoded(&pp, transcript, len, (const EC_POINT**)committee_public_keys);
+    dh_pvss_wire_encode_distribution(group, transcript, n, dist_kp.pub, (const EC_POINT**)enc_shares, &pi, ctx);
+    encoded_shares[120 * point_len] = 0x05;
+    int ret4 = dh_pvss_distribute_verify_encoded(&pp, transcript, len, (const EC_POINT**)committee_public_keys);
+    if (print) {
+        if (ret3 && ret4) {
+            printf("    OK Test 9 - 3: Incorrect encoded DH PVSS Distributions not accepted (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 9 - 3: Incorrect encoded DH PVSS Distribution IS accepted (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    free(transcript);
+    for (int i=0; i<n; i++) {
+        point_free(enc_shares[i]);
+        dh_key_pair_free(&committee_key_pairs[i]);
+    }
+    nizk_dl_eq_proof_free(&pi);
+    dh_key_pair_free(&dist_kp);
+    point_free(secret);
+    dh_pvss_ctx_free(&pp);
+    BN_CTX_free(ctx);
+
+    return !(ret1 == 0 && ret2 == 0 && ret3 != 0 && ret4 != 0);
+}
+
+static int dh_pvss_test_10(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+
+    // setup
+    const int t = 5;
+    const int n = 15;
+    dh_pvss_ctx pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+    dh_pvss_cache *cache = dh_pvss_cache_new(4);
+    EC_POINT *secret = point_random(group, ctx);
+
+    // keygen and distribution
+    dh_key_pair dist_kp;
+    dh_key_pair_generate(group, &dist_kp, ctx);
+    dh_key_pair committee_key_pairs[n];
+    EC_POINT *committee_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &committee_key_pairs[i], ctx);
+        committee_public_keys[i] = committee_key_pairs[i].pub;
+    }
+    EC_POINT *enc_shares[n];
+    nizk_dl_eq_proof pi;
+    dh_pvss_distribute_prove(&pp, enc_shares, &dist_kp, (const EC_POINT**)committee_public_keys, secret, &pi);
+
+    // verify twice, the second time from the cache
+    int ret1 = dh_pvss_distribute_verify_cached(&pp, cache, &pi, (const EC_POINT**)enc_shares, dist_kp.pub, (const EC_POINT**)committee_public_keys);
+    int ret2 = dh_pvss_distribute_verify_cached(&pp, cache, &pi, (const EC_POINT**)enc_shares, dist_kp.pub, (const EC_POINT**)committee_public_keys);
+    unsigned char digest[DH_PVSS_CACHE_DIGEST_LEN];
+    int ret_digest = dh_pvss_distribute_digest(&pp, &pi, (const EC_POINT**)enc_shares, dist_kp.pub, (const EC_POINT**)committee_public_keys, digest);
+    int verdict = -1;
+    int found = dh_pvss_cache_lookup(cache, digest, &verdict);
+    int ok = ret1 == 0 && ret2 == 0 && ret_digest == 0 && found && verdict == 0 && dh_pvss_cache_size(cache) == 1;
+    if (print) {
+        printf("%6s Test 10 - 1: Cached DH PVSS Distribution verdict %s\n", ok ? "OK" : "NOT OK", ok ? "indeed stored" : "NOT stored");
+    }
+
+    // a proof with z wider than a scalar has no digest, and is verified without the cache
+    const BIGNUM *order = get0_order(group);
+    BIGNUM *z = bn_new();
+    BN_copy(z, pi.z);
+    BN_lshift(pi.z, order, 8);
+    BN_add(pi.z, pi.z, z); // same z modulo the order
+    int ret_wide_digest = dh_pvss_distribute_digest(&pp, &pi, (const EC_POINT**)enc_shares, dist_kp.pub, (const EC_POINT**)committee_public_keys, digest);
+    int ret_wide = dh_pvss_distribute_verify_cached(&pp, cache, &pi, (const EC_POINT**)enc_shares, dist_kp.pub, (const EC_POINT**)committee_public_keys);
+    int ret_wide_direct = dh_pvss_distribute_verify(&pp, &pi, (const EC_POINT**)enc_shares, dist_kp.pub, (const EC_POINT**)committee_public_keys);
+    int num_differences = ret_wide_digest != 1 || ret_wide != ret_wide_direct || dh_pvss_cache_size(cache) != 1;
+    BN_copy(pi.z, z);
+    bn_free(z);
+    if (print) {
+        printf("%6s Test 10 - 2: Proof without digest %s verified without the cache\n", num_differences ? "NOT OK" : "OK", num_differences ? "NOT" : "indeed");
+    }
+
+    // a tampered transcript is a different cache entry, and fails
+    point_add(group, enc_shares[0], enc_shares[0], get0_generator(group), ctx);
+    int ret3 = dh_pvss_distribute_verify_cached(&pp, cache, &pi, (const EC_POINT**)enc_shares, dist_kp.pub, (const EC_POINT**)committee_public_keys);
+    if (print) {
+        if (ret3 && dh_pvss_cache_size(cache) == 2) {
+            printf("    OK Test 10 - 3: Incorrect DH PVSS Distribution not accepted from cache (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 10 - 3: Incorrect DH PVSS Distribution IS accepted from cache (which is an ERROR)\n");
+        }
+    }
+    ret3 = ret3 && dh_pvss_cache_size(cache) == 2;
+
+    // cleanup
+    for (int i=0; i<n; i++) {
+        point_free(enc_shares[i]);
+        dh_key_pair_free(&committee_key_pairs[i]);
+    }
+    nizk_dl_eq_proof_free(&pi);
+    dh_key_pair_free(&dist_kp);
+    point_free(secret);
+    dh_pvss_cache_free(cache);
+    dh_pvss_ctx_free(&pp);
+    BN_CTX_free(ctx);
+
+    return !(ok && num_differences == 0 && ret3);
+}
+
+static int dh_pvss_test_11(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+
+    // setup
+    const int t = 5;
+    const int n = 15;
+    const int bad_share = 11;
+    dh_pvss_ctx pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+    EC_POINT *secret = point_random(group, ctx);
+
+    // keygen and distribution
+    dh_key_pair dist_kp;
+    dh_key_pair_generate(group, &dist_kp, ctx);
+    dh_key_pair committee_key_pairs[n];
+    EC_POINT *committee_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &committee_key_pairs[i], ctx);
+        committee_public_keys[i] = committee_key_pairs[i].pub;
+    }
+    EC_POINT *enc_shares[n];
+    nizk_dl_eq_proof pi;
+    dh_pvss_distribute_prove(&pp, enc_shares, &dist_kp, (const EC_POINT**)committee_public_keys, secret, &pi);
+
+    // all members decrypt
+    EC_POINT *dec_shares[n];
+    nizk_dl_eq_proof dec_pis[n];
+    nizk_dl_eq_proof *dec_pi_list[n];
+    for (int i=0; i<n; i++) {
+        dec_shares[i] = dh_pvss_decrypt_share_prove(group, dist_kp.pub, &committee_key_pairs[i], enc_shares[i], &dec_pis[i], ctx);
+        dec_pi_list[i] = &dec_pis[i];
+    }
+    int ret1 = dh_pvss_decrypt_share_verify_batch(group, dist_kp.pub, n, (const EC_POINT**)committee_public_keys, (const EC_POINT**)enc_shares, (const EC_POINT**)dec_shares, dec_pi_list, NULL, ctx);
+    if (print) {
+        printf("%6s Test 11 - 1: Batch of DH PVSS Decryption Proofs %s accepted\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT" : "indeed");
+    }
+
+    // negative test, one bad decrypted share
+    point_add(group, dec_shares[bad_share], dec_shares[bad_share], get0_generator(group), ctx);
+    int results[n];
+    int ret2 = dh_pvss_decrypt_share_verify_batch(group, dist_kp.pub, n, (const EC_POINT**)committee_public_keys, (const EC_POINT**)enc_shares, (const EC_POINT**)dec_shares, dec_pi_list, results, ctx);
+    int num_misplaced = 0;
+    for (int i=0; i<n; i++) {
+        num_misplaced += results[i] != (i == bad_share);
+    }
+    if (print) {
+        if (ret2 && num_misplaced == 0) {
+            printf("    OK Test 11 - 2: Batch with incorrect DH PVSS Decryption not accepted, and bad share located (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 11 - 2: Batch with incorrect DH PVSS Decryption IS accepted, or bad share not located (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    for (int i=0; i<n; i++) {
+        point_free(enc_shares[i]);
+        point_free(dec_shares[i]);
+        nizk_dl_eq_proof_free(&dec_pis[i]);
+        dh_key_pair_free(&committee_key_pairs[i]);
+    }
+    nizk_dl_eq_proof_free(&pi);
+    dh_key_pair_free(&dist_kp);
+    point_free(secret);
+    dh_pvss_ctx_free(&pp);
+    BN_CTX_free(ctx);
+
+    return !(ret1 == 0 && ret2 != 0 && num_misplaced == 0);
+}
+
+static int dh_pvss_test_12(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+
+    // setup
+    const int t = 2;
+    const int n = 5;
+    const int k = 4; // number of dealers
+    const int member = 3;
+    dh_pvss_ctx pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+
+    // committee keys
+    dh_key_pair committee_key_pairs[n];
+    EC_POINT *committee_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &committee_key_pairs[i], ctx);
+        committee_public_keys[i] = committee_key_pairs[i].pub;
+    }
+
+    // k dealers distribute
+    dh_key_pair dist_kps[k];
+    EC_POINT *dist_key_pubs[k];
+    EC_POINT *secrets[k];
+    EC_POINT *enc_shares[k][n];
+    EC_POINT *member_enc_shares[k];
+    for (int j=0; j<k; j++) {
+        dh_key_pair_generate(group, &dist_kps[j], ctx);
+        dist_key_pubs[j] = dist_kps[j].pub;
+        secrets[j] = point_random(group, ctx);
+        nizk_dl_eq_proof pi;
+        dh_pvss_distribute_prove(&pp, enc_shares[j], &dist_kps[j], (const EC_POINT**)committee_public_keys, secrets[j], &pi);
+        nizk_dl_eq_proof_free(&pi);
+        member_enc_shares[j] = enc_shares[j][member];
+    }
+
+    // one member decrypts its share of every distribution with one proof
+    EC_POINT *dec_shares[k];
+    nizk_dl_eq_proof pi;
+    dh_pvss_decrypt_shares_prove(group, k, (const EC_POINT**)dist_key_pubs, &committee_key_pairs[member], (const EC_POINT**)member_enc_shares, dec_shares, &pi, ctx);
+    int ret1 = dh_pvss_decrypt_shares_verify(group, k, (const EC_POINT**)dist_key_pubs, committee_public_keys[member], (const EC_POINT**)member_enc_shares, (const EC_POINT**)dec_shares, &pi, ctx);
+
+    // the decrypted shares agree with single decryptions
+    int num_differences = 0;
+    for (int j=0; j<k; j++) {
+        nizk_dl_eq_proof single_pi;
+        EC_POINT *single = dh_pvss_decrypt_share_prove(group, dist_key_pubs[j], &committee_key_pairs[member], member_enc_shares[j], &single_pi, ctx);
+        num_differences += point_cmp(group, single, dec_shares[j], ctx) != 0;
+        point_free(single);
+        nizk_dl_eq_proof_free(&single_pi);
+    }
+    ret1 |= num_differences != 0;
+    if (print) {
+        printf("%6s Test 12 - 1: Aggregated DH PVSS Decryption Proof over %d dealers %s accepted\n", ret1 ? "NOT OK" : "OK", k, ret1 ? "NOT" : "indeed");
+    }
+
+    // negative test, one bad decrypted share
+    point_add(group, dec_shares[1], dec_shares[1], get0_generator(group), ctx);
+    int ret2 = dh_pvss_decrypt_shares_verify(group, k, (const EC_POINT**)dist_key_pubs, committee_public_keys[member], (const EC_POINT**)member_enc_shares, (const EC_POINT**)dec_shares, &pi, ctx);
+    if (print) {
+        if (ret2) {
+            printf("    OK Test 12 - 2: Aggregated proof with one incorrect DH PVSS Decryption not accepted (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 12 - 2: Aggregated proof with one incorrect DH PVSS Decryption IS accepted (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    nizk_dl_eq_proof_free(&pi);
+    for (int j=0; j<k; j++) {
+        point_free(dec_shares[j]);
+        for (int i=0; i<n; i++) {
+            point_free(enc_shares[j][i]);
+        }
+        point_free(secrets[j]);
+        dh_key_pair_free(&dist_kps[j]);
+    }
+    for (int i=0; i<n; i++) {
+        dh_key_pair_free(&committee_key_pairs[i]);
+    }
+    dh_pvss_ctx_free(&pp);
+    BN_CTX_free(ctx);
+
+    return !(ret1 == 0 && ret2 != 0);
+}
+
+// a distribution to a committee of n, and key pairs for a next committee of next_n, as input to reshare tests
+typedef struct {
+    BN_CTX *ctx;
+    dh_pvss_ctx pp;
+    dh_pvss_ctx next_pp;
+    EC_POINT *secret;
+    dh_key_pair first_dist_kp;
+    dh_key_pair *committee_key_pairs;
+    dh_key_pair *dist_key_pairs;
+    dh_key_pair *next_committee_key_pairs;
+    EC_POINT **committee_public_keys;
+    EC_POINT **dist_public_keys;
+    EC_POINT **next_committee_public_keys;
+    EC_POINT **encrypted_shares;
+} test_reshare_setup;
+
+static void test_reshare_setup_new(test_reshare_setup *ts, int t, int n, int next_t, int next_n) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+    ts->ctx = ctx;
+    dh_pvss_setup(&ts->pp, group, t, n, ctx);
+    dh_pvss_setup(&ts->next_pp, group, next_t, next_n, ctx);
+    ts->secret = point_random(group, ctx);
+    dh_key_pair_generate(group, &ts->first_dist_kp, ctx);
+
+    // keygen
+    ts->committee_key_pairs = malloc(n * sizeof(dh_key_pair));
+    ts->dist_key_pairs = malloc(n * sizeof(dh_key_pair));
+    ts->next_committee_key_pairs = malloc(next_n * sizeof(dh_key_pair));
+    ts->committee_public_keys = malloc(n * sizeof(EC_POINT *));
+    ts->dist_public_keys = malloc(n * sizeof(EC_POINT *));
+    ts->next_committee_public_keys = malloc(next_n * sizeof(EC_POINT *));
+    ts->encrypted_shares = malloc(n * sizeof(EC_POINT *));
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &ts->committee_key_pairs[i], ctx);
+        dh_key_pair_generate(group, &ts->dist_key_pairs[i], ctx);
+        ts->committee_public_keys[i] = ts->committee_key_pairs[i].pub;
+        ts->dist_public_keys[i] = ts->dist_key_pairs[i].pub;
+    }
+    for (int i=0; i<next_n; i++) {
+        dh_key_pair_generate(group, &ts->next_committee_key_pairs[i], ctx);
+        ts->next_committee_public_keys[i] = ts->next_committee_key_pairs[i].pub;
+    }
+
+    // distribute
+    nizk_dl_eq_proof pi;
+    dh_pvss_distribute_prove(&ts->pp, ts->encrypted_shares, &ts->first_dist_kp, (const EC_POINT**)ts->committee_public_keys, ts->secret, &pi);
+    nizk_dl_eq_proof_free(&pi);
+}
+
+static void test_reshare_setup_free(test_reshare_setup *ts) {
+    for (int i=0; i<ts->pp.n; i++) {
+        point_free(ts->encrypted_shares[i]);
+        dh_key_pair_free(&ts->committee_key_pairs[i]);
+        dh_key_pair_free(&ts->dist_key_pairs[i]);
+    }
+    for (int i=0; i<ts->next_pp.n; i++) {
+        dh_key_pair_free(&ts->next_committee_key_pairs[i]);
+    }
+    free(ts->committee_key_pairs);
+    free(ts->dist_key_pairs);
+    free(ts->next_committee_key_pairs);
+    free(ts->committee_public_keys);
+    free(ts->dist_public_keys);
+    free(ts->next_committee_public_keys);
+    free(ts->encrypted_shares);
+    dh_key_pair_free(&ts->first_dist_kp);
+    point_free(ts->secret);
+    dh_pvss_ctx_free(&ts->next_pp);
+    dh_pvss_ctx_free(&ts->pp);
+    BN_CTX_free(ts->ctx);
+}
+
+static int dh_pvss_test_13(int print) {
+    test_reshare_setup ts;
+    test_reshare_setup_new(&ts, 3, 8, 4, 10);
+    const EC_GROUP *group = ts.pp.group;
+    BN_CTX *ctx = ts.ctx;
+    const int n = ts.pp.n;
+    const int next_n = ts.next_pp.n;
+
+    // all parties reshare and are verified within one epoch context
+    dh_pvss_reshare_epoch_ctx epoch;
+    dh_pvss_reshare_epoch_ctx_init(&epoch, group, ts.first_dist_kp.pub, (const EC_POINT**)ts.encrypted_shares, n, &ts.next_pp, (const EC_POINT**)ts.next_committee_public_keys, ctx);
+    EC_POINT *enc_re_shares[n][next_n];
+    nizk_reshare_proof reshare_pis[n];
+    int num_failed = 0;
+    for (int i=0; i<n; i++) {
+        dh_pvss_reshare_prove_epoch(&epoch, i, &ts.committee_key_pairs[i], &ts.dist_key_pairs[i], enc_re_shares[i], &reshare_pis[i], ctx);
+    }
+    for (int i=0; i<n; i++) {
+        num_failed += dh_pvss_reshare_verify_epoch(&epoch, i, ts.committee_public_keys[i], ts.dist_public_keys[i], (const EC_POINT**)enc_re_shares[i], &reshare_pis[i], ctx) != 0;
+    }
+    // and by the stand-alone verifier
+    num_failed += dh_pvss_reshare_verify(&ts.pp, &ts.next_pp, 2, ts.committee_public_keys[2], ts.dist_public_keys[2], ts.first_dist_kp.pub, (const EC_POINT**)ts.encrypted_shares, (const EC_POINT**)ts.next_committee_public_keys, enc_re_shares[2], &reshare_pis[2]) != 0;
+    if (print) {
+        printf("%6s Test 13 - 1: %d DH PVSS Reshare Proofs of one epoch context %s accepted\n", num_failed ? "NOT OK" : "OK", n, num_failed ? "NOT all" : "indeed");
+    }
+
+    // negative test, a re-share that does not match the proof
+    point_add(group, enc_re_shares[5][1], enc_re_shares[5][1], get0_generator(group), ctx);
+    int ret2 = dh_pvss_reshare_verify_epoch(&epoch, 5, ts.committee_public_keys[5], ts.dist_public_keys[5], (const EC_POINT**)enc_re_shares[5], &reshare_pis[5], ctx);
+    if (print) {
+        if (ret2) {
+            printf("    OK Test 13 - 2: Incorrect DH PVSS Reshare in epoch context not accepted (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 13 - 2: Incorrect DH PVSS Reshare in epoch context IS accepted (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    for (int i=0; i<n; i++) {
+        for (int j=0; j<next_n; j++) {
+            point_free(enc_re_shares[i][j]);
+        }
+        nizk_reshare_proof_free(&reshare_pis[i]);
+    }
+    dh_pvss_reshare_epoch_ctx_free(&epoch);
+    test_reshare_setup_free(&ts);
+
+    return !(num_failed == 0 && ret2 != 0);
+}
+
+static int dh_pvss_test_14(int print) {
+    const int n = 9;
+    const int next_n = 7;
+    test_reshare_setup ts;
+    test_reshare_setup_new(&ts, 4, n, 3, next_n);
+    const EC_GROUP *group = ts.pp.group;
+    BN_CTX *ctx = ts.ctx;
+    const int bad_party = 6;
+
+    // all parties reshare
+    dh_pvss_reshare_epoch_ctx epoch;
+    dh_pvss_reshare_epoch_ctx_init(&epoch, group, ts.first_dist_kp.pub, (const EC_POINT**)ts.encrypted_shares, n, &ts.next_pp, (const EC_POINT**)ts.next_committee_public_keys, ctx);
+    EC_POINT *enc_re_shares[n][next_n];
+    const EC_POINT **enc_re_share_lists[n];
+    nizk_reshare_proof reshare_pis[n];
+    const nizk_reshare_proof *reshare_pi_list[n];
+    int party_indices[n];
+    for (int i=0; i<n; i++) {
+        dh_pvss_reshare_prove_epoch(&epoch, i, &ts.committee_key_pairs[i], &ts.dist_key_pairs[i], enc_re_shares[i], &reshare_pis[i], ctx);
+        enc_re_share_lists[i] = (const EC_POINT**)enc_re_shares[i];
+        reshare_pi_list[i] = &reshare_pis[i];
+        party_indices[i] = i;
+    }
+
+    // positive test
+    int ret1 = dh_pvss_reshare_verify_batch(&epoch, n, party_indices, (const EC_POINT**)ts.committee_public_keys, (const EC_POINT**)ts.dist_public_keys, enc_re_share_lists, reshare_pi_list, NULL, ctx);
+    if (print) {
+        printf("%6s Test 14 - 1: Batch of %d DH PVSS Reshare Proofs %s accepted\n", ret1 ? "NOT OK" : "OK", n, ret1 ? "NOT" : "indeed");
+    }
+
+    // negative test, one party with a bad re-share, which is located
+    point_add(group, enc_re_shares[bad_party][0], enc_re_shares[bad_party][0], get0_generator(group), ctx);
+    int results[n];
+    int ret2 = dh_pvss_reshare_verify_batch(&epoch, n, party_indices, (const EC_POINT**)ts.committee_public_keys, (const EC_POINT**)ts.dist_public_keys, enc_re_share_lists, reshare_pi_list, results, ctx);
+    int num_misplaced = 0;
+    for (int i=0; i<n; i++) {
+        num_misplaced += results[i] != (i == bad_party);
+    }
+    if (print) {
+        if (ret2 && num_misplaced == 0) {
+            printf("    OK Test 14 - 2: Batch with incorrect DH PVSS Reshare not accepted, and bad party located (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 14 - 2: Batch with incorrect DH PVSS Reshare IS accepted, or bad party not located (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    for (int i=0; i<n; i++) {
+        for (int j=0; j<next_n; j++) {
+            point_free(enc_re_shares[i][j]);
+        }
+        nizk_reshare_proof_free(&reshare_pis[i]);
+    }
+    dh_pvss_reshare_epoch_ctx_free(&epoch);
+    test_reshare_setup_free(&ts);
+
+    return !(ret1 == 0 && ret2 != 0 && num_misplaced == 0);
+}
+
+static int dh_pvss_test_15(int print) {
+    test_reshare_setup ts;
+    test_reshare_setup_new(&ts, 4, 10, 4, 10);
+    const EC_GROUP *group = ts.pp.group;
+    BN_CTX *ctx = ts.ctx;
+    const int t = ts.pp.t;
+    const int n = ts.pp.n;
+    const int next_n = ts.next_pp.n;
+    const int num_threads = 3;
+
+    // all parties reshare, arriving in reverse order, with the first arrival bad
+    dh_pvss_reshare_epoch_ctx epoch;
+    dh_pvss_reshare_epoch_ctx_init(&epoch, group, ts.first_dist_kp.pub, (const EC_POINT**)ts.encrypted_shares, n, &ts.next_pp, (const EC_POINT**)ts.next_committee_public_keys, ctx);
+    EC_POINT *enc_re_shares[n][next_n];
+    const EC_POINT **enc_re_share_lists[n];
+    nizk_reshare_proof reshare_pis[n];
+    const nizk_reshare_proof *reshare_pi_list[n];
+    const EC_POINT *com_pub_keys[n];
+    const EC_POINT *dist_pub_keys[n];
+    int party_indices[n];
+    for (int pos=0; pos<n; pos++) {
+        int i = n - 1 - pos;
+        dh_pvss_reshare_prove_epoch(&epoch, i, &ts.committee_key_pairs[i], &ts.dist_key_pairs[i], enc_re_shares[pos], &reshare_pis[pos], ctx);
+        enc_re_share_lists[pos] = (const EC_POINT**)enc_re_shares[pos];
+        reshare_pi_list[pos] = &reshare_pis[pos];
+        com_pub_keys[pos] = ts.committee_public_keys[i];
+        dist_pub_keys[pos] = ts.dist_public_keys[i];
+        party_indices[pos] = i;
+    }
+    point_add(group, enc_re_shares[0][0], enc_re_shares[0][0], get0_generator(group), ctx);
+
+    // a quorum is found without verifying every reshare
+    int valid_indices[t+1];
+    int num_verified;
+    int ret1 = dh_pvss_reshare_verify_quorum(&epoch, t, num_threads, n, party_indices, com_pub_keys, dist_pub_keys, enc_re_share_lists, reshare_pi_list, valid_indices, &num_verified, ctx);
+    int num_wrong = 0;
+    for (int i=0; i<t+1 && ret1 == 0; i++) {
+        num_wrong += valid_indices[i] == n; // the bad party
+        num_wrong += dh_pvss_reshare_verify_epoch(&epoch, valid_indices[i] - 1, ts.committee_public_keys[valid_indices[i] - 1], ts.dist_public_keys[valid_indices[i] - 1], enc_re_share_lists[n - valid_indices[i]], reshare_pi_list[n - valid_indices[i]], ctx) != 0;
+    }
+    ret1 |= num_wrong != 0 || num_verified >= n;
+    if (print) {
+        printf("%6s Test 15 - 1: Quorum of %d valid DH PVSS Reshares %s found after verifying %d of %d\n", ret1 ? "NOT OK" : "OK", t+1, ret1 ? "NOT" : "indeed", num_verified, n);
+    }
+
+    // no quorum among too few valid reshares
+    for (int pos=1; pos<n-t; pos++) {
+        point_add(group, enc_re_shares[pos][0], enc_re_shares[pos][0], get0_generator(group), ctx);
+    }
+    int ret2 = dh_pvss_reshare_verify_quorum(&epoch, t, num_threads, n, party_indices, com_pub_keys, dist_pub_keys, enc_re_share_lists, reshare_pi_list, valid_indices, &num_verified, ctx);
+    ret2 = ret2 == 0 || num_verified != n;
+    if (print) {
+        printf("%6s Test 15 - 2: Quorum among %d valid DH PVSS Reshares %s\n", ret2 ? "NOT OK" : "OK", t, ret2 ? "IS found (which is an ERROR)" : "not found (which is CORRECT)");
+    }
+
+    // cleanup
+    for (int i=0; i<n; i++) {
+        for (int j=0; j<next_n; j++) {
+            point_free(enc_re_shares[i][j]);
+        }
+        nizk_reshare_proof_free(&reshare_pis[i]);
+    }
+    dh_pvss_reshare_epoch_ctx_free(&epoch);
+    test_reshare_setup_free(&ts);
+
+    return ret1 || ret2;
+}
+
+// decrypt the first next_t+1 reconstructed shares with the next committee keys and check that the secret is recovered
+// (returns 0 if it is), where valid_indices are the parties whose reshares were reconstructed
+static int test_reshare_recovers_secret(test_reshare_setup *ts, EC_POINT **dist_public_keys, const EC_POINT *expected_secret, const int *valid_indices, EC_POINT *reconstructed_shares[]) {
+    const EC_GROUP *group = ts->pp.group;
+    BN_CTX *ctx = ts->ctx;
+    const int t = ts->pp.t;
+    const int next_t = ts->next_pp.t;
+
+    // the distribution key of the reshares
+    const EC_POINT *dist_keys[t+1];
+    int dist_key_indices[t+1];
+    for (int i=0; i<t+1; i++) {
+        dist_keys[i] = dist_public_keys[valid_indices[i] - 1];
+        dist_key_indices[i] = valid_indices[i];
+    }
+    EC_POINT *next_dist_key = dh_pvss_committee_dist_key_calc(group, dist_keys, dist_key_indices, t, t+1, ctx);
+
+    // decrypt and reconstruct
+    EC_POINT *decrypted_shares[next_t+1];
+    int share_indices[next_t+1];
+    for (int i=0; i<next_t+1; i++) {
+        nizk_dl_eq_proof pi;
+        decrypted_shares[i] = dh_pvss_decrypt_share_prove(group, next_dist_key, &ts->next_committee_key_pairs[i], reconstructed_shares[i], &pi, ctx);
+        nizk_dl_eq_proof_free(&pi);
+        share_indices[i] = i + 1;
+    }
+    EC_POINT *secret = dh_pvss_reconstruct(group, (const EC_POINT**)decrypted_shares, share_indices, next_t, next_t+1, ctx);
+    int ret = point_cmp(group, secret, expected_secret, ctx);
+
+    // cleanup
+    for (int i=0; i<next_t+1; i++) {
+        point_free(decrypted_shares[i]);
+    }
+    point_free(secret);
+    point_free(next_dist_key);
+
+    return ret;
+}
+
+static int dh_pvss_test_16(int print) {
+    test_reshare_setup ts;
+    test_reshare_setup_new(&ts, 3, 8, 4, 11);
+    dh_pvss_ctx_set_num_threads(&ts.pp, 3);
+    const EC_GROUP *group = ts.pp.group;
+    BN_CTX *ctx = ts.ctx;
+    const int t = ts.pp.t;
+    const int n = ts.pp.n;
+    const int next_n = ts.next_pp.n;
+
+    // all parties reshare
+    dh_pvss_reshare_epoch_ctx epoch;
+    dh_pvss_reshare_epoch_ctx_init(&epoch, group, ts.first_dist_kp.pub, (const EC_POINT**)ts.encrypted_shares, n, &ts.next_pp, (const EC_POINT**)ts.next_committee_public_keys, ctx);
+    EC_POINT *enc_re_shares[n][next_n];
+    const EC_POINT **enc_re_share_lists[n];
+    for (int i=0; i<n; i++) {
+        nizk_reshare_proof reshare_pi;
+        dh_pvss_reshare_prove_epoch(&epoch, i, &ts.committee_key_pairs[i], &ts.dist_key_pairs[i], enc_re_shares[i], &reshare_pi, ctx);
+        nizk_reshare_proof_free(&reshare_pi);
+        enc_re_share_lists[i] = (const EC_POINT**)enc_re_shares[i];
+    }
+
+    // reconstruct all slices at once, and slice by slice
+    int valid_indices[t+1];
+    for (int i=0; i<t+1; i++) {
+        valid_indices[i] = 2*i + 1; // every other party
+    }
+    EC_POINT *reconstructed_shares[next_n];
+    int ret1 = dh_pvss_reconstruct_reshares(&ts.pp, t+1, valid_indices, next_n, enc_re_share_lists, reconstructed_shares);
+    int num_differences = 0;
+    for (int j=0; j<next_n && ret1 == 0; j++) {
+        EC_POINT *slice[t+1];
+        for (int i=0; i<t+1; i++) {
+            slice[i] = enc_re_shares[valid_indices[i] - 1][j];
+        }
+        EC_POINT *reconstructed_share = dh_pvss_reconstruct_reshare(&ts.pp, t+1, valid_indices, slice);
+        num_differences += point_cmp(group, reconstructed_share, reconstructed_shares[j], ctx) != 0;
+        point_free(reconstructed_share);
+    }
+    ret1 |= num_differences != 0;
+    if (print) {
+        printf("%6s Test 16 - 1: Batched DH PVSS Reshare reconstruction %s slice by slice reconstruction\n", ret1 ? "NOT OK" : "OK", ret1 ? "DIFFERS FROM" : "equals");
+    }
+
+    // the next committee recovers the secret
+    int ret2 = ret1 || test_reshare_recovers_secret(&ts, ts.dist_public_keys, ts.secret, valid_indices, reconstructed_shares);
+    if (print) {
+        printf("%6s Test 16 - 2: %s reconstruction of secret from batched DH PVSS Reshare reconstruction\n", ret2 ? "NOT OK" : "OK", ret2 ? "INCORRECT" : "correct");
+    }
+
+    // a repeated index, and indices outside 1..n, are rejected
+    int bad_indices[t+1];
+    memcpy(bad_indices, valid_indices, sizeof(bad_indices));
+    bad_indices[1] = bad_indices[0];
+    EC_POINT *bad_shares[next_n];
+    int ret3 = dh_pvss_reconstruct_reshares(&ts.pp, t+1, bad_indices, next_n, enc_re_share_lists, bad_shares);
+    memcpy(bad_indices, valid_indices, sizeof(bad_indices));
+    bad_indices[t] = n + 1;
+    ret3 &= dh_pvss_reconstruct_reshares(&ts.pp, t+1, bad_indices, next_n, enc_re_share_lists, bad_shares);
+    bad_indices[t] = 0;
+    ret3 &= dh_pvss_reconstruct_reshares(&ts.pp, t+1, bad_indices, next_n, enc_re_share_lists, bad_shares);
+    if (print) {
+        if (ret3) {
+            printf("    OK Test 16 - 3: Batched DH PVSS Reshare reconstruction from bad indices not done (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 16 - 3: Batched DH PVSS Reshare reconstruction from bad indices IS done (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    for (int j=0; j<next_n && ret1 == 0; j++) {
+        point_free(reconstructed_shares[j]);
+    }
+    for (int i=0; i<n; i++) {
+        for (int j=0; j<next_n; j++) {
+            point_free(enc_re_shares[i][j]);
+        }
+    }
+    dh_pvss_reshare_epoch_ctx_free(&epoch);
+    test_reshare_setup_free(&ts);
+
+    return ret1 || ret2 || !ret3;
+}
+
+static int dh_pvss_test_17(int print) {
+    test_reshare_setup ts;
+    test_reshare_setup_new(&ts, 3, 8, 3, 9);
+    const EC_GROUP *group = ts.pp.group;
+    BN_CTX *ctx = ts.ctx;
+    const int t = ts.pp.t;
+    const int n = ts.pp.n;
+    const int next_n = ts.next_pp.n;
+    const int m = 3; // number of secrets
+    const int bad_party = 5;
+
+    // the first secret is the one of the setup, the others are distributed to the same committee
+    EC_POINT *secrets[m];
+    dh_key_pair first_dist_kps[m];
+    EC_POINT *previous_dist_keys[m];
+    EC_POINT **encrypted_shares[m];
+    dh_key_pair dist_kps[n][m]; // per party and secret
+    EC_POINT *dist_pub_keys[m][n]; // per secret and party
+    secrets[0] = ts.secret;
+    previous_dist_keys[0] = ts.first_dist_kp.pub;
+    encrypted_shares[0] = ts.encrypted_shares;
+    for (int k=1; k<m; k++) {
+        secrets[k] = point_random(group, ctx);
+        dh_key_pair_generate(group, &first_dist_kps[k], ctx);
+        previous_dist_keys[k] = first_dist_kps[k].pub;
+        encrypted_shares[k] = malloc(n * sizeof(EC_POINT *));
+        nizk_dl_eq_proof pi;
+        dh_pvss_distribute_prove(&ts.pp, encrypted_shares[k], &first_dist_kps[k], (const EC_POINT**)ts.committee_public_keys, secrets[k], &pi);
+        nizk_dl_eq_proof_free(&pi);
+    }
+    for (int i=0; i<n; i++) {
+        for (int k=0; k<m; k++) {
+            dh_key_pair_generate(group, &dist_kps[i][k], ctx);
+            dist_pub_keys[k][i] = dist_kps[i][k].pub;
+        }
+    }
+
+    // all parties reshare all secrets
+    dh_pvss_multi_reshare_ctx multi;
+    dh_pvss_multi_reshare_ctx_init(&multi, group, m, (const EC_POINT**)previous_dist_keys, (const EC_POINT***)encrypted_shares, n, &ts.next_pp, (const EC_POINT**)ts.next_committee_public_keys, ctx);
+    EC_POINT *enc_re_shares[m][n][next_n];
+    EC_POINT **party_enc_re_shares[n][m];
+    nizk_reshare_proof reshare_pis[n];
+    for (int i=0; i<n; i++) {
+        for (int k=0; k<m; k++) {
+            party_enc_re_shares[i][k] = enc_re_shares[k][i];
+        }
+        dh_pvss_multi_reshare_prove(&multi, i, &ts.committee_key_pairs[i], dist_kps[i], party_enc_re_shares[i], &reshare_pis[i], ctx);
+    }
+    int num_failed = 0;
+    for (int i=0; i<n; i++) {
+        const EC_POINT *party_dist_pub_keys[m];
+        for (int k=0; k<m; k++) {
+            party_dist_pub_keys[k] = dist_pub_keys[k][i];
+        }
+        num_failed += dh_pvss_multi_reshare_verify(&multi, i, ts.committee_public_keys[i], party_dist_pub_keys, (const EC_POINT***)party_enc_re_shares[i], &reshare_pis[i], ctx) != 0;
+    }
+
+    // the next committee recovers every secret
+    int valid_indices[t+1];
+    for (int i=0; i<t+1; i++) {
+        valid_indices[i] = n - i;
+    }
+    for (int k=0; k<m; k++) {
+        const EC_POINT **rows[n];
+        for (int i=0; i<n; i++) {
+            rows[i] = (const EC_POINT**)enc_re_shares[k][i];
+        }
+        EC_POINT *reconstructed_shares[next_n];
+        dh_pvss_reconstruct_reshares(&ts.pp, t+1, valid_indices, next_n, rows, reconstructed_shares);
+        num_failed += test_reshare_recovers_secret(&ts, dist_pub_keys[k], secrets[k], valid_indices, reconstructed_shares) != 0;
+        for (int j=0; j<next_n; j++) {
+            point_free(reconstructed_shares[j]);
+        }
+    }
+    if (print) {
+        printf("%6s Test 17 - 1: Multi-secret DH PVSS Reshares of %d secrets %s accepted, and secrets %s\n", num_failed ? "NOT OK" : "OK", m, num_failed ? "NOT" : "indeed", num_failed ? "NOT recovered" : "recovered");
+    }
+
+    // negative test, one bad re-share of one secret
+    const EC_POINT *party_dist_pub_keys[m];
+    for (int k=0; k<m; k++) {
+        party_dist_pub_keys[k] = dist_pub_keys[k][bad_party];
+    }
+    point_add(group, enc_re_shares[m-1][bad_party][2], enc_re_shares[m-1][bad_party][2], get0_generator(group), ctx);
+    int ret2 = dh_pvss_multi_reshare_verify(&multi, bad_party, ts.committee_public_keys[bad_party], party_dist_pub_keys, (const EC_POINT***)party_enc_re_shares[bad_party], &reshare_pis[bad_party], ctx);
+    if (print) {
+        if (ret2) {
+            printf("    OK Test 17 - 2: Multi-secret DH PVSS Reshare with one incorrect re-share not accepted (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 17 - 2: Multi-secret DH PVSS Reshare with one incorrect re-share IS accepted (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    for (int i=0; i<n; i++) {
+        for (int k=0; k<m; k++) {
+            for (int j=0; j<next_n; j++) {
+                point_free(enc_re_shares[k][i][j]);
+            }
+            dh_key_pair_free(&dist_kps[i][k]);
+        }
+        nizk_reshare_proof_free(&reshare_pis[i]);
+    }
+    dh_pvss_multi_reshare_ctx_free(&multi);
+    for (int k=1; k<m; k++) {
+        for (int i=0; i<n; i++) {
+            point_free(encrypted_shares[k][i]);
+        }
+        free(encrypted_shares[k]);
+        dh_key_pair_free(&first_dist_kps[k]);
+        point_free(secrets[k]);
+    }
+    test_reshare_setup_free(&ts);
+
+    return !(num_failed == 0 && ret2 != 0);
+}
+
+static int dh_pvss_test_18(int print) {
+    test_reshare_setup ts;
+    test_reshare_setup_new(&ts, 3, 9, 3, 9);
+    const EC_GROUP *group = ts.pp.group;
+    BN_CTX *ctx = ts.ctx;
+    const int t = ts.pp.t;
+    const int n = ts.pp.n;
+    const int num_parties = 3;
+    const int bad_party = 1;
+
+    // some parties refresh, one of them sharing something other than zero
+    dh_key_pair refresh_kps[num_parties];
+    EC_POINT *refresh_shares[num_parties][n];
+    nizk_dl_eq_proof refresh_pis[num_parties];
+    for (int j=0; j<num_parties; j++) {
+        dh_key_pair_generate(group, &refresh_kps[j], ctx);
+        dh_pvss_refresh_prove(&ts.pp, ts.first_dist_kp.pub, (const EC_POINT**)ts.committee_public_keys, &refresh_kps[j], refresh_shares[j], &refresh_pis[j]);
+    }
+    point_add(group, refresh_shares[bad_party][0], refresh_shares[bad_party][0], get0_generator(group), ctx);
+
+    // verify, and apply the valid refreshes
+    const EC_POINT *valid_pubs[num_parties];
+    const EC_POINT **valid_shares[num_parties];
+    int num_valid = 0;
+    int num_misjudged = 0;
+    for (int j=0; j<num_parties; j++) {
+        int ret = dh_pvss_refresh_verify(&ts.pp, ts.first_dist_kp.pub, (const EC_POINT**)ts.committee_public_keys, refresh_kps[j].pub, (const EC_POINT**)refresh_shares[j], &refresh_pis[j]);
+        num_misjudged += (ret != 0) != (j == bad_party);
+        if (ret == 0) {
+            valid_pubs[num_valid] = refresh_kps[j].pub;
+            valid_shares[num_valid++] = (const EC_POINT**)refresh_shares[j];
+        }
+    }
+    if (print) {
+        printf("%6s Test 18 - 1: Correct DH PVSS Refreshes %s accepted, and incorrect refresh %s\n", num_misjudged ? "NOT OK" : "OK", num_misjudged ? "NOT all" : "indeed", num_misjudged ? "maybe accepted" : "not accepted");
+    }
+    EC_POINT *old_enc_shares[n];
+    for (int i=0; i<n; i++) {
+        old_enc_shares[i] = point_new(group);
+        EC_POINT_copy(old_enc_shares[i], ts.encrypted_shares[i]);
+    }
+    EC_POINT *dist_key = point_new(group);
+    EC_POINT_copy(dist_key, ts.first_dist_kp.pub);
+    dh_pvss_refresh_apply(&ts.pp, num_valid, valid_pubs, valid_shares, dist_key, ts.encrypted_shares);
+
+    // the decrypted shares are new, and reconstruct the same secret
+    EC_POINT *decrypted_shares[t+1];
+    int share_indices[t+1];
+    int num_unchanged = 0;
+    for (int i=0; i<t+1; i++) {
+        nizk_dl_eq_proof pi;
+        decrypted_shares[i] = dh_pvss_decrypt_share_prove(group, dist_key, &ts.committee_key_pairs[i + 2], ts.encrypted_shares[i + 2], &pi, ctx);
+        nizk_dl_eq_proof_free(&pi);
+        EC_POINT *old_share = dh_pvss_decrypt_share_prove(group, ts.first_dist_kp.pub, &ts.committee_key_pairs[i + 2], old_enc_shares[i + 2], &pi, ctx);
+        nizk_dl_eq_proof_free(&pi);
+        num_unchanged += point_cmp(group, old_share, decrypted_shares[i], ctx) == 0;
+        point_free(old_share);
+        share_indices[i] = i + 3;
+    }
+    EC_POINT *secret = dh_pvss_reconstruct(group, (const EC_POINT**)decrypted_shares, share_indices, t, t+1, ctx);
+    int ret2 = num_unchanged != 0 || point_cmp(group, secret, ts.secret, ctx) != 0;
+    if (print) {
+        printf("%6s Test 18 - 2: %s reconstruction of secret from refreshed shares\n", ret2 ? "NOT OK" : "OK", ret2 ? "INCORRECT" : "correct");
+    }
+
+    // cleanup
+    for (int i=0; i<t+1; i++) {
+        point_free(decrypted_shares[i]);
+    }
+    point_free(secret);
+    point_free(dist_key);
+    for (int i=0; i<n; i++) {
+        point_free(old_enc_shares[i]);
+    }
+    for (int j=0; j<num_parties; j++) {
+        for (int i=0; i<n; i++) {
+            point_free(refresh_shares[j][i]);
+        }
+        nizk_dl_eq_proof_free(&refresh_pis[j]);
+        dh_key_pair_free(&refresh_kps[j]);
+    }
+    test_reshare_setup_free(&ts);
+
+    return num_misjudged != 0 || ret2;
+}
+
+static int dh_pvss_test_19(int print) {
+    test_reshare_setup ts;
+    test_reshare_setup_new(&ts, 3, 8, 4, 11);
+    const EC_GROUP *group = ts.pp.group;
+    BN_CTX *ctx = ts.ctx;
+    const int t = ts.pp.t;
+    const int n = ts.pp.n;
+    const int next_n = ts.next_pp.n;
+
+    // all parties reshare, and the aggregator reconstructs and publishes the slices
+    dh_pvss_reshare_epoch_ctx epoch;
+    dh_pvss_reshare_epoch_ctx_init(&epoch, group, ts.first_dist_kp.pub, (const EC_POINT**)ts.encrypted_shares, n, &ts.next_pp, (const EC_POINT**)ts.next_committee_public_keys, ctx);
+    EC_POINT *enc_re_shares[n][next_n];
+    const EC_POINT **enc_re_share_lists[n];
+    for (int i=0; i<n; i++) {
+        nizk_reshare_proof reshare_pi;
+        dh_pvss_reshare_prove_epoch(&epoch, i, &ts.committee_key_pairs[i], &ts.dist_key_pairs[i], enc_re_shares[i], &reshare_pi, ctx);
+        nizk_reshare_proof_free(&reshare_pi);
+        enc_re_share_lists[i] = (const EC_POINT**)enc_re_shares[i];
+    }
+    int valid_indices[t+1];
+    for (int i=0; i<t+1; i++) {
+        valid_indices[i] = n - i; // last parties
+    }
+    EC_POINT *reconstructed_shares[next_n];
+    dh_pvss_reconstruct_reshares(&ts.pp, t+1, valid_indices, next_n, enc_re_share_lists, reconstructed_shares);
+
+    // every member checks its own share, and an auditor checks them all
+    int num_rejected = 0;
+    for (int j=0; j<next_n; j++) {
+        const EC_POINT *column[t+1];
+        for (int i=0; i<t+1; i++) {
+            column[i] = enc_re_shares[valid_indices[i] - 1][j];
+        }
+        num_rejected += dh_pvss_reshare_aggregate_verify_share(&ts.pp, t+1, valid_indices, column, reconstructed_shares[j]);
+    }
+    int ret1 = num_rejected != 0 || dh_pvss_reshare_aggregate_verify(&ts.pp, t+1, valid_indices, next_n, enc_re_share_lists, (const EC_POINT**)reconstructed_shares);
+    if (print) {
+        printf("%6s Test 19 - 1: Correct DH PVSS Reshare aggregate %s accepted by members and auditor\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT" : "indeed");
+    }
+
+    // a wrong share is caught by its member and by the auditor
+    const int bad_member = 6;
+    point_add(group, reconstructed_shares[bad_member], reconstructed_shares[bad_member], get0_generator(group), ctx);
+    const EC_POINT *column[t+1];
+    for (int i=0; i<t+1; i++) {
+        column[i] = enc_re_shares[valid_indices[i] - 1][bad_member];
+    }
+    int ret2 = dh_pvss_reshare_aggregate_verify_share(&ts.pp, t+1, valid_indices, column, reconstructed_shares[bad_member]);
+    ret2 &= dh_pvss_reshare_aggregate_verify(&ts.pp, t+1, valid_indices, next_n, enc_re_share_lists, (const EC_POINT**)reconstructed_shares);
+    if (print) {
+        printf("%6s Test 19 - 2: Incorrect DH PVSS Reshare aggregate %s\n", ret2 ? "OK" : "NOT OK", ret2 ? "not accepted" : "ACCEPTED");
+    }
+
+    // the aggregate, with its indices in arrival order, goes over the wire and back, and is audited
+    point_sub(group, reconstructed_shares[bad_member], reconstructed_shares[bad_member], get0_generator(group), ctx);
+    size_t len = dh_pvss_wire_aggregate_len(group, t+1, next_n);
+    unsigned char *buf = malloc(len);
+    assert(buf && "dh_pvss_test_19: allocation error (buf)");
+    dh_pvss_wire_encode_aggregate(group, buf, t+1, valid_indices, next_n, (const EC_POINT**)reconstructed_shares, ctx);
+    int decoded_indices[t+1];
+    EC_POINT *decoded_shares[next_n];
+    int ret3 = dh_pvss_wire_decode_aggregate(group, buf, len, n, t+1, decoded_indices, next_n, decoded_shares, ctx);
+    if (ret3 == 0) {
+        ret3 = dh_pvss_reshare_aggregate_verify(&ts.pp, t+1, decoded_indices, next_n, enc_re_share_lists, (const EC_POINT**)decoded_shares);
+        for (int j=0; j<next_n; j++) {
+            point_free(decoded_shares[j]);
+        }
+    }
+    free(buf);
+    if (print) {
+        printf("%6s Test 19 - 3: Unordered DH PVSS Reshare aggregate %s decoded and accepted\n", ret3 ? "NOT OK" : "OK", ret3 ? "NOT" : "indeed");
+    }
+
+    // an index beyond the committee is rejected, rather than read out of bounds
+    valid_indices[0] = n + 1;
+    int ret4 = dh_pvss_reshare_aggregate_verify(&ts.pp, t+1, valid_indices, next_n, enc_re_share_lists, (const EC_POINT**)reconstructed_shares);
+    ret4 &= dh_pvss_reshare_aggregate_verify_share(&ts.pp, t+1, valid_indices, column, reconstructed_shares[bad_member]);
+    if (print) {
+        printf("%6s Test 19 - 4: DH PVSS Reshare aggregate with an index beyond the committee %s\n", ret4 ? "OK" : "NOT OK", ret4 ? "not accepted" : "ACCEPTED");
+    }
+
+    // cleanup
+    for (int j=0; j<next_n; j++) {
+        point_free(reconstructed_shares[j]);
+    }
+    for (int i=0; i<n; i++) {
+        for (int j=0; j<next_n; j++) {
+            point_free(enc_re_shares[i][j]);
+        }
+    }
+    dh_pvss_reshare_epoch_ctx_free(&epoch);
+    test_reshare_setup_free(&ts);
+
+    return ret1 || !ret2 || ret3 || !ret4;
+}
+
+static int dh_pvss_test_20(int print) {
+    test_reshare_setup ts;
+    test_reshare_setup_new(&ts, 3, 9, 3, 8);
+    const EC_GROUP *group = ts.pp.group;
+    BN_CTX *ctx = ts.ctx;
+    const int n = ts.pp.n;
+    const int next_n = ts.next_pp.n;
+
+    // register both committees, with proofs of possession
+    dh_pvss_key_registry *reg = dh_pvss_key_registry_new(group);
+    nizk_dl_proof key_pis[n + next_n];
+    const nizk_dl_proof *key_pi_list[n + next_n];
+    const EC_POINT *keys[n + next_n];
+    for (int i=0; i<n+next_n; i++) {
+        dh_key_pair *kp = i < n ? &ts.committee_key_pairs[i] : &ts.next_committee_key_pairs[i - n];
+        dh_key_pair_prove(group, kp, &key_pis[i], ctx);
+        key_pi_list[i] = &key_pis[i];
+        keys[i] = kp->pub;
+    }
+    int ids[n + next_n];
+    int ret1 = dh_pvss_key_registry_add(reg, n + next_n, keys, key_pi_list, ids, ctx);
+    dh_pvss_committee com, next_com;
+    ret1 |= dh_pvss_committee_init(&com, reg, n, ids);
+    ret1 |= dh_pvss_committee_init(&next_com, reg, next_n, ids + n);
+
+    // distribute to the registered committee, which verifies either way
+    EC_POINT *enc_shares[n];
+    nizk_dl_eq_proof pi;
+    dh_pvss_distribute_prove_committee(&ts.pp, enc_shares, &ts.first_dist_kp, &com, ts.secret, &pi);
+    ret1 |= dh_pvss_distribute_verify_committee(&ts.pp, &pi, (const EC_POINT**)enc_shares, ts.first_dist_kp.pub, &com);
+    ret1 |= dh_pvss_distribute_verify(&ts.pp, &pi, (const EC_POINT**)enc_shares, ts.first_dist_kp.pub, (const EC_POINT**)ts.committee_public_keys);
+    if (print) {
+        printf("%6s Test 20 - 1: Correct DH PVSS Distribution Proof to registered committee %s accepted\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT" : "indeed");
+    }
+
+    // reshare to the registered next committee
+    dh_pvss_reshare_epoch_ctx epoch;
+    dh_pvss_reshare_epoch_ctx_init(&epoch, group, ts.first_dist_kp.pub, (const EC_POINT**)enc_shares, n, &ts.next_pp, next_com.keys, ctx);
+    EC_POINT *enc_re_shares[next_n];
+    nizk_reshare_proof reshare_pi;
+    dh_pvss_reshare_prove_epoch(&epoch, 4, &ts.committee_key_pairs[4], &ts.dist_key_pairs[4], enc_re_shares, &reshare_pi, ctx);
+    int ret2 = dh_pvss_reshare_verify_epoch(&epoch, 4, com.keys[4], ts.dist_key_pairs[4].pub, (const EC_POINT**)enc_re_shares, &reshare_pi, ctx);
+    if (print) {
+        printf("%6s Test 20 - 2: Correct DH PVSS Reshare Proof to registered committee %s accepted\n", ret2 ? "NOT OK" : "OK", ret2 ? "NOT" : "indeed");
+    }
+
+    // cleanup
+    for (int j=0; j<next_n; j++) {
+        point_free(enc_re_shares[j]);
+    }
+    nizk_reshare_proof_free(&reshare_pi);
+    dh_pvss_reshare_epoch_ctx_free(&epoch);
+    for (int i=0; i<n; i++) {
+        point_free(enc_shares[i]);
+    }
+    nizk_dl_eq_proof_free(&pi);
+    dh_pvss_committee_free(&com);
+    dh_pvss_committee_free(&next_com);
+    dh_pvss_key_registry_free(reg);
+    for (int i=0; i<n+next_n; i++) {
+        nizk_dl_proof_free(&key_pis[i]);
+    }
+    test_reshare_setup_free(&ts);
+
+    return ret1 || ret2;
+}
+
 typedef int (*test_function)(int);
 
 static test_function test_suite[] = {
     &dh_pvss_test_1,
     &dh_pvss_test_2,
     &dh_pvss_test_3,
-    &dh_pvss_test_4
+    &dh_pvss_test_4,
+    &dh_pvss_test_5,
+    &dh_pvss_test_6,
+    &dh_pvss_test_7,
+    &dh_pvss_test_8,
+    &dh_pvss_test_9,
+    &dh_pvss_test_10,
+    &dh_pvss_test_11,
+    &dh_pvss_test_12,
+    &dh_pvss_test_13,
+    &dh_pvss_test_14,
+    &dh_pvss_test_15,
+    &dh_pvss_test_16,
+    &dh_pvss_test_17,
+    &dh_pvss_test_18,
+    &dh_pvss_test_19,
+    &dh_pvss_test_20
 };
 
 // return test results
@@ -1027,7 +3866,7 @@ int performance_test_with_correctness(double *results, int t, int n, int verbose
     int first = 0;
     for (int i=first; i<first+t+1; i++) {
         reconstruction_shares[i-first] = decrypted_shares[i];
-        int pp_alpha_as_int = (int)BN_get_word(pp.alphas[i+1]); // this works since alphas were chosen small enough to fit in an int
+        int pp_alpha_as_int = pp.params->alphas[i+1]; // alphas are stored as plain integers
         reconstruction_indices[i-first] = pp_alpha_as_int;
     }
     EC_POINT *reconstructed_secret = dh_pvss_reconstruct(group, (const EC_POINT**)reconstruction_shares, reconstruction_indices, pp.t, t+1, ctx);
@@ -1324,7 +4163,7 @@ int performance_test(double *results, int t, int n, int verbose) {
     int first = 0;
     for (int i=first; i<first+t+1; i++) {
         reconstruction_shares[i-first] = decrypted_shares[i];
-        int pp_alpha_as_int = (int)BN_get_word(pp.alphas[i+1]); // this works since alphas were chosen small enough to fit in an int
+        int pp_alpha_as_int = pp.params->alphas[i+1]; // alphas are stored as plain integers
         reconstruction_indices[i-first] = pp_alpha_as_int;
     }
     start = platform_utils_get_wall_time();
@@ -9,6 +9,8 @@
 #include "dh_key_pair.h"
 #include "nizk_dl_eq.h"
 #include "nizk_reshare.h"
+#include "dh_pvss_cache.h"
+#include "dh_pvss_registry.h"
 #include <unistd.h>
 
 #if 0
@@ -35,30 +37,103 @@ typedef struct {
     dh_pvss_user_info_private priv;
 } dh_pvss_user_info;
 
+/* public parameters that depend only on (group, n), i.e., the evaluation points and scrape coefficients
+ * immutable once created and reference counted, so that a single instance can be shared by the
+ * contexts of all epochs (and all threads) that use the same committee size */
+typedef struct dh_pvss_params dh_pvss_params;
+
 typedef struct {
     const EC_GROUP *group;
     BN_CTX *bn_ctx;
     int t;
     int n;
-    BIGNUM **alphas;
-    BIGNUM **betas;
-    BIGNUM **vs;
-    BIGNUM **v_primes;
+    int num_threads; // worker threads used by the parallel code paths, 1 (serial) by default
+    dh_pvss_params *params; // shared reference, see dh_pvss_params_up_ref
 } dh_pvss_ctx;
 
+/* what the reshares of all parties in one epoch have in common, i.e., the scrape terms hashed from the previous
+ * distribution, and V' and W' of the reshare proofs
+ * computed once per epoch and then shared by the per-party prove and verify functions (the pointers are borrowed) */
+typedef struct {
+    const EC_GROUP *group;
+    const EC_POINT *previous_dist_key;
+    const EC_POINT **current_enc_shares;
+    int current_n;
+    const dh_pvss_ctx *next_pp;
+    const EC_POINT **next_committee_keys;
+    BIGNUM **scrape_terms; // next_pp->n terms
+    BIGNUM *neg_scrape_sum; // minus the sum of the scrape terms
+    EC_POINT *V_prime;
+    EC_POINT *W_prime;
+} dh_pvss_reshare_epoch_ctx;
+
+/* the same for resharing several secrets, held by the same committee, at once
+ * the scrape terms are hashed from all previous distributions, so that V' is common to all secrets */
+typedef struct {
+    const EC_GROUP *group;
+    int num_secrets;
+    const EC_POINT **previous_dist_keys; // per secret
+    const EC_POINT ***current_enc_shares; // per secret
+    int current_n;
+    const dh_pvss_ctx *next_pp;
+    const EC_POINT **next_committee_keys;
+    BIGNUM **scrape_terms; // next_pp->n terms
+    BIGNUM *neg_scrape_sum; // minus the sum of the scrape terms
+    EC_POINT *V_prime;
+    EC_POINT **W_primes; // per secret
+} dh_pvss_multi_reshare_ctx;
+
+dh_pvss_params *dh_pvss_params_new(const EC_GROUP *group, const int n, BN_CTX *ctx);
+dh_pvss_params *dh_pvss_params_up_ref(dh_pvss_params *params);
+void dh_pvss_params_free(dh_pvss_params *params);
+
 void dh_pvss_ctx_free(dh_pvss_ctx *pp);
 void dh_pvss_ctx_copy(dh_pvss_ctx *pp_dst, dh_pvss_ctx *pp_src, int t);
+void dh_pvss_ctx_init(dh_pvss_ctx *pp, dh_pvss_params *params, const int t, BN_CTX *ctx);
 void dh_pvss_setup(dh_pvss_ctx *pp, const EC_GROUP *group, const int t, const int n, BN_CTX *ctx);
+void dh_pvss_ctx_set_num_threads(dh_pvss_ctx *pp, int num_threads);
 void dh_pvss_distribute_prove(dh_pvss_ctx *pp, EC_POINT **enc_shares, dh_key_pair *dist_key, const EC_POINT *com_keys[], EC_POINT *secret, nizk_dl_eq_proof *pi);
+void dh_pvss_distribute_prove_committee(dh_pvss_ctx *pp, EC_POINT **enc_shares, dh_key_pair *dist_key, const dh_pvss_committee *com, EC_POINT *secret, nizk_dl_eq_proof *pi);
+// receives the encrypted shares of users first_index+1..first_index+num_shares, returns 0 to continue or non-zero to abort
+typedef int (*dh_pvss_share_sink)(void *arg, int first_index, int num_shares, const EC_POINT *enc_shares[]);
+int dh_pvss_distribute_prove_streaming(dh_pvss_ctx *pp, int chunk_size, dh_pvss_share_sink sink, void *sink_arg, dh_key_pair *dist_key, const EC_POINT *com_keys[], EC_POINT *secret, nizk_dl_eq_proof *pi);
 int dh_pvss_distribute_verify(dh_pvss_ctx *pp, nizk_dl_eq_proof *pi, const EC_POINT **enc_shares, const EC_POINT *pub_dist, const EC_POINT **com_keys);
+int dh_pvss_distribute_verify_committee(dh_pvss_ctx *pp, nizk_dl_eq_proof *pi, const EC_POINT **enc_shares, const EC_POINT *pub_dist, const dh_pvss_committee *com);
+int dh_pvss_distribute_verify_encoded(dh_pvss_ctx *pp, const unsigned char *transcript, size_t len, const EC_POINT **com_keys);
+int dh_pvss_distribute_encoded_poly(dh_pvss_ctx *pp, const unsigned char *transcript, size_t len, const EC_POINT **com_keys, BIGNUM *poly_coeffs[]);
+int dh_pvss_distribute_encoded_partial_sums(dh_pvss_ctx *pp, const unsigned char *transcript, size_t len, const EC_POINT **com_keys, const BIGNUM *poly_coeffs[], int from, int to, EC_POINT *U, EC_POINT *V);
+int dh_pvss_distribute_encoded_check(dh_pvss_ctx *pp, const unsigned char *transcript, size_t len, const EC_POINT *U, const EC_POINT *V);
+int dh_pvss_distribute_verify_file(dh_pvss_ctx *pp, const char *path, const EC_POINT **com_keys);
+int dh_pvss_distribute_digest(dh_pvss_ctx *pp, nizk_dl_eq_proof *pi, const EC_POINT **enc_shares, const EC_POINT *pub_dist, const EC_POINT **com_keys, unsigned char *digest);
+int dh_pvss_distribute_verify_cached(dh_pvss_ctx *pp, dh_pvss_cache *cache, nizk_dl_eq_proof *pi, const EC_POINT **enc_shares, const EC_POINT *pub_dist, const EC_POINT **com_keys);
+int dh_pvss_distribute_verify_batch(dh_pvss_ctx *pp, int num_dists, nizk_dl_eq_proof *pi[], const EC_POINT **enc_shares[], const EC_POINT *pub_dist[], const EC_POINT **com_keys, int *results);
 
 EC_POINT *dh_pvss_decrypt_share_prove(const EC_GROUP *group, const EC_POINT *dist_key_pub, dh_key_pair *C, const EC_POINT *encrypted_share, nizk_dl_eq_proof *pi, BN_CTX *ctx);
 int dh_pvss_decrypt_share_verify(const EC_GROUP *group, const EC_POINT *dist_key_pub, const EC_POINT *C_pub, const EC_POINT *encrypted_share, const EC_POINT *decrypted_share, nizk_dl_eq_proof *pi, BN_CTX *ctx);
+int dh_pvss_decrypt_share_verify_batch(const EC_GROUP *group, const EC_POINT *dist_key_pub, int num_shares, const EC_POINT *C_pub[], const EC_POINT *encrypted_shares[], const EC_POINT *decrypted_shares[], nizk_dl_eq_proof *pi[], int *results, BN_CTX *ctx);
+void dh_pvss_decrypt_shares_prove(const EC_GROUP *group, int num_dealers, const EC_POINT *dist_key_pubs[], const dh_key_pair *C, const EC_POINT *encrypted_shares[], EC_POINT *decrypted_shares[], nizk_dl_eq_proof *pi, BN_CTX *ctx);
+int dh_pvss_decrypt_shares_verify(const EC_GROUP *group, int num_dealers, const EC_POINT *dist_key_pubs[], const EC_POINT *C_pub, const EC_POINT *encrypted_shares[], const EC_POINT *decrypted_shares[], const nizk_dl_eq_proof *pi, BN_CTX *ctx);
 EC_POINT *dh_pvss_reconstruct(const EC_GROUP *group, const EC_POINT *shares[], int share_indices[], int t, int length, BN_CTX *ctx);
 EC_POINT *dh_pvss_committee_dist_key_calc(const EC_GROUP *group, const EC_POINT *keys[], int key_indices[], int t, int length, BN_CTX *ctx);
 void dh_pvss_reshare_prove(const EC_GROUP *group, int party_index, const dh_key_pair *party_committee_kp, const dh_key_pair *party_dist_kp, const EC_POINT *previous_dist_key, const EC_POINT *current_enc_shares[], const int current_n, const dh_pvss_ctx *next_pp, const EC_POINT *next_committee_keys[], EC_POINT *enc_re_shares[], nizk_reshare_proof *pi, BN_CTX *ctx);
 int dh_pvss_reshare_verify(const dh_pvss_ctx *pp, const dh_pvss_ctx *next_pp, int party_index, const EC_POINT *party_committee_pub_key, const EC_POINT *party_dist_pub_key, const EC_POINT *previous_dist_key, const EC_POINT *current_enc_shares[], const EC_POINT *next_committee_keys[], EC_POINT *enc_re_shares[], nizk_reshare_proof *pi);
+void dh_pvss_reshare_epoch_ctx_init(dh_pvss_reshare_epoch_ctx *epoch, const EC_GROUP *group, const EC_POINT *previous_dist_key, const EC_POINT *current_enc_shares[], const int current_n, const dh_pvss_ctx *next_pp, const EC_POINT *next_committee_keys[], BN_CTX *ctx);
+void dh_pvss_reshare_epoch_ctx_free(dh_pvss_reshare_epoch_ctx *epoch);
+void dh_pvss_reshare_prove_epoch(const dh_pvss_reshare_epoch_ctx *epoch, int party_index, const dh_key_pair *party_committee_kp, const dh_key_pair *party_dist_kp, EC_POINT *enc_re_shares[], nizk_reshare_proof *pi, BN_CTX *ctx);
+int dh_pvss_reshare_verify_epoch(const dh_pvss_reshare_epoch_ctx *epoch, int party_index, const EC_POINT *party_committee_pub_key, const EC_POINT *party_dist_pub_key, const EC_POINT *enc_re_shares[], const nizk_reshare_proof *pi, BN_CTX *ctx);
+int dh_pvss_reshare_verify_batch(const dh_pvss_reshare_epoch_ctx *epoch, int num_parties, const int party_indices[], const EC_POINT *party_committee_pub_keys[], const EC_POINT *party_dist_pub_keys[], const EC_POINT **enc_re_shares[], const nizk_reshare_proof *pi[], int *results, BN_CTX *ctx);
+int dh_pvss_reshare_verify_quorum(const dh_pvss_reshare_epoch_ctx *epoch, int t, int num_threads, int num_reshares, const int party_indices[], const EC_POINT *party_committee_pub_keys[], const EC_POINT *party_dist_pub_keys[], const EC_POINT **enc_re_shares[], const nizk_reshare_proof *pi[], int *valid_indices, int *num_verified, BN_CTX *ctx);
+void dh_pvss_multi_reshare_ctx_init(dh_pvss_multi_reshare_ctx *multi, const EC_GROUP *group, int num_secrets, const EC_POINT *previous_dist_keys[], const EC_POINT **current_enc_shares[], const int current_n, const dh_pvss_ctx *next_pp, const EC_POINT *next_committee_keys[], BN_CTX *ctx);
+void dh_pvss_multi_reshare_ctx_free(dh_pvss_multi_reshare_ctx *multi);
+void dh_pvss_multi_reshare_prove(const dh_pvss_multi_reshare_ctx *multi, int party_index, const dh_key_pair *party_committee_kp, const dh_key_pair party_dist_kps[], EC_POINT **enc_re_shares[], nizk_reshare_proof *pi, BN_CTX *ctx);
+int dh_pvss_multi_reshare_verify(const dh_pvss_multi_reshare_ctx *multi, int party_index, const EC_POINT *party_committee_pub_key, const EC_POINT *party_dist_pub_keys[], const EC_POINT **enc_re_shares[], const nizk_reshare_proof *pi, BN_CTX *ctx);
+void dh_pvss_refresh_prove(const dh_pvss_ctx *pp, const EC_POINT *dist_key, const EC_POINT *com_keys[], const dh_key_pair *refresh_kp, EC_POINT *refresh_shares[], nizk_dl_eq_proof *pi);
+int dh_pvss_refresh_verify(const dh_pvss_ctx *pp, const EC_POINT *dist_key, const EC_POINT *com_keys[], const EC_POINT *refresh_pub, const EC_POINT *refresh_shares[], const nizk_dl_eq_proof *pi);
+void dh_pvss_refresh_apply(const dh_pvss_ctx *pp, int num_refreshes, const EC_POINT *refresh_pubs[], const EC_POINT **refresh_shares[], EC_POINT *dist_key, EC_POINT *enc_shares[]);
 EC_POINT *dh_pvss_reconstruct_reshare(const dh_pvss_ctx *pp, int num_valid_indices, int *valid_indices, EC_POINT *enc_re_shares[]);
+int dh_pvss_reconstruct_reshares(const dh_pvss_ctx *pp, int num_valid_indices, const int *valid_indices, int next_n, const EC_POINT **enc_re_shares[], EC_POINT *reconstructed_shares[]);
+int dh_pvss_reshare_aggregate_verify_share(const dh_pvss_ctx *pp, int num_valid_indices, const int *valid_indices, const EC_POINT *column[], const EC_POINT *reconstructed_share);
+int dh_pvss_reshare_aggregate_verify(const dh_pvss_ctx *pp, int num_valid_indices, const int *valid_indices, int next_n, const EC_POINT **enc_re_shares[], const EC_POINT *reconstructed_shares[]);
 
 int dh_pvss_test_suite(int print);
 int performance_test_with_correctness(double *times, int t, int n, int verbose);
@@ -0,0 +1,347 @@
+//
+//  dh_pvss_accumulator.c
+//  OpenSSL-for-iOS
+//
+#include "dh_pvss_accumulator.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include "SSS.h"
+#include "dh_pvss.h"
+
+struct dh_pvss_accumulator {
+    pthread_mutex_t lock;
+    const EC_GROUP *group;
+    int num_parties; // t+1
+    int *valid_indices;
+    BIGNUM **lambdas; // Lagrange weight of each valid party
+    int *claimed; // per valid party, set when its reshare is being added
+    int num_added;
+    int next_n;
+    EC_POINT **sums; // per slice
+};
+
+dh_pvss_accumulator *dh_pvss_accumulator_new(const EC_GROUP *group, int n, int num_valid_indices, const int *valid_indices, int next_n, BN_CTX *ctx) {
+    const BIGNUM *order = get0_order(group);
+    assert(num_valid_indices > 0 && "dh_pvss_accumulator_new: usage error, no valid indices passed");
+    assert(next_n > 0 && "dh_pvss_accumulator_new: usage error, next_n must be positive");
+
+    // Lagrange weights need distinct indices, and a party must be found by its index when it is added
+    for (int i=0; i<num_valid_indices; i++) {
+        if (valid_indices[i] < 1 || valid_indices[i] > n) {
+            return NULL;
+        }
+        for (int k=0; k<i; k++) {
+            if (valid_indices[k] == valid_indices[i]) {
+                return NULL;
+            }
+        }
+    }
+    dh_pvss_accumulator *acc = malloc(sizeof(dh_pvss_accumulator));
+    assert(acc && "dh_pvss_accumulator_new: allocation error (acc)");
+    int ret = pthread_mutex_init(&acc->lock, NULL);
+    assert(ret == 0 && "dh_pvss_accumulator_new: pthread_mutex_init failed");
+    acc->group = group;
+    acc->num_parties = num_valid_indices;
+    acc->num_added = 0;
+    acc->next_n = next_n;
+
+    // Lagrange weights
+    acc->valid_indices = malloc(num_valid_indices * sizeof(int));
+    assert(acc->valid_indices && "dh_pvss_accumulator_new: allocation error (valid indices)");
+    acc->claimed = calloc(num_valid_indices, sizeof(int));
+    assert(acc->claimed && "dh_pvss_accumulator_new: allocation error (claimed)");
+    acc->lambdas = bn_new_array(num_valid_indices);
+    for (int i=0; i<num_valid_indices; i++) {
+        acc->valid_indices[i] = valid_indices[i];
+        lagX(group, acc->lambdas[i], valid_indices, num_valid_indices, i, ctx);
+        BN_nnmod(acc->lambdas[i], acc->lambdas[i], order, ctx);
+    }
+
+    // empty sums
+    acc->sums = malloc(next_n * sizeof(EC_POINT *));
+    assert(acc->sums && "dh_pvss_accumulator_new: allocation error (sums)");
+    for (int j=0; j<next_n; j++) {
+        acc->sums[j] = point_new(group); // point at infinity
+    }
+
+    return acc;
+}
+
+void dh_pvss_accumulator_free(dh_pvss_accumulator *acc) {
+    for (int j=0; j<acc->next_n; j++) {
+        point_free(acc->sums[j]);
+    }
+    free(acc->sums);
+    bn_free_array(acc->num_parties, acc->lambdas);
+    free(acc->claimed);
+    free(acc->valid_indices);
+    pthread_mutex_destroy(&acc->lock);
+    free(acc);
+}
+
+int dh_pvss_accumulator_add(dh_pvss_accumulator *acc, int party_index, const EC_POINT *enc_re_shares[], BN_CTX *ctx) {
+    const EC_GROUP *group = acc->group;
+
+    // claim the party
+    pthread_mutex_lock(&acc->lock);
+    int pos = -1;
+    for (int i=0; i<acc->num_parties; i++) {
+        if (acc->valid_indices[i] == party_index) {
+            pos = i;
+        }
+    }
+    int ret = pos < 0 || acc->claimed[pos];
+    if (ret == 0) {
+        acc->claimed[pos] = 1;
+    }
+    pthread_mutex_unlock(&acc->lock);
+    if (ret) {
+        return 1;
+    }
+
+    // weigh the re-shares outside of the lock
+    EC_POINT *terms[acc->next_n];
+    for (int j=0; j<acc->next_n; j++) {
+        terms[j] = point_new(group);
+        point_mul(group, terms[j], acc->lambdas[pos], enc_re_shares[j], ctx);
+    }
+
+    // fold them in
+    pthread_mutex_lock(&acc->lock);
+    for (int j=0; j<acc->next_n; j++) {
+        point_add(group, acc->sums[j], acc->sums[j], terms[j], ctx);
+    }
+    acc->num_added++;
+    pthread_mutex_unlock(&acc->lock);
+
+    // cleanup
+    for (int j=0; j<acc->next_n; j++) {
+        point_free(terms[j]);
+    }
+
+    return 0;
+}
+
+int dh_pvss_accumulator_is_complete(dh_pvss_accumulator *acc) {
+    pthread_mutex_lock(&acc->lock);
+    int complete = acc->num_added == acc->num_parties;
+    pthread_mutex_unlock(&acc->lock);
+    return complete;
+}
+
+int dh_pvss_accumulator_finish(dh_pvss_accumulator *acc, EC_POINT *reconstructed_shares[]) {
+    pthread_mutex_lock(&acc->lock);
+    int ret = acc->num_added == acc->num_parties ? 0 : 1;
+    for (int j=0; j<acc->next_n && ret == 0; j++) {
+        reconstructed_shares[j] = point_new(acc->group);
+        EC_POINT_copy(reconstructed_shares[j], acc->sums[j]);
+    }
+    pthread_mutex_unlock(&acc->lock);
+    return ret;
+}
+
+/*
+ *
+ *  dh_pvss_accumulator tests
+ *
+ */
+// random re-shares of num_parties parties for next_n slices
+static void test_reshare_matrix(const EC_GROUP *group, int num_parties, int next_n, EC_POINT *matrix[], BN_CTX *ctx) {
+    for (int i=0; i<num_parties*next_n; i++) {
+        matrix[i] = point_random(group, ctx);
+    }
+}
+
+static int dh_pvss_accumulator_test_1(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+    const int t = 3;
+    const int n = 7;
+    const int next_n = 6;
+    dh_pvss_ctx pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+
+    // re-shares of all parties, of which every other is valid
+    EC_POINT *matrix[n * next_n];
+    test_reshare_matrix(group, n, next_n, matrix, ctx);
+    const EC_POINT **enc_re_shares[n];
+    for (int i=0; i<n; i++) {
+        enc_re_shares[i] = (const EC_POINT **)&matrix[i * next_n];
+    }
+    int valid_indices[] = { 1, 3, 5, 7 }; // t+1 indices
+
+    // add in an arbitrary order, checking that the accumulator is not done early
+    dh_pvss_accumulator *acc = dh_pvss_accumulator_new(group, n, t+1, valid_indices, next_n, ctx);
+    const int order[] = { 5, 1, 7, 3 };
+    int num_errors = 0;
+    EC_POINT *accumulated[next_n];
+    for (int i=0; i<t+1; i++) {
+        num_errors += dh_pvss_accumulator_is_complete(acc);
+        num_errors += dh_pvss_accumulator_finish(acc, accumulated) == 0;
+        num_errors += dh_pvss_accumulator_add(acc, order[i], enc_re_shares[order[i] - 1], ctx) != 0;
+    }
+    num_errors += !dh_pvss_accumulator_is_complete(acc);
+    num_errors += dh_pvss_accumulator_finish(acc, accumulated) != 0;
+
+    // compare with reconstruction at once
+    EC_POINT *reconstructed[next_n];
+    dh_pvss_reconstruct_reshares(&pp, t+1, valid_indices, next_n, enc_re_shares, reconstructed);
+    for (int j=0; j<next_n; j++) {
+        num_errors += num_errors == 0 && point_cmp(group, accumulated[j], reconstructed[j], ctx) != 0;
+    }
+    if (print) {
+        printf("%6s Test 1 - 1: Accumulated reshare reconstruction %s reconstruction at once\n", num_errors ? "NOT OK" : "OK", num_errors ? "DIFFERS FROM" : "equals");
+    }
+
+    // parties outside the valid set, and parties added twice, are rejected
+    int ret2 = dh_pvss_accumulator_add(acc, 2, enc_re_shares[1], ctx) == 0;
+    ret2 |= dh_pvss_accumulator_add(acc, 3, enc_re_shares[2], ctx) == 0;
+    if (print) {
+        printf("%6s Test 1 - 2: Invalid and repeated parties %s\n", ret2 ? "NOT OK" : "OK", ret2 ? "ARE accumulated (which is an ERROR)" : "not accumulated (which is CORRECT)");
+    }
+
+    // valid indices that are repeated, or outside 1..n, are rejected
+    int repeated_indices[] = { 1, 3, 3, 7 };
+    int outside_indices[] = { 1, 3, 5, n + 1 };
+    int zero_indices[] = { 0, 3, 5, 7 };
+    dh_pvss_accumulator *bad_accs[] = {
+        dh_pvss_accumulator_new(group, n, t+1, repeated_indices, next_n, ctx),
+        dh_pvss_accumulator_new(group, n, t+1, outside_indices, next_n, ctx),
+        dh_pvss_accumulator_new(group, n, t+1, zero_indices, next_n, ctx)
+    };
+    int ret3 = 0;
+    for (int k=0; k<3; k++) {
+        if (bad_accs[k]) {
+            ret3 = 1;
+            dh_pvss_accumulator_free(bad_accs[k]);
+        }
+    }
+    if (print) {
+        printf("%6s Test 1 - 3: Repeated and out of range valid indices %s\n", ret3 ? "NOT OK" : "OK", ret3 ? "ARE accepted (which is an ERROR)" : "not accepted (which is CORRECT)");
+    }
+
+    // cleanup
+    for (int j=0; j<next_n; j++) {
+        if (num_errors == 0) {
+            point_free(accumulated[j]);
+        }
+        point_free(reconstructed[j]);
+    }
+    for (int i=0; i<n*next_n; i++) {
+        point_free(matrix[i]);
+    }
+    dh_pvss_accumulator_free(acc);
+    dh_pvss_ctx_free(&pp);
+    BN_CTX_free(ctx);
+
+    return num_errors != 0 || ret2 || ret3;
+}
+
+typedef struct {
+    dh_pvss_accumulator *acc;
+    int party_index;
+    const EC_POINT **enc_re_shares;
+    int ret;
+} test_add_arg;
+
+static void *test_add_thread(void *arg) {
+    test_add_arg *a = arg;
+    BN_CTX *ctx = BN_CTX_new();
+    a->ret = dh_pvss_accumulator_add(a->acc, a->party_index, a->enc_re_shares, ctx);
+    BN_CTX_free(ctx);
+    return NULL;
+}
+
+static int dh_pvss_accumulator_test_2(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+    const int t = 5;
+    const int n = 10;
+    const int next_n = 8;
+    dh_pvss_ctx pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+
+    // the first t+1 parties are valid and arrive at the same time
+    EC_POINT *matrix[n * next_n];
+    test_reshare_matrix(group, n, next_n, matrix, ctx);
+    const EC_POINT **enc_re_shares[n];
+    int valid_indices[t+1];
+    for (int i=0; i<t+1; i++) {
+        enc_re_shares[i] = (const EC_POINT **)&matrix[i * next_n];
+        valid_indices[i] = i + 1;
+    }
+    dh_pvss_accumulator *acc = dh_pvss_accumulator_new(group, n, t+1, valid_indices, next_n, ctx);
+    pthread_t threads[t+1];
+    test_add_arg args[t+1];
+    for (int i=0; i<t+1; i++) {
+        args[i] = (test_add_arg){ acc, i + 1, enc_re_shares[i], -1 };
+        int ret = pthread_create(&threads[i], NULL, test_add_thread, &args[i]);
+        assert(ret == 0 && "dh_pvss_accumulator_test_2: pthread_create failed");
+    }
+    int num_errors = 0;
+    for (int i=0; i<t+1; i++) {
+        pthread_join(threads[i], NULL);
+        num_errors += args[i].ret != 0;
+    }
+
+    // compare with reconstruction at once
+    EC_POINT *accumulated[next_n];
+    EC_POINT *reconstructed[next_n];
+    num_errors += dh_pvss_accumulator_finish(acc, accumulated) != 0;
+    dh_pvss_reconstruct_reshares(&pp, t+1, valid_indices, next_n, enc_re_shares, reconstructed);
+    for (int j=0; j<next_n; j++) {
+        num_errors += num_errors == 0 && point_cmp(group, accumulated[j], reconstructed[j], ctx) != 0;
+    }
+    if (print) {
+        printf("%6s Test 2 - 1: Concurrently accumulated reshare reconstruction %s reconstruction at once\n", num_errors ? "NOT OK" : "OK", num_errors ? "DIFFERS FROM" : "equals");
+    }
+
+    // cleanup
+    for (int j=0; j<next_n; j++) {
+        if (num_errors == 0) {
+            point_free(accumulated[j]);
+        }
+        point_free(reconstructed[j]);
+    }
+    for (int i=0; i<n*next_n; i++) {
+        point_free(matrix[i]);
+    }
+    dh_pvss_accumulator_free(acc);
+    dh_pvss_ctx_free(&pp);
+    BN_CTX_free(ctx);
+
+    return num_errors != 0;
+}
+
+typedef int (*test_function)(int);
+
+static test_function test_suite[] = {
+    &dh_pvss_accumulator_test_1,
+    &dh_pvss_accumulator_test_2
+};
+
+// return test results
+//   0 = passed (all individual tests passed)
+//   1 = failed (one or more individual tests failed)
+// setting print to 0 (zero) suppresses stdio printouts, while print 1 is 'verbose'
+int dh_pvss_accumulator_test_suite(int print) {
+    if (print) {
+        printf("DH PVSS accumulator test suite BEGIN ----------------\n");
+    }
+    int num_tests = sizeof(test_suite)/sizeof(test_function);
+    int ret = 0;
+    for (int i=0; i<num_tests; i++) {
+        if (test_suite[i](print)) {
+            ret = 1;
+        }
+    }
+    if (print) {
+        printf("DH PVSS accumulator test suite END ------------------\n");
+#ifdef DEBUG
+        print_allocation_status();
+#endif
+        fflush(stdout);
+    }
+    return ret;
+}
@@ -0,0 +1,33 @@
+//
+//  dh_pvss_accumulator.h
+//  OpenSSL-for-iOS
+//
+
+#ifndef DH_PVSS_ACCUMULATOR_H
+#define DH_PVSS_ACCUMULATOR_H
+#include "P256.h"
+
+/* incremental reshare reconstruction
+ * once the t+1 valid parties of a handover are fixed, the encrypted re-shares of each party are folded into running
+ * per-slice sums, weighted by its Lagrange coefficient, as soon as they arrive, so that reconstruction is done
+ * when the last reshare is added (see dh_pvss_reconstruct_reshares for the all-at-once equivalent)
+ * all functions are safe to call from several threads, each passing its own BN_CTX */
+typedef struct dh_pvss_accumulator dh_pvss_accumulator;
+
+// valid_indices are the t+1 valid parties of the n parties that reshared, as indices starting from 1
+// returns NULL if the valid indices are not distinct indices in 1..n
+dh_pvss_accumulator *dh_pvss_accumulator_new(const EC_GROUP *group, int n, int num_valid_indices, const int *valid_indices, int next_n, BN_CTX *ctx);
+void dh_pvss_accumulator_free(dh_pvss_accumulator *acc);
+
+// fold in the next_n encrypted re-shares of party party_index (starting from 1)
+// returns 0 on success, and 1 if the party is not one of the valid parties or has already been added
+int dh_pvss_accumulator_add(dh_pvss_accumulator *acc, int party_index, const EC_POINT *enc_re_shares[], BN_CTX *ctx);
+int dh_pvss_accumulator_is_complete(dh_pvss_accumulator *acc);
+
+// read out the next_n reconstructed encrypted shares, which are allocated for the caller
+// returns 0 on success, and 1 if not all valid parties have been added (in which case nothing is allocated)
+int dh_pvss_accumulator_finish(dh_pvss_accumulator *acc, EC_POINT *reconstructed_shares[]);
+
+int dh_pvss_accumulator_test_suite(int print);
+
+#endif /* DH_PVSS_ACCUMULATOR_H */
@@ -0,0 +1,194 @@
+//
+//  dh_pvss_cache.c
+//  OpenSSL-for-iOS
+//
+#include "dh_pvss_cache.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int in_use;
+    unsigned long last_used; // tick of last lookup or insert, smallest is least recently used
+    unsigned char digest[DH_PVSS_CACHE_DIGEST_LEN];
+    int verdict;
+} dh_pvss_cache_entry;
+
+/* the capacity is meant to be modest (tens to hundreds of transcripts), so entries live in a plain array
+ * that is searched linearly */
+struct dh_pvss_cache {
+    pthread_mutex_t lock;
+    int capacity;
+    unsigned long tick;
+    dh_pvss_cache_entry *entries;
+};
+
+dh_pvss_cache *dh_pvss_cache_new(int capacity) {
+    assert(capacity > 0 && "dh_pvss_cache_new: usage error, capacity must be positive");
+    dh_pvss_cache *cache = malloc(sizeof(dh_pvss_cache));
+    assert(cache && "dh_pvss_cache_new: allocation error (cache)");
+    cache->entries = calloc(capacity, sizeof(dh_pvss_cache_entry));
+    assert(cache->entries && "dh_pvss_cache_new: allocation error (entries)");
+    int ret = pthread_mutex_init(&cache->lock, NULL);
+    assert(ret == 0 && "dh_pvss_cache_new: pthread_mutex_init failed");
+    cache->capacity = capacity;
+    cache->tick = 0;
+    return cache;
+}
+
+void dh_pvss_cache_free(dh_pvss_cache *cache) {
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->entries);
+    free(cache);
+}
+
+int dh_pvss_cache_size(dh_pvss_cache *cache) {
+    pthread_mutex_lock(&cache->lock);
+    int size = 0;
+    for (int i=0; i<cache->capacity; i++) {
+        size += cache->entries[i].in_use;
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return size;
+}
+
+// entry holding digest, or NULL, to be called with the lock held
+static dh_pvss_cache_entry *cache_find(dh_pvss_cache *cache, const unsigned char *digest) {
+    for (int i=0; i<cache->capacity; i++) {
+        dh_pvss_cache_entry *entry = &cache->entries[i];
+        if (entry->in_use && memcmp(entry->digest, digest, DH_PVSS_CACHE_DIGEST_LEN) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+int dh_pvss_cache_lookup(dh_pvss_cache *cache, const unsigned char *digest, int *verdict) {
+    pthread_mutex_lock(&cache->lock);
+    dh_pvss_cache_entry *entry = cache_find(cache, digest);
+    if (!entry) {
+        pthread_mutex_unlock(&cache->lock);
+        return 0;
+    }
+    entry->last_used = ++cache->tick;
+    *verdict = entry->verdict;
+    pthread_mutex_unlock(&cache->lock);
+    return 1;
+}
+
+void dh_pvss_cache_insert(dh_pvss_cache *cache, const unsigned char *digest, int verdict) {
+    pthread_mutex_lock(&cache->lock);
+    dh_pvss_cache_entry *entry = cache_find(cache, digest);
+    if (!entry) { // pick a free entry, or else the least recently used one
+        entry = &cache->entries[0];
+        for (int i=0; i<cache->capacity && entry->in_use; i++) {
+            dh_pvss_cache_entry *candidate = &cache->entries[i];
+            if (!candidate->in_use || candidate->last_used < entry->last_used) {
+                entry = candidate;
+            }
+        }
+    }
+    entry->in_use = 1;
+    entry->last_used = ++cache->tick;
+    memcpy(entry->digest, digest, DH_PVSS_CACHE_DIGEST_LEN);
+    entry->verdict = verdict;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/*
+ *
+ *  dh_pvss_cache tests
+ *
+ */
+static void test_digest(unsigned char *digest, int i) {
+    memset(digest, 0, DH_PVSS_CACHE_DIGEST_LEN);
+    digest[0] = (unsigned char)i;
+}
+
+static int dh_pvss_cache_test_1(int print) {
+    const int capacity = 3;
+    dh_pvss_cache *cache = dh_pvss_cache_new(capacity);
+    unsigned char digest[DH_PVSS_CACHE_DIGEST_LEN];
+
+    // fill, use entry 0 again, then insert one more, which evicts entry 1
+    for (int i=0; i<capacity; i++) {
+        test_digest(digest, i);
+        dh_pvss_cache_insert(cache, digest, i % 2);
+    }
+    int verdict = -1;
+    test_digest(digest, 0);
+    int found_0 = dh_pvss_cache_lookup(cache, digest, &verdict) && verdict == 0;
+    test_digest(digest, capacity);
+    dh_pvss_cache_insert(cache, digest, 1);
+
+    int found[capacity + 1];
+    for (int i=0; i<capacity+1; i++) {
+        test_digest(digest, i);
+        found[i] = dh_pvss_cache_lookup(cache, digest, &verdict);
+    }
+    int ok = found_0 && found[0] && !found[1] && found[2] && found[3] && dh_pvss_cache_size(cache) == capacity;
+    if (print) {
+        printf("%6s Test 1 - 1: Least recently used entry %s evicted\n", ok ? "OK" : "NOT OK", ok ? "is" : "NOT");
+    }
+
+    // cleanup
+    dh_pvss_cache_free(cache);
+
+    return !ok;
+}
+
+static int dh_pvss_cache_test_2(int print) {
+    dh_pvss_cache *cache = dh_pvss_cache_new(2);
+    unsigned char digest[DH_PVSS_CACHE_DIGEST_LEN];
+    test_digest(digest, 7);
+
+    // insert a verdict, then overwrite it with a new one
+    dh_pvss_cache_insert(cache, digest, 0);
+    int verdict = -1;
+    int found = dh_pvss_cache_lookup(cache, digest, &verdict);
+    int num_differences = !found || verdict != 0;
+    dh_pvss_cache_insert(cache, digest, 1);
+    found = dh_pvss_cache_lookup(cache, digest, &verdict);
+    num_differences += !found || verdict != 1 || dh_pvss_cache_size(cache) != 1;
+    if (print) {
+        printf("%6s Test 2 - 1: Cached verdicts %s returned\n", num_differences ? "NOT OK" : "OK", num_differences ? "NOT correctly" : "correctly");
+    }
+
+    // cleanup
+    dh_pvss_cache_free(cache);
+
+    return num_differences != 0;
+}
+
+typedef int (*test_function)(int);
+
+static test_function test_suite[] = {
+    &dh_pvss_cache_test_1,
+    &dh_pvss_cache_test_2
+};
+
+// return test results
+//   0 = passed (all individual tests passed)
+//   1 = failed (one or more individual tests failed)
+// setting print to 0 (zero) suppresses stdio printouts, while print 1 is 'verbose'
+int dh_pvss_cache_test_suite(int print) {
+    if (print) {
+        printf("DH PVSS cache test suite BEGIN ----------------------\n");
+    }
+    int num_tests = sizeof(test_suite)/sizeof(test_function);
+    int ret = 0;
+    for (int i=0; i<num_tests; i++) {
+        if (test_suite[i](print)) {
+            ret = 1;
+        }
+    }
+    if (print) {
+        printf("DH PVSS cache test suite END ------------------------\n");
+#ifdef DEBUG
+        print_allocation_status();
+#endif
+        fflush(stdout);
+    }
+    return ret;
+}
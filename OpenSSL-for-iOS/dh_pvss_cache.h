@@ -0,0 +1,31 @@
+//
+//  dh_pvss_cache.h
+//  OpenSSL-for-iOS
+//
+
+#ifndef DH_PVSS_CACHE_H
+#define DH_PVSS_CACHE_H
+#include <openssl/sha.h>
+#include "P256.h"
+
+#define DH_PVSS_CACHE_DIGEST_LEN SHA256_DIGEST_LENGTH
+
+/* bounded, least recently used cache of verified transcripts, keyed by transcript digest
+ * an entry holds the verification verdict only: the scrape terms of a distribution are not kept, as the reshare
+ * steps hash their own polynomials, from the reshare transcripts, and have no use for them
+ * all functions are safe to call from several threads */
+typedef struct dh_pvss_cache dh_pvss_cache;
+
+dh_pvss_cache *dh_pvss_cache_new(int capacity);
+void dh_pvss_cache_free(dh_pvss_cache *cache);
+int dh_pvss_cache_size(dh_pvss_cache *cache);
+
+// returns 1 and the verdict if the digest is cached, and 0 otherwise
+int dh_pvss_cache_lookup(dh_pvss_cache *cache, const unsigned char *digest, int *verdict);
+
+// store a verdict, evicting the least recently used entry if the cache is full
+void dh_pvss_cache_insert(dh_pvss_cache *cache, const unsigned char *digest, int verdict);
+
+int dh_pvss_cache_test_suite(int print);
+
+#endif /* DH_PVSS_CACHE_H */
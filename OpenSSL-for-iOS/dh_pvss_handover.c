@@ -0,0 +1,447 @@
+//
+//  dh_pvss_handover.c
+//  OpenSSL-for-iOS
+//
+#include "dh_pvss_handover.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include "SSS.h"
+#include "parallel_tools.h"
+#include "platform_measurement_utils.h"
+
+typedef enum {
+    HANDOVER_EPOCH,     // shared reshare precomputation
+    HANDOVER_PROVE,     // reshare of party index
+    HANDOVER_VERIFY,    // verification of the reshare of party index
+    HANDOVER_QUORUM,    // t+1 reshares verified, fixes the valid parties
+    HANDOVER_SLICE,     // reconstruction of slice index
+    HANDOVER_DIST_KEY,  // distribution key of the next committee
+    HANDOVER_DECRYPT,   // decryption by next committee member index
+    HANDOVER_SECRET     // reconstruction of the secret
+} handover_step;
+
+typedef struct {
+    handover_step step;
+    int index;
+    int num_deps; // number of dependencies left before the task is ready
+    int num_succs;
+    int *succs;
+    double ready_path; // longest chain of steps before this one
+} handover_task;
+
+typedef struct {
+    const dh_pvss_handover_input *in;
+    dh_pvss_handover_result *res;
+    const EC_POINT **next_committee_keys;
+    dh_pvss_reshare_epoch_ctx epoch;
+    EC_POINT ***enc_re_shares; // per party
+    nizk_reshare_proof *pis; // per party
+    int *proved; // per party
+    BIGNUM **lambdas; // Lagrange weights of the valid parties
+    EC_POINT **decrypted_shares;
+    int num_valid;
+
+    // scheduler, guarded by lock
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int num_tasks;
+    handover_task *tasks;
+    int *queue; // ready tasks
+    int queue_head;
+    int queue_tail;
+    int num_running;
+    double critical_path;
+    double total_work;
+} handover;
+
+static void handover_add_succ(handover *h, int task, int succ) {
+    handover_task *t = &h->tasks[task];
+    t->succs = realloc(t->succs, (t->num_succs + 1) * sizeof(int));
+    assert(t->succs && "handover_add_succ: allocation error (succs)");
+    t->succs[t->num_succs++] = succ;
+}
+
+// run one step, returns 1 if the successors may be released
+static int handover_run_task(handover *h, const handover_task *task, BN_CTX *ctx) {
+    const dh_pvss_handover_input *in = h->in;
+    const EC_GROUP *group = in->pp->group;
+    const int t = in->pp->t;
+    const int next_t = in->next_pp->t;
+    const int i = task->index;
+    int ret = 1;
+    switch (task->step) {
+        case HANDOVER_EPOCH:
+            dh_pvss_reshare_epoch_ctx_init(&h->epoch, group, in->previous_dist_key, in->current_enc_shares, in->pp->n, in->next_pp, h->next_committee_keys, ctx);
+            break;
+        case HANDOVER_PROVE:
+            dh_pvss_reshare_prove_epoch(&h->epoch, i, &in->committee_key_pairs[i], &in->dist_key_pairs[i], h->enc_re_shares[i], &h->pis[i], ctx);
+            h->proved[i] = 1;
+            break;
+        case HANDOVER_VERIFY:
+            ret = dh_pvss_reshare_verify_epoch(&h->epoch, i, in->committee_key_pairs[i].pub, in->dist_pub_keys[i], (const EC_POINT**)h->enc_re_shares[i], &h->pis[i], ctx) == 0;
+            break;
+        case HANDOVER_QUORUM:
+            h->lambdas = bn_new_array(t + 1);
+            for (int k=0; k<t+1; k++) {
+                lagX(group, h->lambdas[k], h->res->valid_indices, t+1, k, ctx);
+                BN_nnmod(h->lambdas[k], h->lambdas[k], get0_order(group), ctx);
+            }
+            break;
+        case HANDOVER_SLICE: {
+            const EC_POINT *slice[t+1];
+            for (int k=0; k<t+1; k++) {
+                slice[k] = h->enc_re_shares[h->res->valid_indices[k] - 1][i];
+            }
+            h->res->reconstructed_shares[i] = point_new(group);
+            point_weighted_sum(group, h->res->reconstructed_shares[i], t+1, (const BIGNUM**)h->lambdas, slice, ctx);
+            break;
+        }
+        case HANDOVER_DIST_KEY: {
+            const EC_POINT *dist_keys[t+1];
+            for (int k=0; k<t+1; k++) {
+                dist_keys[k] = in->dist_pub_keys[h->res->valid_indices[k] - 1];
+            }
+            h->res->next_dist_key = dh_pvss_committee_dist_key_calc(group, dist_keys, h->res->valid_indices, t, t+1, ctx);
+            break;
+        }
+        case HANDOVER_DECRYPT: {
+            nizk_dl_eq_proof pi;
+            h->decrypted_shares[i] = dh_pvss_decrypt_share_prove(group, h->res->next_dist_key, &in->next_committee_key_pairs[i], h->res->reconstructed_shares[i], &pi, ctx);
+            ret = dh_pvss_decrypt_share_verify(group, h->res->next_dist_key, in->next_committee_key_pairs[i].pub, h->res->reconstructed_shares[i], h->decrypted_shares[i], &pi, ctx) == 0;
+            nizk_dl_eq_proof_free(&pi);
+            break;
+        }
+        case HANDOVER_SECRET: {
+            int share_indices[next_t+1];
+            for (int k=0; k<next_t+1; k++) {
+                share_indices[k] = k + 1;
+            }
+            h->res->secret = dh_pvss_reconstruct(group, (const EC_POINT**)h->decrypted_shares, share_indices, next_t, next_t+1, ctx);
+            break;
+        }
+    }
+    return ret;
+}
+
+// one worker of the pool, which runs ready tasks until there are none left and none running
+static void handover_worker(int chunk, int from, int to, BN_CTX *ctx, void *arg) {
+    (void)chunk; // every worker takes tasks from the shared queue, rather than a range
+    (void)from;
+    (void)to;
+    handover *h = arg;
+    pthread_mutex_lock(&h->lock);
+    while (1) {
+        while (h->queue_head == h->queue_tail && h->num_running > 0) {
+            pthread_cond_wait(&h->cond, &h->lock);
+        }
+        if (h->queue_head == h->queue_tail) { // done, or stuck
+            break;
+        }
+        handover_task *task = &h->tasks[h->queue[h->queue_head++]];
+        h->num_running++;
+        pthread_mutex_unlock(&h->lock);
+
+        // CPU time of the step, which excludes time spent preempted when there are more threads than cores
+        double start = platform_utils_get_thread_cpu_time();
+        int release = handover_run_task(h, task, ctx);
+        double elapsed = platform_utils_get_thread_cpu_time() - start;
+
+        pthread_mutex_lock(&h->lock);
+        h->num_running--;
+        h->total_work += elapsed;
+        double path = task->ready_path + elapsed;
+        if (path > h->critical_path) {
+            h->critical_path = path;
+        }
+        for (int k=0; k<task->num_succs && release; k++) {
+            handover_task *succ = &h->tasks[task->succs[k]];
+            if (succ->num_deps == 0) { // quorum already reached
+                continue;
+            }
+            if (succ->step == HANDOVER_QUORUM) {
+                h->res->valid_indices[h->num_valid++] = task->index + 1;
+            }
+            if (path > succ->ready_path) {
+                succ->ready_path = path;
+            }
+            if (--succ->num_deps == 0) {
+                h->queue[h->queue_tail++] = task->succs[k];
+            }
+        }
+        pthread_cond_broadcast(&h->cond);
+    }
+    pthread_cond_broadcast(&h->cond);
+    pthread_mutex_unlock(&h->lock);
+}
+
+int dh_pvss_handover_run(const dh_pvss_handover_input *in, int num_threads, dh_pvss_handover_result *res) {
+    const int n = in->pp->n;
+    const int t = in->pp->t;
+    const int next_n = in->next_pp->n;
+    const int next_t = in->next_pp->t;
+    assert(num_threads > 0 && "dh_pvss_handover_run: usage error, num_threads must be positive");
+
+    res->next_n = next_n;
+    res->valid_indices = calloc(t + 1, sizeof(int));
+    res->reconstructed_shares = calloc(next_n, sizeof(EC_POINT *));
+    assert(res->valid_indices && res->reconstructed_shares && "dh_pvss_handover_run: allocation error (result)");
+    res->next_dist_key = NULL;
+    res->secret = NULL;
+
+    handover h;
+    h.in = in;
+    h.res = res;
+    h.next_committee_keys = malloc(next_n * sizeof(EC_POINT *));
+    h.enc_re_shares = malloc(n * sizeof(EC_POINT **));
+    h.pis = malloc(n * sizeof(nizk_reshare_proof));
+    h.proved = calloc(n, sizeof(int));
+    h.decrypted_shares = calloc(next_t + 1, sizeof(EC_POINT *));
+    assert(h.next_committee_keys && h.enc_re_shares && h.pis && h.proved && h.decrypted_shares && "dh_pvss_handover_run: allocation error (state)");
+    for (int j=0; j<next_n; j++) {
+        h.next_committee_keys[j] = in->next_committee_key_pairs[j].pub;
+    }
+    for (int i=0; i<n; i++) {
+        h.enc_re_shares[i] = malloc(next_n * sizeof(EC_POINT *));
+        assert(h.enc_re_shares[i] && "dh_pvss_handover_run: allocation error (re-shares)");
+    }
+    h.lambdas = NULL;
+    h.num_valid = 0;
+
+    // dependency graph
+    const int epoch_task = 0;
+    const int prove_tasks = 1;
+    const int verify_tasks = prove_tasks + n;
+    const int quorum_task = verify_tasks + n;
+    const int slice_tasks = quorum_task + 1;
+    const int dist_key_task = slice_tasks + next_n;
+    const int decrypt_tasks = dist_key_task + 1;
+    const int secret_task = decrypt_tasks + next_t + 1;
+    h.num_tasks = secret_task + 1;
+    h.tasks = calloc(h.num_tasks, sizeof(handover_task));
+    h.queue = malloc(h.num_tasks * sizeof(int));
+    assert(h.tasks && h.queue && "dh_pvss_handover_run: allocation error (tasks)");
+    h.tasks[epoch_task] = (handover_task){ HANDOVER_EPOCH, 0, 0, 0, NULL, 0 };
+    for (int i=0; i<n; i++) {
+        h.tasks[prove_tasks + i] = (handover_task){ HANDOVER_PROVE, i, 1, 0, NULL, 0 };
+        h.tasks[verify_tasks + i] = (handover_task){ HANDOVER_VERIFY, i, 1, 0, NULL, 0 };
+        handover_add_succ(&h, epoch_task, prove_tasks + i);
+        handover_add_succ(&h, prove_tasks + i, verify_tasks + i);
+        handover_add_succ(&h, verify_tasks + i, quorum_task); // released only by valid reshares
+    }
+    h.tasks[quorum_task] = (handover_task){ HANDOVER_QUORUM, 0, t + 1, 0, NULL, 0 };
+    for (int j=0; j<next_n; j++) {
+        h.tasks[slice_tasks + j] = (handover_task){ HANDOVER_SLICE, j, 1, 0, NULL, 0 };
+        handover_add_succ(&h, quorum_task, slice_tasks + j);
+    }
+    h.tasks[dist_key_task] = (handover_task){ HANDOVER_DIST_KEY, 0, 1, 0, NULL, 0 };
+    handover_add_succ(&h, quorum_task, dist_key_task);
+    for (int j=0; j<next_t+1; j++) {
+        h.tasks[decrypt_tasks + j] = (handover_task){ HANDOVER_DECRYPT, j, 2, 0, NULL, 0 };
+        handover_add_succ(&h, slice_tasks + j, decrypt_tasks + j);
+        handover_add_succ(&h, dist_key_task, decrypt_tasks + j);
+        handover_add_succ(&h, decrypt_tasks + j, secret_task);
+    }
+    h.tasks[secret_task] = (handover_task){ HANDOVER_SECRET, 0, next_t + 1, 0, NULL, 0 };
+
+    // run
+    int ret = pthread_mutex_init(&h.lock, NULL);
+    assert(ret == 0 && "dh_pvss_handover_run: pthread_mutex_init failed");
+    ret = pthread_cond_init(&h.cond, NULL);
+    assert(ret == 0 && "dh_pvss_handover_run: pthread_cond_init failed");
+    h.queue[0] = epoch_task;
+    h.queue_head = 0;
+    h.queue_tail = 1;
+    h.num_running = 0;
+    h.critical_path = 0;
+    h.total_work = 0;
+    platform_time_type start = platform_utils_get_wall_time();
+    parallel_for(num_threads, num_threads, handover_worker, &h, in->pp->bn_ctx);
+    res->timing.wall_time = platform_utils_get_wall_time_diff(start, platform_utils_get_wall_time());
+    res->timing.critical_path = h.critical_path;
+    res->timing.total_work = h.total_work;
+    ret = res->secret ? 0 : 1;
+
+    // cleanup
+    pthread_cond_destroy(&h.cond);
+    pthread_mutex_destroy(&h.lock);
+    for (int i=0; i<h.num_tasks; i++) {
+        free(h.tasks[i].succs);
+    }
+    free(h.tasks);
+    free(h.queue);
+    for (int j=0; j<next_t+1; j++) {
+        if (h.decrypted_shares[j]) {
+            point_free(h.decrypted_shares[j]);
+        }
+    }
+    free(h.decrypted_shares);
+    if (h.lambdas) {
+        bn_free_array(t + 1, h.lambdas);
+    }
+    for (int i=0; i<n; i++) {
+        if (h.proved[i]) {
+            for (int j=0; j<next_n; j++) {
+                point_free(h.enc_re_shares[i][j]);
+            }
+            nizk_reshare_proof_free(&h.pis[i]);
+        }
+        free(h.enc_re_shares[i]);
+    }
+    free(h.enc_re_shares);
+    free(h.pis);
+    free(h.proved);
+    dh_pvss_reshare_epoch_ctx_free(&h.epoch);
+    free(h.next_committee_keys);
+
+    return ret;
+}
+
+void dh_pvss_handover_result_free(dh_pvss_handover_result *res) {
+    for (int j=0; j<res->next_n; j++) {
+        if (res->reconstructed_shares[j]) {
+            point_free(res->reconstructed_shares[j]);
+        }
+    }
+    free(res->reconstructed_shares);
+    free(res->valid_indices);
+    if (res->next_dist_key) {
+        point_free(res->next_dist_key);
+    }
+    if (res->secret) {
+        point_free(res->secret);
+    }
+}
+
+/*
+ *
+ *  dh_pvss_handover tests
+ *
+ */
+static int dh_pvss_handover_test_1(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+
+    // setup
+    const int t = 4;
+    const int n = 10;
+    const int next_t = 5;
+    const int next_n = 12;
+    dh_pvss_ctx pp;
+    dh_pvss_ctx next_pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+    dh_pvss_setup(&next_pp, group, next_t, next_n, ctx);
+    EC_POINT *secret = point_random(group, ctx);
+
+    // keygen
+    dh_key_pair first_dist_kp;
+    dh_key_pair_generate(group, &first_dist_kp, ctx);
+    dh_key_pair committee_key_pairs[n];
+    dh_key_pair dist_key_pairs[n];
+    EC_POINT *committee_public_keys[n];
+    EC_POINT *dist_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &committee_key_pairs[i], ctx);
+        dh_key_pair_generate(group, &dist_key_pairs[i], ctx);
+        committee_public_keys[i] = committee_key_pairs[i].pub;
+        dist_public_keys[i] = dist_key_pairs[i].pub;
+    }
+    dh_key_pair next_committee_key_pairs[next_n];
+    for (int j=0; j<next_n; j++) {
+        dh_key_pair_generate(group, &next_committee_key_pairs[j], ctx);
+    }
+
+    // distribute
+    EC_POINT *encrypted_shares[n];
+    nizk_dl_eq_proof pi;
+    dh_pvss_distribute_prove(&pp, encrypted_shares, &first_dist_kp, (const EC_POINT**)committee_public_keys, secret, &pi);
+    nizk_dl_eq_proof_free(&pi);
+
+    // hand over, serially and with a pool of threads
+    dh_pvss_handover_input in = { &pp, &next_pp, first_dist_kp.pub, (const EC_POINT**)encrypted_shares, committee_key_pairs, dist_key_pairs, (const EC_POINT**)dist_public_keys, next_committee_key_pairs };
+    const int num_threads[] = { 1, 4 };
+    int ret1 = 0;
+    for (int k=0; k<2; k++) {
+        dh_pvss_handover_result res;
+        int ret = dh_pvss_handover_run(&in, num_threads[k], &res);
+        ret = ret || point_cmp(group, res.secret, secret, ctx) != 0 || res.timing.critical_path > res.timing.total_work;
+        if (print) {
+            printf("%6s Test 1 - %d: Pipelined handover with %d thread(s) %s the secret (wall %.3f s, critical path %.3f s, work %.3f s)\n", ret ? "NOT OK" : "OK", k+1, num_threads[k], ret ? "DID NOT RECOVER" : "recovered", res.timing.wall_time, res.timing.critical_path, res.timing.total_work);
+        }
+        ret1 |= ret;
+        dh_pvss_handover_result_free(&res);
+    }
+
+    // parties publishing wrong distribution keys are left out
+    const int num_bad = n - t - 1;
+    for (int i=0; i<num_bad; i++) {
+        dist_public_keys[2*i] = committee_public_keys[2*i];
+    }
+    dh_pvss_handover_result res;
+    int ret2 = dh_pvss_handover_run(&in, 3, &res);
+    ret2 = ret2 || point_cmp(group, res.secret, secret, ctx) != 0;
+    for (int k=0; k<t+1; k++) {
+        int party = res.valid_indices[k] - 1;
+        ret2 |= party % 2 == 0 && party < 2*num_bad;
+    }
+    if (print) {
+        printf("%6s Test 1 - 3: Pipelined handover with %d bad parties %s the secret\n", ret2 ? "NOT OK" : "OK", num_bad, ret2 ? "DID NOT RECOVER" : "recovered");
+    }
+    dh_pvss_handover_result_free(&res);
+
+    // one more bad party, no quorum
+    dist_public_keys[1] = committee_public_keys[1];
+    int ret3 = dh_pvss_handover_run(&in, 3, &res) == 0;
+    if (print) {
+        printf("%6s Test 1 - 4: Pipelined handover with %d bad parties %s\n", ret3 ? "NOT OK" : "OK", num_bad + 1, ret3 ? "IS completed (which is an ERROR)" : "not completed (which is CORRECT)");
+    }
+    dh_pvss_handover_result_free(&res);
+
+    // cleanup
+    for (int i=0; i<n; i++) {
+        point_free(encrypted_shares[i]);
+        dh_key_pair_free(&committee_key_pairs[i]);
+        dh_key_pair_free(&dist_key_pairs[i]);
+    }
+    for (int j=0; j<next_n; j++) {
+        dh_key_pair_free(&next_committee_key_pairs[j]);
+    }
+    dh_key_pair_free(&first_dist_kp);
+    point_free(secret);
+    dh_pvss_ctx_free(&next_pp);
+    dh_pvss_ctx_free(&pp);
+    BN_CTX_free(ctx);
+
+    return ret1 || ret2 || ret3;
+}
+
+typedef int (*test_function)(int);
+
+static test_function test_suite[] = {
+    &dh_pvss_handover_test_1
+};
+
+// return test results
+//   0 = passed (all individual tests passed)
+//   1 = failed (one or more individual tests failed)
+// setting print to 0 (zero) suppresses stdio printouts, while print 1 is 'verbose'
+int dh_pvss_handover_test_suite(int print) {
+    if (print) {
+        printf("DH PVSS handover test suite BEGIN -------------------\n");
+    }
+    int num_tests = sizeof(test_suite)/sizeof(test_function);
+    int ret = 0;
+    for (int i=0; i<num_tests; i++) {
+        if (test_suite[i](print)) {
+            ret = 1;
+        }
+    }
+    if (print) {
+        printf("DH PVSS handover test suite END ---------------------\n");
+#ifdef DEBUG
+        print_allocation_status();
+#endif
+        fflush(stdout);
+    }
+    return ret;
+}
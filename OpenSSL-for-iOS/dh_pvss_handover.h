@@ -0,0 +1,49 @@
+//
+//  dh_pvss_handover.h
+//  OpenSSL-for-iOS
+//
+
+#ifndef DH_PVSS_HANDOVER_H
+#define DH_PVSS_HANDOVER_H
+#include "dh_pvss.h"
+
+/* pipelined epoch handover, simulating all parties of both committees in one process
+ * the steps of a handover (reshare proofs, reshare verification, slice reconstruction, distribution key
+ * recomputation, decryption and reconstruction) form a dependency graph over parties and slices, which is run
+ * on a pool of threads, so that steps overlap, e.g., the reshare of one party is verified while the reshare of another
+ * is still being produced, and slices are reconstructed as soon as t+1 reshares have been verified */
+
+typedef struct {
+    const dh_pvss_ctx *pp; // current committee
+    const dh_pvss_ctx *next_pp; // next committee
+    const EC_POINT *previous_dist_key;
+    const EC_POINT **current_enc_shares;
+    const dh_key_pair *committee_key_pairs; // pp->n
+    const dh_key_pair *dist_key_pairs; // pp->n, used to reshare
+    const EC_POINT **dist_pub_keys; // pp->n, published distribution keys, against which reshares are verified
+    dh_key_pair *next_committee_key_pairs; // next_pp->n, the first next_pp->t+1 members decrypt
+} dh_pvss_handover_input;
+
+typedef struct {
+    double wall_time;
+    double critical_path; // longest chain of dependent steps, i.e., the latency with unlimited threads and cores
+    double total_work; // sum of the times of all steps
+    // step times are CPU times of the threads running them, so the last two do not depend on the number of threads
+} dh_pvss_handover_timing;
+
+typedef struct {
+    int next_n;
+    int *valid_indices; // pp->t+1 parties whose reshares were reconstructed, as indices starting from 1
+    EC_POINT **reconstructed_shares; // next_n encrypted shares of the next committee
+    EC_POINT *next_dist_key;
+    EC_POINT *secret; // as reconstructed by the next committee
+    dh_pvss_handover_timing timing;
+} dh_pvss_handover_result;
+
+// returns 0 on success, and 1 if the handover could not be completed (e.g., fewer than t+1 valid reshares)
+int dh_pvss_handover_run(const dh_pvss_handover_input *in, int num_threads, dh_pvss_handover_result *res);
+void dh_pvss_handover_result_free(dh_pvss_handover_result *res);
+
+int dh_pvss_handover_test_suite(int print);
+
+#endif /* DH_PVSS_HANDOVER_H */
@@ -0,0 +1,329 @@
+//
+//  dh_pvss_registry.c
+//  OpenSSL-for-iOS
+//
+#include "dh_pvss_registry.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "openssl_hashing_tools.h"
+#include "dh_pvss_wire.h"
+
+/* keys and encodings are kept in arrays that grow by doubling, and are looked up by encoding in an open addressing
+ * hash table of registry ids (the x-coordinate of a key is as good as random, so its leading bytes are the hash) */
+struct dh_pvss_key_registry {
+    const EC_GROUP *group;
+    size_t encoding_len;
+    int size;
+    int capacity;
+    EC_POINT **keys;
+    unsigned char *encodings;
+    int num_slots; // power of two, at least twice the capacity
+    int *slots; // registry id, or -1 if empty
+};
+
+dh_pvss_key_registry *dh_pvss_key_registry_new(const EC_GROUP *group) {
+    dh_pvss_key_registry *reg = malloc(sizeof(dh_pvss_key_registry));
+    assert(reg && "dh_pvss_key_registry_new: allocation error (registry)");
+    reg->group = group;
+    reg->encoding_len = openssl_point_encoding_len(group);
+    reg->size = 0;
+    reg->capacity = 0;
+    reg->keys = NULL;
+    reg->encodings = NULL;
+    reg->num_slots = 0;
+    reg->slots = NULL;
+    return reg;
+}
+
+void dh_pvss_key_registry_free(dh_pvss_key_registry *reg) {
+    for (int i=0; i<reg->size; i++) {
+        point_free(reg->keys[i]);
+    }
+    free(reg->keys);
+    free(reg->encodings);
+    free(reg->slots);
+    free(reg);
+}
+
+int dh_pvss_key_registry_size(const dh_pvss_key_registry *reg) {
+    return reg->size;
+}
+
+static unsigned long registry_hash(const unsigned char *encoding) {
+    unsigned long h = 0;
+    for (int i=1; i<=8; i++) { // skip the prefix byte
+        h = (h << 8) | encoding[i];
+    }
+    return h;
+}
+
+// slot holding the id of encoding, or else the empty slot where it belongs
+static int registry_slot(const dh_pvss_key_registry *reg, const unsigned char *encoding) {
+    const int mask = reg->num_slots - 1;
+    int s = (int)(registry_hash(encoding) & mask);
+    while (reg->slots[s] >= 0 && memcmp(reg->encodings + (size_t)reg->slots[s] * reg->encoding_len, encoding, reg->encoding_len) != 0) {
+        s = (s + 1) & mask;
+    }
+    return s;
+}
+
+// make room for num_keys more keys
+static void registry_reserve(dh_pvss_key_registry *reg, int num_keys) {
+    if (reg->size + num_keys <= reg->capacity) {
+        return;
+    }
+    int capacity = reg->capacity ? reg->capacity : 16;
+    while (capacity < reg->size + num_keys) {
+        capacity *= 2;
+    }
+    reg->keys = realloc(reg->keys, capacity * sizeof(EC_POINT *));
+    reg->encodings = realloc(reg->encodings, (size_t)capacity * reg->encoding_len);
+    assert(reg->keys && reg->encodings && "registry_reserve: allocation error (keys)");
+    reg->capacity = capacity;
+
+    // rehash
+    free(reg->slots);
+    reg->num_slots = 2 * capacity;
+    reg->slots = malloc(reg->num_slots * sizeof(int));
+    assert(reg->slots && "registry_reserve: allocation error (slots)");
+    memset(reg->slots, -1, reg->num_slots * sizeof(int));
+    for (int i=0; i<reg->size; i++) {
+        reg->slots[registry_slot(reg, reg->encodings + (size_t)i * reg->encoding_len)] = i;
+    }
+}
+
+/* the proofs are checked first, then the keys that pass are made affine together, sharing one field inversion,
+ * which also makes encoding them cheap */
+int dh_pvss_key_registry_add(dh_pvss_key_registry *reg, int num_keys, const EC_POINT *pub_keys[], const nizk_dl_proof *pi[], int *ids, BN_CTX *ctx) {
+    const EC_GROUP *group = reg->group;
+    if (num_keys <= 0) {
+        return 0;
+    }
+
+    // check the keys, then their proofs in one batch (bisected only if some proof fails)
+    const EC_POINT **checked_keys = malloc(num_keys * sizeof(EC_POINT *));
+    const nizk_dl_proof **checked_proofs = malloc(num_keys * sizeof(nizk_dl_proof *));
+    int *checked_index = malloc(num_keys * sizeof(int));
+    int *results = malloc(num_keys * sizeof(int));
+    assert(checked_keys && checked_proofs && checked_index && results && "dh_pvss_key_registry_add: allocation error (checks)");
+    int num_checked = 0;
+    for (int i=0; i<num_keys; i++) {
+        ids[i] = -1;
+        if (EC_POINT_is_at_infinity(group, pub_keys[i]) || dh_pvss_wire_check_subgroup(group, 1, &pub_keys[i], ctx)) {
+            continue;
+        }
+        checked_keys[num_checked] = pub_keys[i];
+        checked_proofs[num_checked] = pi[i];
+        checked_index[num_checked++] = i;
+    }
+    if (num_checked > 0) {
+        nizk_dl_verify_batch(group, num_checked, checked_keys, checked_proofs, results, ctx);
+    }
+    EC_POINT **fresh = malloc(num_keys * sizeof(EC_POINT *));
+    assert(fresh && "dh_pvss_key_registry_add: allocation error (keys)");
+    int num_fresh = 0;
+    for (int k=0; k<num_checked; k++) {
+        if (results[k]) {
+            continue;
+        }
+        fresh[num_fresh] = point_new(group);
+        EC_POINT_copy(fresh[num_fresh++], checked_keys[k]);
+        ids[checked_index[k]] = 0; // passed, id assigned below
+    }
+    free(results);
+    free(checked_index);
+    free(checked_proofs);
+    free(checked_keys);
+    if (num_fresh > 0) {
+        int ret = EC_POINTs_make_affine(group, num_fresh, fresh, ctx);
+        assert(ret == 1 && "dh_pvss_key_registry_add: EC_POINTs_make_affine failed");
+    }
+
+    // admit the keys that are not already registered
+    registry_reserve(reg, num_fresh);
+    int all_admitted = num_fresh == num_keys;
+    for (int i=0, f=0; i<num_keys; i++) {
+        if (ids[i] < 0) {
+            continue;
+        }
+        EC_POINT *key = fresh[f++];
+        unsigned char *encoding = reg->encodings + (size_t)reg->size * reg->encoding_len;
+        openssl_point_encode(group, key, encoding, ctx);
+        int s = registry_slot(reg, encoding);
+        if (reg->slots[s] >= 0) { // duplicate
+            point_free(key);
+            ids[i] = -1;
+            all_admitted = 0;
+            continue;
+        }
+        reg->slots[s] = reg->size;
+        reg->keys[reg->size] = key;
+        ids[i] = reg->size++;
+    }
+
+    // cleanup
+    free(fresh);
+
+    return !all_admitted;
+}
+
+int dh_pvss_key_registry_find(const dh_pvss_key_registry *reg, const EC_POINT *pub_key, BN_CTX *ctx) {
+    if (reg->size == 0 || EC_POINT_is_at_infinity(reg->group, pub_key)) {
+        return -1;
+    }
+    unsigned char encoding[reg->encoding_len];
+    openssl_point_encode(reg->group, pub_key, encoding, ctx);
+    return reg->slots[registry_slot(reg, encoding)];
+}
+
+const EC_POINT *dh_pvss_key_registry_get0_key(const dh_pvss_key_registry *reg, int id) {
+    assert(id >= 0 && id < reg->size && "dh_pvss_key_registry_get0_key: usage error, id not in registry");
+    return reg->keys[id];
+}
+
+const unsigned char *dh_pvss_key_registry_get0_encoding(const dh_pvss_key_registry *reg, int id) {
+    assert(id >= 0 && id < reg->size && "dh_pvss_key_registry_get0_encoding: usage error, id not in registry");
+    return reg->encodings + (size_t)id * reg->encoding_len;
+}
+
+int dh_pvss_committee_init(dh_pvss_committee *com, const dh_pvss_key_registry *reg, int n, const int ids[]) {
+    for (int i=0; i<n; i++) {
+        if (ids[i] < 0 || ids[i] >= reg->size) {
+            return 1;
+        }
+    }
+    com->n = n;
+    com->keys = malloc(n * sizeof(EC_POINT *));
+    assert(com->keys && "dh_pvss_committee_init: allocation error (keys)");
+
+    // the digest hashes the encodings in committee order, as openssl_hash_point_list2bn would
+    SHA256_CTX sha_ctx;
+    openssl_hash_init(&sha_ctx);
+    for (int i=0; i<n; i++) {
+        com->keys[i] = reg->keys[ids[i]];
+        openssl_hash_update_encoded_points(&sha_ctx, reg->encoding_len, 1, dh_pvss_key_registry_get0_encoding(reg, ids[i]));
+    }
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    openssl_hash_final(hash, &sha_ctx);
+    com->digest = openssl_hash2bignum(hash);
+
+    return 0;
+}
+
+void dh_pvss_committee_free(dh_pvss_committee *com) {
+    free(com->keys);
+    com->keys = NULL;
+    bn_free(com->digest);
+    com->digest = NULL;
+}
+
+/*
+ *
+ *  dh_pvss_registry tests
+ *
+ */
+static int dh_pvss_registry_test_1(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+    const int num_keys = 40;
+    const int bad_proof = 7;
+    const int duplicate = 23;
+
+    // keys with proofs, one of them with the proof of another key, and one of them twice
+    dh_key_pair kps[num_keys];
+    nizk_dl_proof proofs[num_keys];
+    const EC_POINT *pub_keys[num_keys];
+    const nizk_dl_proof *pis[num_keys];
+    for (int i=0; i<num_keys; i++) {
+        dh_key_pair_generate(group, &kps[i], ctx);
+        dh_key_pair_prove(group, &kps[i], &proofs[i], ctx);
+        pub_keys[i] = kps[i].pub;
+        pis[i] = &proofs[i];
+    }
+    pis[bad_proof] = &proofs[bad_proof + 1];
+    pub_keys[duplicate] = kps[3].pub;
+    pis[duplicate] = &proofs[3];
+
+    // admit in two rounds, since the registry grows
+    dh_pvss_key_registry *reg = dh_pvss_key_registry_new(group);
+    int ids[num_keys];
+    int ret1 = dh_pvss_key_registry_add(reg, num_keys / 2, pub_keys, pis, ids, ctx);
+    ret1 &= dh_pvss_key_registry_add(reg, num_keys - num_keys / 2, pub_keys + num_keys / 2, pis + num_keys / 2, ids + num_keys / 2, ctx);
+    int num_misjudged = !ret1 || dh_pvss_key_registry_size(reg) != num_keys - 2;
+    for (int i=0; i<num_keys; i++) {
+        int rejected = i == bad_proof || i == duplicate;
+        num_misjudged += rejected != (ids[i] < 0);
+        if (!rejected) {
+            num_misjudged += dh_pvss_key_registry_find(reg, pub_keys[i], ctx) != ids[i];
+            num_misjudged += point_cmp(group, dh_pvss_key_registry_get0_key(reg, ids[i]), pub_keys[i], ctx) != 0;
+        }
+    }
+    num_misjudged += dh_pvss_key_registry_find(reg, kps[bad_proof].pub, ctx) != -1;
+    if (print) {
+        printf("%6s Test 1 - 1: Keys with valid proofs %s admitted once, and the others %s\n", num_misjudged ? "NOT OK" : "OK", num_misjudged ? "NOT" : "indeed", num_misjudged ? "maybe admitted" : "not admitted");
+    }
+
+    // the committee digest is the one hashed from its keys
+    const int n = 10;
+    int committee_ids[n];
+    const EC_POINT *committee_keys[n];
+    for (int i=0; i<n; i++) {
+        committee_ids[i] = ids[num_keys - 2 - 2*i]; // even positions, all admitted
+        committee_keys[i] = pub_keys[num_keys - 2 - 2*i];
+    }
+    dh_pvss_committee com;
+    int ret2 = dh_pvss_committee_init(&com, reg, n, committee_ids);
+    if (ret2 == 0) {
+        BIGNUM *digest = openssl_hash_point_list2bn(group, ctx, n, committee_keys);
+        ret2 = BN_cmp(digest, com.digest) != 0;
+        bn_free(digest);
+        dh_pvss_committee_free(&com);
+    }
+    int bad_ids[] = { 0, dh_pvss_key_registry_size(reg) };
+    ret2 |= dh_pvss_committee_init(&com, reg, 2, bad_ids) == 0;
+    if (print) {
+        printf("%6s Test 1 - 2: Committee digest %s\n", ret2 ? "NOT OK" : "OK", ret2 ? "DIFFERS FROM hashed keys" : "equals hashed keys");
+    }
+
+    // cleanup
+    dh_pvss_key_registry_free(reg);
+    for (int i=0; i<num_keys; i++) {
+        nizk_dl_proof_free(&proofs[i]);
+        dh_key_pair_free(&kps[i]);
+    }
+    BN_CTX_free(ctx);
+
+    return num_misjudged != 0 || ret2;
+}
+
+typedef int (*test_function)(int);
+
+static test_function test_suite[] = {
+    &dh_pvss_registry_test_1
+};
+
+// return test results
+//   0 = passed (all individual tests passed)
+//   1 = failed (one or more individual tests failed)
+// setting print to 0 (zero) suppresses stdio printouts, while print 1 is 'verbose'
+int dh_pvss_registry_test_suite(int print) {
+    if (print) {
+        printf("DH PVSS registry test suite BEGIN -------------------\n");
+    }
+    int num_tests = sizeof(test_suite)/sizeof(test_function);
+    int ret = 0;
+    for (int i=0; i<num_tests; i++) {
+        if (test_suite[i](print)) {
+            ret = 1;
+        }
+    }
+    if (print) {
+        printf("DH PVSS registry test suite END ---------------------\n");
+#ifdef DEBUG
+        print_allocation_status();
+#endif
+        fflush(stdout);
+    }
+    return ret;
+}
@@ -0,0 +1,49 @@
+//
+//  dh_pvss_registry.h
+//  OpenSSL-for-iOS
+//
+
+#ifndef DH_PVSS_REGISTRY_H
+#define DH_PVSS_REGISTRY_H
+#include "dh_key_pair.h"
+
+/* registry of committee public keys, which live for many epochs
+ * a key is admitted only with a valid proof of possession (see dh_key_pair_prove), the proofs of the keys added
+ * together being checked in one batch (see nizk_dl_verify_batch), and is kept in affine form
+ * together with its canonical (compressed) encoding, so that neither is recomputed when the key is used later
+ * no per-key fixed-base tables are built: the public EC API only keeps precomputation for the generator, and a table
+ * per key would take far more memory than the key itself
+ * keys are identified by their registry id, 0, 1, ... in order of admission
+ * adding keys is not thread safe, but the registry may be read from several threads once populated */
+typedef struct dh_pvss_key_registry dh_pvss_key_registry;
+
+dh_pvss_key_registry *dh_pvss_key_registry_new(const EC_GROUP *group);
+void dh_pvss_key_registry_free(dh_pvss_key_registry *reg);
+
+// admit num_keys keys, ids[i] is set to the registry id of pub_keys[i], or to -1 if the key is rejected
+// (invalid proof, point at infinity or not in the subgroup, or already registered)
+// returns 0 if all keys were admitted, and 1 otherwise
+int dh_pvss_key_registry_add(dh_pvss_key_registry *reg, int num_keys, const EC_POINT *pub_keys[], const nizk_dl_proof *pi[], int *ids, BN_CTX *ctx);
+int dh_pvss_key_registry_size(const dh_pvss_key_registry *reg);
+// registry id of pub_key, or -1 if not registered
+int dh_pvss_key_registry_find(const dh_pvss_key_registry *reg, const EC_POINT *pub_key, BN_CTX *ctx);
+const EC_POINT *dh_pvss_key_registry_get0_key(const dh_pvss_key_registry *reg, int id);
+const unsigned char *dh_pvss_key_registry_get0_encoding(const dh_pvss_key_registry *reg, int id);
+
+/* a committee of registered keys, in committee order, with the digest of its keys as hashed into the scrape
+ * polynomial of a distribution (see dh_pvss_distribute_prove_committee), computed once from the stored encodings
+ * keys may be passed wherever committee keys are expected, e.g., to the reshare functions
+ * the keys are borrowed from the registry, which must outlive the committee */
+typedef struct {
+    int n;
+    const EC_POINT **keys;
+    BIGNUM *digest;
+} dh_pvss_committee;
+
+// returns 0 on success, and 1 if an id is not in the registry (in which case nothing is allocated)
+int dh_pvss_committee_init(dh_pvss_committee *com, const dh_pvss_key_registry *reg, int n, const int ids[]);
+void dh_pvss_committee_free(dh_pvss_committee *com);
+
+int dh_pvss_registry_test_suite(int print);
+
+#endif /* DH_PVSS_REGISTRY_H */
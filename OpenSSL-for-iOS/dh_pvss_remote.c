@@ -0,0 +1,620 @@
+//
+//  dh_pvss_remote.c
+//  OpenSSL-for-iOS
+//
+#include "dh_pvss_remote.h"
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "dh_pvss_wire.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // not available on Apple platforms, where the caller has to ignore SIGPIPE instead
+#endif
+
+#define DH_PVSS_REMOTE_QUIT 0
+#define DH_PVSS_REMOTE_DISTRIBUTION 1
+#define DH_PVSS_REMOTE_RESHARE 2
+#define DH_PVSS_REMOTE_HEADER_LEN 16
+#define DH_PVSS_REMOTE_MAX_PATH 4096
+
+static void remote_put32(unsigned char *buf, int value) {
+    buf[0] = (unsigned char)(value >> 24);
+    buf[1] = (unsigned char)(value >> 16);
+    buf[2] = (unsigned char)(value >> 8);
+    buf[3] = (unsigned char)value;
+}
+
+static int remote_get32(const unsigned char *buf) {
+    return (int)(((unsigned long)buf[0] << 24) | ((unsigned long)buf[1] << 16) | ((unsigned long)buf[2] << 8) | buf[3]);
+}
+
+// returns 0 when all of buf is sent, and 1 on error
+static int remote_send(int fd, const void *buf, size_t len) {
+    const unsigned char *p = buf;
+    while (len > 0) {
+        ssize_t num = send(fd, p, len, MSG_NOSIGNAL);
+        if (num < 0 && errno == EINTR) {
+            continue;
+        }
+        if (num <= 0) {
+            return 1;
+        }
+        p += num;
+        len -= num;
+    }
+    return 0;
+}
+
+// returns 0 when all of buf is received, and 1 on error or if the connection is closed
+static int remote_recv(int fd, void *buf, size_t len) {
+    unsigned char *p = buf;
+    while (len > 0) {
+        ssize_t num = recv(fd, p, len, 0);
+        if (num < 0 && errno == EINTR) {
+            continue;
+        }
+        if (num <= 0) {
+            return 1;
+        }
+        p += num;
+        len -= num;
+    }
+    return 0;
+}
+
+// memory map a transcript file read only, returns NULL if it cannot be read
+static const unsigned char *remote_map(const char *path, size_t *len) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    *len = (size_t)st.st_size;
+    void *transcript = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid
+    return transcript == MAP_FAILED ? NULL : transcript;
+}
+
+static int remote_send_request(const EC_GROUP *group, int fd, int type, int from, int to, const char *path, int num_coeffs, const BIGNUM *coeffs[]) {
+    const size_t path_len = path ? strlen(path) : 0;
+    const size_t scalar_len = dh_pvss_wire_scalar_len(group);
+    const size_t len = DH_PVSS_REMOTE_HEADER_LEN + path_len + (coeffs ? 4 + (size_t)num_coeffs * scalar_len : 0);
+    unsigned char *buf = malloc(len);
+    assert(buf && "remote_send_request: allocation error (request)");
+    remote_put32(buf, type);
+    remote_put32(buf + 4, from);
+    remote_put32(buf + 8, to);
+    remote_put32(buf + 12, (int)path_len);
+    unsigned char *p = buf + DH_PVSS_REMOTE_HEADER_LEN;
+    memcpy(p, path, path_len);
+    p += path_len;
+    if (coeffs) {
+        remote_put32(p, num_coeffs);
+        p += 4;
+        for (int i=0; i<num_coeffs; i++, p += scalar_len) {
+            dh_pvss_wire_encode_scalar(group, p, coeffs[i]);
+        }
+    }
+    int ret = remote_send(fd, buf, len);
+    free(buf);
+    return ret;
+}
+
+void dh_pvss_remote_quit(int fd) {
+    unsigned char buf[DH_PVSS_REMOTE_HEADER_LEN] = { 0 }; // DH_PVSS_REMOTE_QUIT
+    remote_send(fd, buf, sizeof(buf));
+}
+
+// partial sums of U and V over users from+1..to, answered as status | U | V
+static int remote_serve_distribution(const dh_pvss_remote_worker *w, int fd, const char *path, int from, int to) {
+    dh_pvss_ctx *pp = w->pp;
+    const EC_GROUP *group = pp->group;
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    const size_t scalar_len = dh_pvss_wire_scalar_len(group);
+    const int num_poly_coeffs = pp->n - pp->t - 1;
+
+    // scrape polynomial
+    unsigned char count[4];
+    if (remote_recv(fd, count, 4) || remote_get32(count) != num_poly_coeffs) {
+        return 1;
+    }
+    unsigned char *encoded_coeffs = malloc((size_t)num_poly_coeffs * scalar_len);
+    assert(encoded_coeffs && "remote_serve_distribution: allocation error (polynomial)");
+    if (remote_recv(fd, encoded_coeffs, (size_t)num_poly_coeffs * scalar_len)) {
+        free(encoded_coeffs);
+        return 1;
+    }
+    BIGNUM **poly_coeffs = calloc(num_poly_coeffs, sizeof(BIGNUM *));
+    assert(poly_coeffs && "remote_serve_distribution: allocation error (polynomial)");
+    int failed = 0;
+    for (int i=0; i<num_poly_coeffs && !failed; i++) {
+        poly_coeffs[i] = dh_pvss_wire_decode_scalar(group, encoded_coeffs + (size_t)i * scalar_len);
+        failed = poly_coeffs[i] == NULL;
+    }
+    free(encoded_coeffs);
+
+    // partial sums
+    EC_POINT *sums[2] = { point_new(group), point_new(group) };
+    size_t len = 0;
+    const unsigned char *transcript = failed ? NULL : remote_map(path, &len);
+    failed = !transcript || from < 0 || from > to || to > pp->n;
+    if (!failed) {
+        failed = dh_pvss_distribute_encoded_partial_sums(pp, transcript, len, w->com_keys, (const BIGNUM **)poly_coeffs, from, to, sums[0], sums[1]);
+    }
+    if (transcript) {
+        munmap((void *)transcript, len);
+    }
+
+    // answer
+    unsigned char response[1 + 2 * point_len];
+    response[0] = (unsigned char)failed;
+    dh_pvss_wire_encode_points(group, response + 1, 2, (const EC_POINT **)sums, pp->bn_ctx);
+    int ret = remote_send(fd, response, sizeof(response));
+
+    // cleanup
+    point_free(sums[0]);
+    point_free(sums[1]);
+    for (int i=0; i<num_poly_coeffs; i++) {
+        if (poly_coeffs[i]) {
+            bn_free(poly_coeffs[i]);
+        }
+    }
+    free(poly_coeffs);
+
+    return ret;
+}
+
+// verdicts of reshares from..to-1 of the file, answered as status | verdicts
+static int remote_serve_reshare(const dh_pvss_remote_worker *w, int fd, const char *path, int from, int to) {
+    const dh_pvss_reshare_epoch_ctx *epoch = w->epoch;
+    const EC_GROUP *group = w->pp->group;
+    BN_CTX *ctx = w->pp->bn_ctx;
+
+    size_t len = 0;
+    const unsigned char *transcripts = epoch && from >= 0 && from <= to ? remote_map(path, &len) : NULL;
+    const int next_n = epoch ? epoch->next_pp->n : 0;
+    const size_t transcript_len = epoch ? dh_pvss_wire_reshare_len(group, next_n) : 0;
+    int failed = !transcripts || len % transcript_len != 0 || (size_t)to * transcript_len > len;
+    unsigned char *response = malloc(1 + (size_t)(to > from ? to - from : 0));
+    assert(response && "remote_serve_reshare: allocation error (response)");
+    response[0] = (unsigned char)failed;
+    if (!failed) {
+        EC_POINT **enc_re_shares = malloc(next_n * sizeof(EC_POINT *));
+        assert(enc_re_shares && "remote_serve_reshare: allocation error (re-shares)");
+        for (int k=from; k<to; k++) {
+            int party_index;
+            EC_POINT *party_dist_pub_key;
+            nizk_reshare_proof pi;
+            int verdict = 1;
+            if (dh_pvss_wire_decode_reshare(group, transcripts + (size_t)k * transcript_len, transcript_len, next_n, &party_index, &party_dist_pub_key, enc_re_shares, &pi, ctx) == 0) {
+                if (party_index < epoch->current_n) {
+                    verdict = dh_pvss_reshare_verify_epoch(epoch, party_index, w->com_keys[party_index], party_dist_pub_key, (const EC_POINT **)enc_re_shares, &pi, ctx) != 0;
+                }
+                point_free(party_dist_pub_key);
+                for (int j=0; j<next_n; j++) {
+                    point_free(enc_re_shares[j]);
+                }
+                nizk_reshare_proof_free(&pi);
+            }
+            response[1 + k - from] = (unsigned char)verdict;
+        }
+        free(enc_re_shares);
+    }
+    if (transcripts) {
+        munmap((void *)transcripts, len);
+    }
+    int ret = remote_send(fd, response, failed ? 1 : 1 + (size_t)(to - from));
+    free(response);
+    return ret;
+}
+
+int dh_pvss_remote_serve(const dh_pvss_remote_worker *w, int fd) {
+    for (;;) {
+        unsigned char header[DH_PVSS_REMOTE_HEADER_LEN];
+        if (remote_recv(fd, header, sizeof(header))) {
+            return 0; // connection closed
+        }
+        const int type = remote_get32(header);
+        const int from = remote_get32(header + 4);
+        const int to = remote_get32(header + 8);
+        const int path_len = remote_get32(header + 12);
+        if (type == DH_PVSS_REMOTE_QUIT) {
+            return 0;
+        }
+        if (path_len <= 0 || path_len > DH_PVSS_REMOTE_MAX_PATH) {
+            return 1;
+        }
+        char path[path_len + 1];
+        if (remote_recv(fd, path, path_len)) {
+            return 1;
+        }
+        path[path_len] = '\0';
+        int ret = 1;
+        if (type == DH_PVSS_REMOTE_DISTRIBUTION) {
+            ret = remote_serve_distribution(w, fd, path, from, to);
+        } else if (type == DH_PVSS_REMOTE_RESHARE) {
+            ret = remote_serve_reshare(w, fd, path, from, to);
+        }
+        if (ret) {
+            return 1;
+        }
+    }
+}
+
+/* the coordinator computes the scrape polynomial (hashing the transcript is cheap next to the weighted sums),
+ * hands each worker an equal share of the users, and checks the proof against the sum of the partial sums
+ * all requests are sent before any answer is read, so the workers run concurrently */
+int dh_pvss_remote_distribute_verify(dh_pvss_ctx *pp, const char *path, const EC_POINT **com_keys, int num_workers, const int worker_fds[]) {
+    assert(num_workers > 0 && "dh_pvss_remote_distribute_verify: usage error, no workers");
+    const EC_GROUP *group = pp->group;
+    BN_CTX *ctx = pp->bn_ctx;
+    const int n = pp->n;
+    const size_t point_len = dh_pvss_wire_point_len(group);
+
+    size_t len;
+    const unsigned char *transcript = remote_map(path, &len);
+    if (!transcript) {
+        return 1;
+    }
+    const int num_poly_coeffs = n - pp->t - 1;
+    BIGNUM *poly_coeffs[num_poly_coeffs]; // polynomial container
+    if (dh_pvss_distribute_encoded_poly(pp, transcript, len, com_keys, poly_coeffs)) {
+        munmap((void *)transcript, len);
+        return 1;
+    }
+
+    // hand out the index ranges
+    int sent[num_workers];
+    int ret = 0;
+    for (int w=0; w<num_workers; w++) {
+        const int from = (int)((long)n * w / num_workers);
+        const int to = (int)((long)n * (w + 1) / num_workers);
+        sent[w] = remote_send_request(group, worker_fds[w], DH_PVSS_REMOTE_DISTRIBUTION, from, to, path, num_poly_coeffs, (const BIGNUM **)poly_coeffs) == 0;
+        ret |= !sent[w];
+    }
+
+    // add up the partial sums
+    EC_POINT *U = point_new(group);
+    EC_POINT *V = point_new(group);
+    unsigned char response[1 + 2 * point_len];
+    for (int w=0; w<num_workers; w++) {
+        EC_POINT *sums[2];
+        if (!sent[w] || remote_recv(worker_fds[w], response, sizeof(response)) || response[0] != 0 || dh_pvss_wire_decode_points_validated(group, response + 1, 2, sums, 1, ctx)) {
+            ret = 1;
+            continue;
+        }
+        point_add(group, U, U, sums[0], ctx);
+        point_add(group, V, V, sums[1], ctx);
+        point_free(sums[0]);
+        point_free(sums[1]);
+    }
+    if (ret == 0) {
+        ret = dh_pvss_distribute_encoded_check(pp, transcript, len, U, V);
+    }
+
+    // cleanup
+    point_free(U);
+    point_free(V);
+    for (int i=0; i<num_poly_coeffs; i++) {
+        bn_free(poly_coeffs[i]);
+    }
+    munmap((void *)transcript, len);
+
+    return ret;
+}
+
+int dh_pvss_remote_reshare_verify(const dh_pvss_reshare_epoch_ctx *epoch, const char *path, int num_reshares, int num_workers, const int worker_fds[], int *results) {
+    assert(num_workers > 0 && "dh_pvss_remote_reshare_verify: usage error, no workers");
+    for (int k=0; k<num_reshares; k++) {
+        results[k] = 1;
+    }
+
+    // hand out the transcript ranges
+    int from[num_workers];
+    int to[num_workers];
+    int sent[num_workers];
+    for (int w=0; w<num_workers; w++) {
+        from[w] = (int)((long)num_reshares * w / num_workers);
+        to[w] = (int)((long)num_reshares * (w + 1) / num_workers);
+        sent[w] = remote_send_request(epoch->group, worker_fds[w], DH_PVSS_REMOTE_RESHARE, from[w], to[w], path, 0, NULL) == 0;
+    }
+
+    // collect the verdicts
+    int ret = 0;
+    unsigned char *verdicts = malloc(num_reshares + 1);
+    assert(verdicts && "dh_pvss_remote_reshare_verify: allocation error (verdicts)");
+    for (int w=0; w<num_workers; w++) {
+        unsigned char status;
+        if (!sent[w] || remote_recv(worker_fds[w], &status, 1) || status != 0 || remote_recv(worker_fds[w], verdicts, to[w] - from[w])) {
+            ret = 1;
+            continue;
+        }
+        for (int k=from[w]; k<to[w]; k++) {
+            results[k] = verdicts[k - from[w]] != 0;
+            ret |= results[k];
+        }
+    }
+    free(verdicts);
+
+    return ret;
+}
+
+/*
+ *
+ *  dh_pvss_remote tests
+ *
+ */
+
+// fork num_workers workers serving w, each connected by a socketpair, returns 0 on success and 1 if fork is not possible
+static int test_workers_start(const dh_pvss_remote_worker *w, int num_workers, int fds[], pid_t pids[]) {
+    for (int i=0; i<num_workers; i++) {
+        int pair[2];
+        pid_t pid = -1;
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0) {
+            fflush(stdout); // do not duplicate buffered output
+            pid = fork();
+            if (pid < 0) {
+                close(pair[0]);
+                close(pair[1]);
+            }
+        }
+        if (pid < 0) { // stop the workers started so far
+            for (int j=0; j<i; j++) {
+                dh_pvss_remote_quit(fds[j]);
+                close(fds[j]);
+                waitpid(pids[j], NULL, 0);
+            }
+            return 1;
+        }
+        if (pid == 0) { // worker
+            for (int j=0; j<i; j++) {
+                close(fds[j]);
+            }
+            close(pair[0]);
+            int ret = dh_pvss_remote_serve(w, pair[1]);
+            close(pair[1]);
+            _exit(ret);
+        }
+        close(pair[1]);
+        fds[i] = pair[0];
+        pids[i] = pid;
+    }
+    return 0;
+}
+
+// returns 0 if all workers exited cleanly
+static int test_workers_stop(int num_workers, int fds[], pid_t pids[]) {
+    int ret = 0;
+    for (int i=0; i<num_workers; i++) {
+        dh_pvss_remote_quit(fds[i]);
+        close(fds[i]);
+        int status;
+        ret |= waitpid(pids[i], &status, 0) != pids[i] || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    return ret;
+}
+
+// write buf to a fresh temporary file, whose name is returned in path, returns 0 on success
+static int test_write_file(char *path, size_t path_size, const unsigned char *buf, size_t len) {
+    const char *tmp_dir = getenv("TMPDIR");
+    snprintf(path, path_size, "%s/dh_pvss_remote_XXXXXX", tmp_dir ? tmp_dir : "/tmp");
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return 1;
+    }
+    int ret = write(fd, buf, len) != (ssize_t)len;
+    close(fd);
+    return ret;
+}
+
+static int dh_pvss_remote_test_1(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+    const int t = 20;
+    const int n = 60;
+    const int num_workers = 3;
+    dh_pvss_ctx pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+
+    // distribute and write the transcript to file
+    EC_POINT *secret = point_random(group, ctx);
+    dh_key_pair dist_kp;
+    dh_key_pair_generate(group, &dist_kp, ctx);
+    dh_key_pair committee_key_pairs[n];
+    const EC_POINT *committee_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &committee_key_pairs[i], ctx);
+        committee_public_keys[i] = committee_key_pairs[i].pub;
+    }
+    EC_POINT *enc_shares[n];
+    nizk_dl_eq_proof pi;
+    dh_pvss_distribute_prove(&pp, enc_shares, &dist_kp, committee_public_keys, secret, &pi);
+    size_t len = dh_pvss_wire_distribution_len(group, n);
+    unsigned char *transcript = malloc(len);
+    dh_pvss_wire_encode_distribution(group, transcript, n, dist_kp.pub, (const EC_POINT **)enc_shares, &pi, ctx);
+    char path[1024];
+    int ret1 = test_write_file(path, sizeof(path), transcript, len);
+
+    // verify using worker processes, then with two shares swapped
+    dh_pvss_remote_worker w = { &pp, committee_public_keys, NULL };
+    int fds[num_workers];
+    pid_t pids[num_workers];
+    int ret2 = 1;
+    int skipped = ret1 == 0 && test_workers_start(&w, num_workers, fds, pids) != 0;
+    if (ret1 == 0 && !skipped) {
+        ret1 = dh_pvss_remote_distribute_verify(&pp, path, committee_public_keys, num_workers, fds);
+        const size_t point_len = dh_pvss_wire_point_len(group);
+        unsigned char *encoded_shares = transcript + DH_PVSS_WIRE_HEADER_LEN + point_len;
+        unsigned char tmp[point_len];
+        memcpy(tmp, encoded_shares + 5 * point_len, point_len);
+        memcpy(encoded_shares + 5 * point_len, encoded_shares + 45 * point_len, point_len);
+        memcpy(encoded_shares + 45 * point_len, tmp, point_len);
+        unlink(path);
+        ret2 = test_write_file(path, sizeof(path), transcript, len) || dh_pvss_remote_distribute_verify(&pp, path, committee_public_keys, num_workers, fds);
+        ret1 |= test_workers_stop(num_workers, fds, pids);
+    }
+    unlink(path);
+    if (print) {
+        if (skipped) {
+            printf("    OK Test 1: Remote DH PVSS Distribution verification skipped (no fork)\n");
+        } else {
+            printf("%6s Test 1 - 1: Correct DH PVSS Distribution %s accepted by worker processes\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT" : "indeed");
+            printf("%6s Test 1 - 2: Incorrect DH PVSS Distribution %s by worker processes\n", ret2 ? "OK" : "NOT OK", ret2 ? "not accepted" : "ACCEPTED");
+        }
+    }
+
+    // cleanup
+    free(transcript);
+    for (int i=0; i<n; i++) {
+        point_free(enc_shares[i]);
+        dh_key_pair_free(&committee_key_pairs[i]);
+    }
+    nizk_dl_eq_proof_free(&pi);
+    dh_key_pair_free(&dist_kp);
+    point_free(secret);
+    dh_pvss_ctx_free(&pp);
+    BN_CTX_free(ctx);
+
+    return !skipped && (ret1 || !ret2);
+}
+
+static int dh_pvss_remote_test_2(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+    const int t = 3;
+    const int n = 8;
+    const int next_n = 9;
+    const int num_workers = 3;
+    const int bad_party = 5;
+    dh_pvss_ctx pp, next_pp;
+    dh_pvss_setup(&pp, group, t, n, ctx);
+    dh_pvss_setup(&next_pp, group, 3, next_n, ctx);
+
+    // distribution, and keys of both committees
+    EC_POINT *secret = point_random(group, ctx);
+    dh_key_pair first_dist_kp;
+    dh_key_pair_generate(group, &first_dist_kp, ctx);
+    dh_key_pair committee_key_pairs[n];
+    dh_key_pair dist_key_pairs[n];
+    const EC_POINT *committee_public_keys[n];
+    for (int i=0; i<n; i++) {
+        dh_key_pair_generate(group, &committee_key_pairs[i], ctx);
+        dh_key_pair_generate(group, &dist_key_pairs[i], ctx);
+        committee_public_keys[i] = committee_key_pairs[i].pub;
+    }
+    dh_key_pair next_committee_key_pairs[next_n];
+    const EC_POINT *next_committee_public_keys[next_n];
+    for (int j=0; j<next_n; j++) {
+        dh_key_pair_generate(group, &next_committee_key_pairs[j], ctx);
+        next_committee_public_keys[j] = next_committee_key_pairs[j].pub;
+    }
+    EC_POINT *enc_shares[n];
+    nizk_dl_eq_proof pi;
+    dh_pvss_distribute_prove(&pp, enc_shares, &first_dist_kp, committee_public_keys, secret, &pi);
+
+    // all parties reshare, the transcript of one of them with the proof of another
+    dh_pvss_reshare_epoch_ctx epoch;
+    dh_pvss_reshare_epoch_ctx_init(&epoch, group, first_dist_kp.pub, (const EC_POINT **)enc_shares, n, &next_pp, next_committee_public_keys, ctx);
+    EC_POINT *enc_re_shares[n][next_n];
+    nizk_reshare_proof reshare_pis[n];
+    for (int i=0; i<n; i++) {
+        dh_pvss_reshare_prove_epoch(&epoch, i, &committee_key_pairs[i], &dist_key_pairs[i], enc_re_shares[i], &reshare_pis[i], ctx);
+    }
+    const size_t transcript_len = dh_pvss_wire_reshare_len(group, next_n);
+    unsigned char *transcripts = malloc(n * transcript_len);
+    for (int i=0; i<n; i++) {
+        const nizk_reshare_proof *reshare_pi = &reshare_pis[i == bad_party ? i + 1 : i];
+        dh_pvss_wire_encode_reshare(group, transcripts + i * transcript_len, next_n, i, dist_key_pairs[i].pub, (const EC_POINT **)enc_re_shares[i], reshare_pi, ctx);
+    }
+    char path[1024];
+    int ret1 = test_write_file(path, sizeof(path), transcripts, n * transcript_len);
+
+    // verify using worker processes
+    dh_pvss_remote_worker w = { &pp, committee_public_keys, &epoch };
+    int fds[num_workers];
+    pid_t pids[num_workers];
+    int skipped = ret1 == 0 && test_workers_start(&w, num_workers, fds, pids) != 0;
+    if (ret1 == 0 && !skipped) {
+        int results[n];
+        ret1 = dh_pvss_remote_reshare_verify(&epoch, path, n, num_workers, fds, results) == 0;
+        for (int i=0; i<n; i++) {
+            ret1 |= results[i] != (i == bad_party);
+        }
+        ret1 |= test_workers_stop(num_workers, fds, pids);
+    }
+    unlink(path);
+    if (print) {
+        if (skipped) {
+            printf("    OK Test 2: Remote DH PVSS Reshare verification skipped (no fork)\n");
+        } else {
+            printf("%6s Test 2: Correct DH PVSS Reshares %s accepted by worker processes, and incorrect reshare %s\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT all" : "indeed", ret1 ? "maybe accepted" : "not accepted");
+        }
+    }
+
+    // cleanup
+    free(transcripts);
+    for (int i=0; i<n; i++) {
+        for (int j=0; j<next_n; j++) {
+            point_free(enc_re_shares[i][j]);
+        }
+        nizk_reshare_proof_free(&reshare_pis[i]);
+        point_free(enc_shares[i]);
+        dh_key_pair_free(&committee_key_pairs[i]);
+        dh_key_pair_free(&dist_key_pairs[i]);
+    }
+    for (int j=0; j<next_n; j++) {
+        dh_key_pair_free(&next_committee_key_pairs[j]);
+    }
+    dh_pvss_reshare_epoch_ctx_free(&epoch);
+    nizk_dl_eq_proof_free(&pi);
+    dh_key_pair_free(&first_dist_kp);
+    point_free(secret);
+    dh_pvss_ctx_free(&pp);
+    dh_pvss_ctx_free(&next_pp);
+    BN_CTX_free(ctx);
+
+    return !skipped && ret1;
+}
+
+typedef int (*test_function)(int);
+
+static test_function test_suite[] = {
+    &dh_pvss_remote_test_1,
+    &dh_pvss_remote_test_2
+};
+
+// return test results
+//   0 = passed (all individual tests passed)
+//   1 = failed (one or more individual tests failed)
+// setting print to 0 (zero) suppresses stdio printouts, while print 1 is 'verbose'
+int dh_pvss_remote_test_suite(int print) {
+    if (print) {
+        printf("DH PVSS remote test suite BEGIN ---------------------\n");
+    }
+    int num_tests = sizeof(test_suite)/sizeof(test_function);
+    int ret = 0;
+    for (int i=0; i<num_tests; i++) {
+        if (test_suite[i](print)) {
+            ret = 1;
+        }
+    }
+    if (print) {
+        printf("DH PVSS remote test suite END -----------------------\n");
+#ifdef DEBUG
+        print_allocation_status();
+#endif
+        fflush(stdout);
+    }
+    return ret;
+}
@@ -0,0 +1,39 @@
+//
+//  dh_pvss_remote.h
+//  OpenSSL-for-iOS
+//
+
+#ifndef DH_PVSS_REMOTE_H
+#define DH_PVSS_REMOTE_H
+#include "dh_pvss.h"
+
+/* verification split across worker processes, each connected to the coordinator by a stream socket
+ * (e.g., one end of a socketpair, or a Unix domain socket), and reading transcripts from a shared file
+ *   distribution: a transcript file in wire format, workers return the sums of U and V over their index range
+ *                 (see dh_pvss_distribute_encoded_partial_sums), which the coordinator adds up to check the proof
+ *   reshare:      a file of num_reshares reshare transcripts in wire format, back to back, workers verify those in
+ *                 their range and return the verdicts
+ * every request is a fixed header, type | from | to | path length (32 bit big-endian each), the path, and for
+ * distributions the scrape polynomial (32 bit count and fixed-width scalars), answered by a status byte and
+ * either U and V (point slots, see dh_pvss_wire.h) or one verdict byte per reshare */
+
+/* what a worker holds for the lifetime of its connection: the committee, and the epoch if it verifies reshares
+ * pp->num_threads threads are used by the worker for each request */
+typedef struct {
+    dh_pvss_ctx *pp;
+    const EC_POINT **com_keys;
+    const dh_pvss_reshare_epoch_ctx *epoch; // NULL if the worker does not verify reshares
+} dh_pvss_remote_worker;
+
+// serve requests on fd until the coordinator quits or closes the connection (returns 0), or until an I/O error (returns 1)
+int dh_pvss_remote_serve(const dh_pvss_remote_worker *w, int fd);
+void dh_pvss_remote_quit(int fd);
+
+// returns 0 if the distribution is valid, and 1 if it is not, or if it is malformed, or if a worker fails
+int dh_pvss_remote_distribute_verify(dh_pvss_ctx *pp, const char *path, const EC_POINT **com_keys, int num_workers, const int worker_fds[]);
+// returns 0 if all reshares are valid and 1 otherwise, results[k] is set to 0 (valid) or 1 (invalid or not verified)
+int dh_pvss_remote_reshare_verify(const dh_pvss_reshare_epoch_ctx *epoch, const char *path, int num_reshares, int num_workers, const int worker_fds[], int *results);
+
+int dh_pvss_remote_test_suite(int print);
+
+#endif /* DH_PVSS_REMOTE_H */
@@ -0,0 +1,884 @@
+//
+//  dh_pvss_wire.c
+//  OpenSSL-for-iOS
+//
+#include "dh_pvss_wire.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "openssl_hashing_tools.h"
+
+#define DH_PVSS_WIRE_AFFINE_BATCH 64 // points made affine together when encoding
+
+static const unsigned char wire_magic[2] = { 'P', 'V' };
+
+size_t dh_pvss_wire_point_len(const EC_GROUP *group) {
+    return openssl_point_encoding_len(group);
+}
+
+size_t dh_pvss_wire_scalar_len(const EC_GROUP *group) {
+    return BN_num_bytes(get0_order(group));
+}
+
+void dh_pvss_wire_encode_header(unsigned char *buf, dh_pvss_wire_type type, int count) {
+    assert(count >= 0 && "dh_pvss_wire_encode_header: usage error, negative count");
+    buf[0] = wire_magic[0];
+    buf[1] = wire_magic[1];
+    buf[2] = DH_PVSS_WIRE_VERSION;
+    buf[3] = (unsigned char)type;
+    buf[4] = (unsigned char)(count >> 24);
+    buf[5] = (unsigned char)(count >> 16);
+    buf[6] = (unsigned char)(count >> 8);
+    buf[7] = (unsigned char)count;
+}
+
+// returns 0 if buf holds a header of the expected type (and version), in which case the count is returned in *count
+int dh_pvss_wire_decode_header(const unsigned char *buf, size_t len, dh_pvss_wire_type type, int *count) {
+    if (len < DH_PVSS_WIRE_HEADER_LEN) {
+        return 1; // truncated
+    }
+    if (buf[0] != wire_magic[0] || buf[1] != wire_magic[1] || buf[2] != DH_PVSS_WIRE_VERSION || buf[3] != (unsigned char)type) {
+        return 1; // not a transcript of this kind
+    }
+    unsigned long c = ((unsigned long)buf[4] << 24) | ((unsigned long)buf[5] << 16) | ((unsigned long)buf[6] << 8) | buf[7];
+    if (c > 0x7fffffff) {
+        return 1; // does not fit an int
+    }
+    *count = (int)c;
+    return 0;
+}
+
+static void wire_encode_index(unsigned char *buf, int index) {
+    buf[0] = (unsigned char)(index >> 24);
+    buf[1] = (unsigned char)(index >> 16);
+    buf[2] = (unsigned char)(index >> 8);
+    buf[3] = (unsigned char)index;
+}
+
+static int wire_decode_index(const unsigned char *buf) {
+    return (int)(((unsigned long)buf[0] << 24) | ((unsigned long)buf[1] << 16) | ((unsigned long)buf[2] << 8) | buf[3]);
+}
+
+/* compressed encodings of num_points points, written back to back
+ * the encoding needs affine coordinates, so copies of the points are made affine in batches with a single
+ * field inversion per batch, instead of one inversion per point (the input points are not modified) */
+void dh_pvss_wire_encode_points(const EC_GROUP *group, unsigned char *buf, int num_points, const EC_POINT *points[], BN_CTX *ctx) {
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    const int batch_len = num_points < DH_PVSS_WIRE_AFFINE_BATCH ? num_points : DH_PVSS_WIRE_AFFINE_BATCH;
+    EC_POINT *batch[DH_PVSS_WIRE_AFFINE_BATCH];
+    for (int i=0; i<batch_len; i++) {
+        batch[i] = point_new(group);
+    }
+
+    for (int first=0; first<num_points; first+=batch_len) {
+        const int num = num_points - first < batch_len ? num_points - first : batch_len;
+        for (int i=0; i<num; i++) {
+            int ret = EC_POINT_copy(batch[i], points[first + i]);
+            assert(ret == 1 && "dh_pvss_wire_encode_points: EC_POINT_copy failed");
+        }
+        int ret = EC_POINTs_make_affine(group, num, batch, ctx);
+        assert(ret == 1 && "dh_pvss_wire_encode_points: EC_POINTs_make_affine failed");
+        for (int i=0; i<num; i++) {
+            openssl_point_encode(group, batch[i], buf + (size_t)(first + i) * point_len, ctx);
+        }
+    }
+
+    // cleanup
+    for (int i=0; i<batch_len; i++) {
+        point_free(batch[i]);
+    }
+}
+
+// returns 0 if the slot holds a valid encoding, in which case point is set to the encoded point
+static int wire_decode_point(const EC_GROUP *group, const unsigned char *buf, size_t point_len, EC_POINT *point, BN_CTX *ctx) {
+    if (buf[0] == 0x00) { // point at infinity, the rest of the slot must be zero too
+        for (size_t i=1; i<point_len; i++) {
+            if (buf[i] != 0x00) {
+                return 1;
+            }
+        }
+        EC_POINT_set_to_infinity(group, point);
+        return 0;
+    }
+    if (buf[0] != 0x02 && buf[0] != 0x03) {
+        return 1; // only compressed encodings are accepted
+    }
+    return EC_POINT_oct2point(group, point, buf, point_len, ctx) == 1 ? 0 : 1; // fails for points not on the curve
+}
+
+// decode num_points points into newly allocated points, on failure nothing is allocated and 1 is returned
+int dh_pvss_wire_decode_points(const EC_GROUP *group, const unsigned char *buf, int num_points, EC_POINT *points[], BN_CTX *ctx) {
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    for (int i=0; i<num_points; i++) {
+        points[i] = point_new(group);
+        if (wire_decode_point(group, buf + (size_t)i * point_len, point_len, points[i], ctx)) {
+            for (int j=0; j<=i; j++) {
+                point_free(points[j]);
+                points[j] = NULL;
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* cheap structural check of num_points encodings, meant to run before any decompression:
+ * compressed prefix, x-coordinate smaller than the field prime (one byte string comparison per point against the
+ * prime, encoded once), and all-zero slots for the point at infinity, which are rejected unless allow_infinity is set
+ * returns 0 if all encodings pass */
+int dh_pvss_wire_scan_points(const EC_GROUP *group, const unsigned char *buf, int num_points, int allow_infinity, BN_CTX *ctx) {
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    const size_t field_len = point_len - 1;
+    BIGNUM *prime = bn_new();
+    int ret = EC_GROUP_get_curve(group, prime, NULL, NULL, ctx);
+    assert(ret == 1 && "dh_pvss_wire_scan_points: EC_GROUP_get_curve failed");
+    unsigned char prime_bytes[field_len];
+    ret = BN_bn2binpad(prime, prime_bytes, (int)field_len);
+    assert(ret == (int)field_len && "dh_pvss_wire_scan_points: unexpected field size");
+    bn_free(prime);
+
+    for (int i=0; i<num_points; i++) {
+        const unsigned char *slot = buf + (size_t)i * point_len;
+        if (slot[0] == 0x02 || slot[0] == 0x03) {
+            if (memcmp(slot + 1, prime_bytes, field_len) >= 0) {
+                return 1; // x not reduced
+            }
+        } else if (slot[0] == 0x00 && allow_infinity) {
+            for (size_t j=1; j<point_len; j++) {
+                if (slot[j] != 0x00) {
+                    return 1;
+                }
+            }
+        } else {
+            return 1; // bad prefix, or infinity where not allowed
+        }
+    }
+    return 0;
+}
+
+/* returns 0 if all points lie in the subgroup generated by the generator
+ * this is implied by being on the curve when the cofactor is 1 (as for P-256), so then there is nothing to do,
+ * otherwise every point is multiplied by the order, since folding the points into a random linear combination
+ * first would miss a bad point with probability up to one half for small cofactors */
+int dh_pvss_wire_check_subgroup(const EC_GROUP *group, int num_points, const EC_POINT *points[], BN_CTX *ctx) {
+    BIGNUM *cofactor = bn_new();
+    int ret = EC_GROUP_get_cofactor(group, cofactor, ctx);
+    assert(ret == 1 && "dh_pvss_wire_check_subgroup: EC_GROUP_get_cofactor failed");
+    int cofactor_is_one = BN_is_one(cofactor);
+    bn_free(cofactor);
+    if (cofactor_is_one) {
+        return 0;
+    }
+
+    const BIGNUM *order = get0_order(group);
+    EC_POINT *r = point_new(group);
+    ret = 0;
+    for (int i=0; i<num_points && ret==0; i++) {
+        point_mul(group, r, order, points[i], ctx);
+        ret = EC_POINT_is_at_infinity(group, r) ? 0 : 1;
+    }
+    point_free(r);
+    return ret;
+}
+
+// dh_pvss_wire_decode_points, preceded by dh_pvss_wire_scan_points and followed by dh_pvss_wire_check_subgroup
+int dh_pvss_wire_decode_points_validated(const EC_GROUP *group, const unsigned char *buf, int num_points, EC_POINT *points[], int allow_infinity, BN_CTX *ctx) {
+    if (dh_pvss_wire_scan_points(group, buf, num_points, allow_infinity, ctx)) {
+        return 1;
+    }
+    if (dh_pvss_wire_decode_points(group, buf, num_points, points, ctx)) {
+        return 1; // not on the curve
+    }
+    if (dh_pvss_wire_check_subgroup(group, num_points, (const EC_POINT **)points, ctx)) {
+        for (int i=0; i<num_points; i++) {
+            point_free(points[i]);
+            points[i] = NULL;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+void dh_pvss_wire_encode_scalar(const EC_GROUP *group, unsigned char *buf, const BIGNUM *scalar) {
+    const int scalar_len = (int)dh_pvss_wire_scalar_len(group);
+    int ret = BN_bn2binpad(scalar, buf, scalar_len);
+    assert(ret == scalar_len && "dh_pvss_wire_encode_scalar: scalar too large");
+}
+
+// returns a newly allocated scalar, or NULL if the encoded value is not smaller than the group order
+BIGNUM *dh_pvss_wire_decode_scalar(const EC_GROUP *group, const unsigned char *buf) {
+    const int scalar_len = (int)dh_pvss_wire_scalar_len(group);
+    BIGNUM *scalar = bn_new();
+    BIGNUM *ret = BN_bin2bn(buf, scalar_len, scalar);
+    assert(ret && "dh_pvss_wire_decode_scalar: BN_bin2bn failed");
+    if (BN_cmp(scalar, get0_order(group)) >= 0) {
+        bn_free(scalar);
+        return NULL; // not reduced
+    }
+    return scalar;
+}
+
+/*
+ *
+ *  transcripts
+ *
+ */
+size_t dh_pvss_wire_distribution_len(const EC_GROUP *group, int n) {
+    return DH_PVSS_WIRE_HEADER_LEN + (size_t)(n + 3) * dh_pvss_wire_point_len(group) + dh_pvss_wire_scalar_len(group);
+}
+
+size_t dh_pvss_wire_encode_distribution(const EC_GROUP *group, unsigned char *buf, int n, const EC_POINT *pub_dist, const EC_POINT *enc_shares[], const nizk_dl_eq_proof *pi, BN_CTX *ctx) {
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    unsigned char *p = buf;
+
+    dh_pvss_wire_encode_header(p, DH_PVSS_WIRE_DISTRIBUTION, n);
+    p += DH_PVSS_WIRE_HEADER_LEN;
+    const EC_POINT *head[] = { pub_dist };
+    dh_pvss_wire_encode_points(group, p, 1, head, ctx);
+    p += point_len;
+    dh_pvss_wire_encode_points(group, p, n, enc_shares, ctx);
+    p += (size_t)n * point_len;
+    const EC_POINT *commitments[] = { pi->Ra, pi->Rb };
+    dh_pvss_wire_encode_points(group, p, 2, commitments, ctx);
+    p += 2 * point_len;
+    dh_pvss_wire_encode_scalar(group, p, pi->z);
+    p += dh_pvss_wire_scalar_len(group);
+
+    return p - buf;
+}
+
+int dh_pvss_wire_decode_distribution(const EC_GROUP *group, const unsigned char *buf, size_t len, int n, EC_POINT **pub_dist, EC_POINT *enc_shares[], nizk_dl_eq_proof *pi, BN_CTX *ctx) {
+    int count;
+    if (dh_pvss_wire_decode_header(buf, len, DH_PVSS_WIRE_DISTRIBUTION, &count) || count != n || len != dh_pvss_wire_distribution_len(group, n)) {
+        return 1;
+    }
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    const unsigned char *p = buf + DH_PVSS_WIRE_HEADER_LEN;
+
+    // pub_dist, enc_shares, Ra and Rb are consecutive
+    BIGNUM *z = dh_pvss_wire_decode_scalar(group, p + (size_t)(n + 3) * point_len);
+    if (!z) {
+        return 1;
+    }
+    EC_POINT **points = malloc((n + 3) * sizeof(EC_POINT *));
+    assert(points && "dh_pvss_wire_decode_distribution: allocation error (points)");
+    if (dh_pvss_wire_decode_points_validated(group, p, n + 3, points, 0, ctx)) {
+        free(points);
+        bn_free(z);
+        return 1;
+    }
+    *pub_dist = points[0];
+    memcpy(enc_shares, points + 1, n * sizeof(EC_POINT *));
+    pi->Ra = points[n + 1];
+    pi->Rb = points[n + 2];
+    pi->z = z;
+    free(points);
+
+    return 0;
+}
+
+size_t dh_pvss_wire_decryption_len(const EC_GROUP *group) {
+    return DH_PVSS_WIRE_HEADER_LEN + 3 * dh_pvss_wire_point_len(group) + dh_pvss_wire_scalar_len(group);
+}
+
+size_t dh_pvss_wire_encode_decryption(const EC_GROUP *group, unsigned char *buf, const EC_POINT *decrypted_share, const nizk_dl_eq_proof *pi, BN_CTX *ctx) {
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    unsigned char *p = buf;
+
+    dh_pvss_wire_encode_header(p, DH_PVSS_WIRE_DECRYPTION, 1);
+    p += DH_PVSS_WIRE_HEADER_LEN;
+    const EC_POINT *points[] = { decrypted_share, pi->Ra, pi->Rb };
+    dh_pvss_wire_encode_points(group, p, 3, points, ctx);
+    p += 3 * point_len;
+    dh_pvss_wire_encode_scalar(group, p, pi->z);
+    p += dh_pvss_wire_scalar_len(group);
+
+    return p - buf;
+}
+
+int dh_pvss_wire_decode_decryption(const EC_GROUP *group, const unsigned char *buf, size_t len, EC_POINT **decrypted_share, nizk_dl_eq_proof *pi, BN_CTX *ctx) {
+    int count;
+    if (dh_pvss_wire_decode_header(buf, len, DH_PVSS_WIRE_DECRYPTION, &count) || count != 1 || len != dh_pvss_wire_decryption_len(group)) {
+        return 1;
+    }
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    const unsigned char *p = buf + DH_PVSS_WIRE_HEADER_LEN;
+
+    BIGNUM *z = dh_pvss_wire_decode_scalar(group, p + 3 * point_len);
+    if (!z) {
+        return 1;
+    }
+    EC_POINT *points[3];
+    if (dh_pvss_wire_decode_points_validated(group, p, 3, points, 0, ctx)) {
+        bn_free(z);
+        return 1;
+    }
+    *decrypted_share = points[0];
+    pi->Ra = points[1];
+    pi->Rb = points[2];
+    pi->z = z;
+
+    return 0;
+}
+
+size_t dh_pvss_wire_reshare_len(const EC_GROUP *group, int next_n) {
+    return DH_PVSS_WIRE_HEADER_LEN + 4 + (size_t)(next_n + 4) * dh_pvss_wire_point_len(group) + 2 * dh_pvss_wire_scalar_len(group);
+}
+
+size_t dh_pvss_wire_encode_reshare(const EC_GROUP *group, unsigned char *buf, int next_n, int party_index, const EC_POINT *party_dist_pub_key, const EC_POINT *enc_re_shares[], const nizk_reshare_proof *pi, BN_CTX *ctx) {
+    assert(party_index >= 0 && "dh_pvss_wire_encode_reshare: usage error, negative party index");
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    const size_t scalar_len = dh_pvss_wire_scalar_len(group);
+    unsigned char *p = buf;
+
+    dh_pvss_wire_encode_header(p, DH_PVSS_WIRE_RESHARE, next_n);
+    p += DH_PVSS_WIRE_HEADER_LEN;
+    wire_encode_index(p, party_index);
+    p += 4;
+    const EC_POINT *head[] = { party_dist_pub_key };
+    dh_pvss_wire_encode_points(group, p, 1, head, ctx);
+    p += point_len;
+    dh_pvss_wire_encode_points(group, p, next_n, enc_re_shares, ctx);
+    p += (size_t)next_n * point_len;
+    const EC_POINT *commitments[] = { pi->R1, pi->R2, pi->R3 };
+    dh_pvss_wire_encode_points(group, p, 3, commitments, ctx);
+    p += 3 * point_len;
+    dh_pvss_wire_encode_scalar(group, p, pi->z1);
+    p += scalar_len;
+    dh_pvss_wire_encode_scalar(group, p, pi->z2);
+    p += scalar_len;
+
+    return p - buf;
+}
+
+int dh_pvss_wire_decode_reshare(const EC_GROUP *group, const unsigned char *buf, size_t len, int next_n, int *party_index, EC_POINT **party_dist_pub_key, EC_POINT *enc_re_shares[], nizk_reshare_proof *pi, BN_CTX *ctx) {
+    int count;
+    if (dh_pvss_wire_decode_header(buf, len, DH_PVSS_WIRE_RESHARE, &count) || count != next_n || len != dh_pvss_wire_reshare_len(group, next_n)) {
+        return 1;
+    }
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    const size_t scalar_len = dh_pvss_wire_scalar_len(group);
+    const unsigned char *p = buf + DH_PVSS_WIRE_HEADER_LEN;
+
+    int index = wire_decode_index(p);
+    if (index < 0) {
+        return 1;
+    }
+    p += 4;
+
+    // party_dist_pub_key, enc_re_shares, R1, R2 and R3 are consecutive
+    const unsigned char *scalars = p + (size_t)(next_n + 4) * point_len;
+    BIGNUM *z1 = dh_pvss_wire_decode_scalar(group, scalars);
+    BIGNUM *z2 = dh_pvss_wire_decode_scalar(group, scalars + scalar_len);
+    if (!z1 || !z2) {
+        if (z1) {
+            bn_free(z1);
+        }
+        if (z2) {
+            bn_free(z2);
+        }
+        return 1;
+    }
+    EC_POINT **points = malloc((next_n + 4) * sizeof(EC_POINT *));
+    assert(points && "dh_pvss_wire_decode_reshare: allocation error (points)");
+    if (dh_pvss_wire_decode_points_validated(group, p, next_n + 4, points, 0, ctx)) {
+        free(points);
+        bn_free(z1);
+        bn_free(z2);
+        return 1;
+    }
+    *party_index = index;
+    *party_dist_pub_key = points[0];
+    memcpy(enc_re_shares, points + 1, next_n * sizeof(EC_POINT *));
+    pi->R1 = points[next_n + 1];
+    pi->R2 = points[next_n + 2];
+    pi->R3 = points[next_n + 3];
+    pi->z1 = z1;
+    pi->z2 = z2;
+    free(points);
+
+    return 0;
+}
+
+size_t dh_pvss_wire_aggregate_len(const EC_GROUP *group, int num_valid_indices, int next_n) {
+    return DH_PVSS_WIRE_HEADER_LEN + 4 + (size_t)num_valid_indices * 4 + (size_t)next_n * dh_pvss_wire_point_len(group);
+}
+
+size_t dh_pvss_wire_encode_aggregate(const EC_GROUP *group, unsigned char *buf, int num_valid_indices, const int *valid_indices, int next_n, const EC_POINT *reconstructed_shares[], BN_CTX *ctx) {
+    unsigned char *p = buf;
+
+    dh_pvss_wire_encode_header(p, DH_PVSS_WIRE_AGGREGATE, next_n);
+    p += DH_PVSS_WIRE_HEADER_LEN;
+    wire_encode_index(p, num_valid_indices);
+    p += 4;
+    for (int i=0; i<num_valid_indices; i++) {
+        assert(valid_indices[i] > 0 && "dh_pvss_wire_encode_aggregate: usage error, indices start at 1");
+        wire_encode_index(p, valid_indices[i]);
+        p += 4;
+    }
+    dh_pvss_wire_encode_points(group, p, next_n, reconstructed_shares, ctx);
+    p += (size_t)next_n * dh_pvss_wire_point_len(group);
+
+    return p - buf;
+}
+
+int dh_pvss_wire_decode_aggregate(const EC_GROUP *group, const unsigned char *buf, size_t len, int n, int num_valid_indices, int *valid_indices, int next_n, EC_POINT *reconstructed_shares[], BN_CTX *ctx) {
+    int count;
+    if (dh_pvss_wire_decode_header(buf, len, DH_PVSS_WIRE_AGGREGATE, &count) || count != next_n || len != dh_pvss_wire_aggregate_len(group, num_valid_indices, next_n)) {
+        return 1;
+    }
+    const unsigned char *p = buf + DH_PVSS_WIRE_HEADER_LEN;
+
+    if (wire_decode_index(p) != num_valid_indices) {
+        return 1;
+    }
+    p += 4;
+    int indices[num_valid_indices];
+    for (int i=0; i<num_valid_indices; i++) {
+        indices[i] = wire_decode_index(p);
+        if (indices[i] < 1 || indices[i] > n) {
+            return 1;
+        }
+        for (int k=0; k<i; k++) {
+            if (indices[k] == indices[i]) {
+                return 1; // Lagrange weights need distinct indices
+            }
+        }
+        p += 4;
+    }
+    // the reconstructed shares may be at infinity, if a re-shared share was
+    if (dh_pvss_wire_decode_points_validated(group, p, next_n, reconstructed_shares, 1, ctx)) {
+        return 1;
+    }
+    memcpy(valid_indices, indices, num_valid_indices * sizeof(int));
+
+    return 0;
+}
+
+/*
+ *
+ *  dh_pvss_wire tests
+ *
+ */
+static int dh_pvss_wire_test_1(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+    const int n = 100;
+
+    // points, among them the point at infinity, and a scalar
+    EC_POINT *points[n];
+    for (int i=0; i<n; i++) {
+        points[i] = point_random(group, ctx);
+    }
+    EC_POINT_set_to_infinity(group, points[17]);
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    unsigned char buf[n * point_len];
+    dh_pvss_wire_encode_points(group, buf, n, (const EC_POINT **)points, ctx);
+
+    // encodings agree with the ones used for hashing
+    int num_differences = 0;
+    unsigned char encoding[point_len];
+    for (int i=0; i<n; i++) {
+        openssl_point_encode(group, points[i], encoding, ctx);
+        num_differences += memcmp(encoding, buf + i * point_len, point_len) != 0;
+    }
+
+    // round trip
+    EC_POINT *decoded_points[n];
+    int ret1 = dh_pvss_wire_decode_points(group, buf, n, decoded_points, ctx);
+    if (ret1 == 0) {
+        for (int i=0; i<n; i++) {
+            num_differences += point_cmp(group, points[i], decoded_points[i], ctx);
+            point_free(decoded_points[i]);
+        }
+    }
+    if (print) {
+        printf("%6s Test 1 - 1: Bulk point encoding round trip %s\n", ret1 || num_differences ? "NOT OK" : "OK", ret1 || num_differences ? "failed" : "succeeded");
+    }
+
+    // negative tests, bad prefix, non-zero padding of infinity, and x-coordinate not on the curve
+    unsigned char bad[point_len];
+    memcpy(bad, buf, point_len);
+    bad[0] = 0x04;
+    int ret2 = dh_pvss_wire_decode_points(group, bad, 1, decoded_points, ctx);
+    memset(bad, 0, point_len);
+    bad[point_len - 1] = 0x01;
+    int ret3 = dh_pvss_wire_decode_points(group, bad, 1, decoded_points, ctx);
+    int num_rejected = 0;
+    for (int x=0; x<4; x++) { // about half of all x-coordinates are not on the curve
+        bad[0] = 0x02;
+        memset(bad + 1, 0, point_len - 1);
+        bad[point_len - 1] = (unsigned char)x;
+        if (dh_pvss_wire_decode_points(group, bad, 1, decoded_points, ctx)) {
+            num_rejected++;
+        } else {
+            point_free(decoded_points[0]);
+        }
+    }
+    if (print) {
+        if (ret2 && ret3 && num_rejected > 0) {
+            printf("    OK Test 1 - 2: Malformed point encodings not accepted (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 1 - 2: Malformed point encoding IS accepted (which is an ERROR)\n");
+        }
+    }
+
+    // scalars must be reduced
+    const size_t scalar_len = dh_pvss_wire_scalar_len(group);
+    unsigned char scalar_buf[scalar_len];
+    dh_pvss_wire_encode_scalar(group, scalar_buf, get0_order(group));
+    BIGNUM *unreduced = dh_pvss_wire_decode_scalar(group, scalar_buf);
+    if (print) {
+        printf("%6s Test 1 - 3: Unreduced scalar %s\n", unreduced ? "NOT OK" : "OK", unreduced ? "IS accepted" : "not accepted");
+    }
+
+    // cleanup
+    if (unreduced) {
+        bn_free(unreduced);
+    }
+    for (int i=0; i<n; i++) {
+        point_free(points[i]);
+    }
+    BN_CTX_free(ctx);
+
+    return !(ret1 == 0 && num_differences == 0 && ret2 && ret3 && num_rejected > 0 && unreduced == NULL);
+}
+
+static int dh_pvss_wire_test_2(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+    const BIGNUM *order = get0_order(group);
+    const int n = 20;
+
+    // transcript contents (random, the encoding does not care about validity)
+    EC_POINT *pub_dist = point_random(group, ctx);
+    EC_POINT *shares[n];
+    for (int i=0; i<n; i++) {
+        shares[i] = point_random(group, ctx);
+    }
+    nizk_dl_eq_proof dl_eq_pi = { point_random(group, ctx), point_random(group, ctx), bn_random(order, ctx) };
+    nizk_reshare_proof reshare_pi = { point_random(group, ctx), point_random(group, ctx), point_random(group, ctx), bn_random(order, ctx), bn_random(order, ctx) };
+
+    // distribution round trip
+    size_t len = dh_pvss_wire_distribution_len(group, n);
+    unsigned char *buf = malloc(len);
+    size_t written = dh_pvss_wire_encode_distribution(group, buf, n, pub_dist, (const EC_POINT **)shares, &dl_eq_pi, ctx);
+    EC_POINT *decoded_pub_dist;
+    EC_POINT *decoded_shares[n];
+    nizk_dl_eq_proof decoded_dl_eq_pi;
+    int ret1 = written != len || dh_pvss_wire_decode_distribution(group, buf, len, n, &decoded_pub_dist, decoded_shares, &decoded_dl_eq_pi, ctx);
+    if (ret1 == 0) {
+        ret1 |= point_cmp(group, pub_dist, decoded_pub_dist, ctx);
+        for (int i=0; i<n; i++) {
+            ret1 |= point_cmp(group, shares[i], decoded_shares[i], ctx);
+            point_free(decoded_shares[i]);
+        }
+        ret1 |= point_cmp(group, dl_eq_pi.Ra, decoded_dl_eq_pi.Ra, ctx);
+        ret1 |= point_cmp(group, dl_eq_pi.Rb, decoded_dl_eq_pi.Rb, ctx);
+        ret1 |= BN_cmp(dl_eq_pi.z, decoded_dl_eq_pi.z) != 0;
+        point_free(decoded_pub_dist);
+        nizk_dl_eq_proof_free(&decoded_dl_eq_pi);
+    }
+    if (print) {
+        printf("%6s Test 2 - 1: Distribution transcript round trip %s\n", ret1 ? "NOT OK" : "OK", ret1 ? "failed" : "succeeded");
+    }
+
+    // truncated, wrong count, and wrong type
+    int ret2 = dh_pvss_wire_decode_distribution(group, buf, len - 1, n, &decoded_pub_dist, decoded_shares, &decoded_dl_eq_pi, ctx);
+    ret2 &= dh_pvss_wire_decode_distribution(group, buf, len, n - 1, &decoded_pub_dist, decoded_shares, &decoded_dl_eq_pi, ctx);
+    buf[3] = DH_PVSS_WIRE_RESHARE;
+    ret2 &= dh_pvss_wire_decode_distribution(group, buf, len, n, &decoded_pub_dist, decoded_shares, &decoded_dl_eq_pi, ctx);
+    free(buf);
+    if (print) {
+        if (ret2) {
+            printf("    OK Test 2 - 2: Malformed distribution transcripts not accepted (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 2 - 2: Malformed distribution transcript IS accepted (which is an ERROR)\n");
+        }
+    }
+
+    // decryption round trip
+    len = dh_pvss_wire_decryption_len(group);
+    buf = malloc(len);
+    written = dh_pvss_wire_encode_decryption(group, buf, shares[0], &dl_eq_pi, ctx);
+    EC_POINT *decoded_share;
+    int ret3 = written != len || dh_pvss_wire_decode_decryption(group, buf, len, &decoded_share, &decoded_dl_eq_pi, ctx);
+    if (ret3 == 0) {
+        ret3 |= point_cmp(group, shares[0], decoded_share, ctx);
+        ret3 |= point_cmp(group, dl_eq_pi.Rb, decoded_dl_eq_pi.Rb, ctx);
+        ret3 |= BN_cmp(dl_eq_pi.z, decoded_dl_eq_pi.z) != 0;
+        point_free(decoded_share);
+        nizk_dl_eq_proof_free(&decoded_dl_eq_pi);
+    }
+    free(buf);
+    if (print) {
+        printf("%6s Test 2 - 3: Decryption transcript round trip %s\n", ret3 ? "NOT OK" : "OK", ret3 ? "failed" : "succeeded");
+    }
+
+    // reshare round trip
+    len = dh_pvss_wire_reshare_len(group, n);
+    buf = malloc(len);
+    written = dh_pvss_wire_encode_reshare(group, buf, n, 7, pub_dist, (const EC_POINT **)shares, &reshare_pi, ctx);
+    int decoded_index;
+    nizk_reshare_proof decoded_reshare_pi;
+    int ret4 = written != len || dh_pvss_wire_decode_reshare(group, buf, len, n, &decoded_index, &decoded_pub_dist, decoded_shares, &decoded_reshare_pi, ctx);
+    if (ret4 == 0) {
+        ret4 |= decoded_index != 7;
+        ret4 |= point_cmp(group, pub_dist, decoded_pub_dist, ctx);
+        for (int i=0; i<n; i++) {
+            ret4 |= point_cmp(group, shares[i], decoded_shares[i], ctx);
+            point_free(decoded_shares[i]);
+        }
+        ret4 |= point_cmp(group, reshare_pi.R3, decoded_reshare_pi.R3, ctx);
+        ret4 |= BN_cmp(reshare_pi.z1, decoded_reshare_pi.z1) != 0;
+        ret4 |= BN_cmp(reshare_pi.z2, decoded_reshare_pi.z2) != 0;
+        point_free(decoded_pub_dist);
+        nizk_reshare_proof_free(&decoded_reshare_pi);
+    }
+    free(buf);
+    if (print) {
+        printf("%6s Test 2 - 4: Reshare transcript round trip %s\n", ret4 ? "NOT OK" : "OK", ret4 ? "failed" : "succeeded");
+    }
+
+    // cleanup
+    for (int i=0; i<n; i++) {
+        point_free(shares[i]);
+    }
+    point_free(pub_dist);
+    nizk_dl_eq_proof_free(&dl_eq_pi);
+    nizk_reshare_proof_free(&reshare_pi);
+    BN_CTX_free(ctx);
+
+    return !(ret1 == 0 && ret2 != 0 && ret3 == 0 && ret4 == 0);
+}
+
+static int dh_pvss_wire_test_3(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+    const size_t point_len = dh_pvss_wire_point_len(group);
+    const int n = 10;
+
+    // valid points pass the scan
+    EC_POINT *points[n];
+    for (int i=0; i<n; i++) {
+        points[i] = point_random(group, ctx);
+    }
+    unsigned char buf[n * point_len];
+    dh_pvss_wire_encode_points(group, buf, n, (const EC_POINT **)points, ctx);
+    EC_POINT *decoded_points[n];
+    int ret1 = dh_pvss_wire_decode_points_validated(group, buf, n, decoded_points, 0, ctx);
+    if (ret1 == 0) {
+        for (int i=0; i<n; i++) {
+            point_free(decoded_points[i]);
+        }
+    }
+    if (print) {
+        printf("%6s Test 3 - 1: Valid points %s accepted by validation\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT" : "indeed");
+    }
+
+    // x-coordinate equal to the field prime, uncompressed prefix, and infinity where not allowed
+    unsigned char bad[n * point_len];
+    memcpy(bad, buf, sizeof(bad));
+    BIGNUM *prime = bn_new();
+    EC_GROUP_get_curve(group, prime, NULL, NULL, ctx);
+    BN_bn2binpad(prime, bad + 4 * point_len + 1, (int)point_len - 1);
+    bn_free(prime);
+    int ret2 = dh_pvss_wire_scan_points(group, bad, n, 1, ctx);
+    memcpy(bad, buf, sizeof(bad));
+    bad[9 * point_len] = 0x04;
+    ret2 &= dh_pvss_wire_scan_points(group, bad, n, 1, ctx);
+    memcpy(bad, buf, sizeof(bad));
+    memset(bad + 2 * point_len, 0, point_len);
+    int ret3 = dh_pvss_wire_scan_points(group, bad, n, 1, ctx);
+    ret2 &= dh_pvss_wire_scan_points(group, bad, n, 0, ctx);
+    if (print) {
+        if (ret2 && ret3 == 0) {
+            printf("    OK Test 3 - 2: Malformed encodings not accepted by scan (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 3 - 2: Malformed encoding IS accepted by scan, or valid one rejected (which is an ERROR)\n");
+        }
+    }
+
+    // an x-coordinate with no point on P-256 above it passes the scan, but not decoding
+    memcpy(bad, buf, sizeof(bad));
+    unsigned char *off_curve = bad + 6 * point_len;
+    EC_POINT *probe = point_new(group);
+    memset(off_curve, 0, point_len);
+    off_curve[0] = 0x02;
+    for (int x=1; x<256; x++) {
+        off_curve[point_len - 1] = (unsigned char)x;
+        if (EC_POINT_oct2point(group, probe, off_curve, point_len, ctx) != 1) {
+            break;
+        }
+    }
+    point_free(probe);
+    int ret7 = dh_pvss_wire_scan_points(group, bad, n, 0, ctx);
+    int ret8 = dh_pvss_wire_decode_points_validated(group, bad, n, decoded_points, 0, ctx);
+    if (ret8 == 0) {
+        for (int i=0; i<n; i++) {
+            point_free(decoded_points[i]);
+        }
+    }
+    if (print) {
+        if (ret7 == 0 && ret8) {
+            printf("    OK Test 3 - 3: Point not on the curve not accepted (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 3 - 3: Point not on the curve IS accepted, or rejected by the scan (which is an ERROR)\n");
+        }
+    }
+
+    // points outside the prime order subgroup, on a curve with cofactor 4 (P-256 has cofactor 1)
+    EC_GROUP *small_group = EC_GROUP_new_by_curve_name(NID_secp112r2);
+    int ret4 = 1, ret5 = 0;
+    const int skipped = small_group == NULL;
+    if (small_group) {
+        const size_t small_point_len = dh_pvss_wire_point_len(small_group);
+        unsigned char encoding[small_point_len];
+        EC_POINT *p = point_new(small_group);
+        EC_POINT *q = point_new(small_group);
+        BIGNUM *order = bn_new();
+        EC_GROUP_get_order(small_group, order, ctx);
+        for (int x=1, found=0; !found && x<1000; x++) { // a point with a component of small order
+            memset(encoding, 0, small_point_len);
+            encoding[0] = 0x02;
+            encoding[small_point_len - 1] = (unsigned char)x;
+            encoding[small_point_len - 2] = (unsigned char)(x >> 8);
+            if (EC_POINT_oct2point(small_group, p, encoding, small_point_len, ctx) == 1) {
+                point_mul(small_group, q, order, p, ctx);
+                found = !EC_POINT_is_at_infinity(small_group, q);
+            }
+        }
+        const EC_POINT *outside[] = { EC_GROUP_get0_generator(small_group), p };
+        ret4 = dh_pvss_wire_check_subgroup(small_group, 2, outside, ctx);
+        BIGNUM *cofactor = bn_new();
+        EC_GROUP_get_cofactor(small_group, cofactor, ctx);
+        point_mul(small_group, q, cofactor, p, ctx); // cofactor clearing moves p into the subgroup
+        const EC_POINT *inside[] = { EC_GROUP_get0_generator(small_group), q };
+        ret5 = dh_pvss_wire_check_subgroup(small_group, 2, inside, ctx);
+        bn_free(cofactor);
+        bn_free(order);
+        point_free(p);
+        point_free(q);
+        EC_GROUP_free(small_group);
+    }
+    if (print) {
+        if (skipped) {
+            printf("    OK Test 3 - 4: Point outside the subgroup skipped (secp112r2 not available)\n");
+        } else if (ret4 && ret5 == 0) {
+            printf("    OK Test 3 - 4: Point outside the subgroup not accepted (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 3 - 4: Point outside the subgroup IS accepted, or point inside rejected (which is an ERROR)\n");
+        }
+    }
+
+    // a distribution transcript holding the point at infinity is rejected
+    nizk_dl_eq_proof pi = { point_random(group, ctx), point_random(group, ctx), bn_random(get0_order(group), ctx) };
+    EC_POINT_set_to_infinity(group, points[3]);
+    size_t len = dh_pvss_wire_distribution_len(group, n);
+    unsigned char *transcript = malloc(len);
+    dh_pvss_wire_encode_distribution(group, transcript, n, points[0], (const EC_POINT **)points, &pi, ctx);
+    EC_POINT *decoded_pub_dist;
+    nizk_dl_eq_proof decoded_pi;
+    int ret6 = dh_pvss_wire_decode_distribution(group, transcript, len, n, &decoded_pub_dist, decoded_points, &decoded_pi, ctx);
+    free(transcript);
+    if (print) {
+        if (ret6) {
+            printf("    OK Test 3 - 5: Transcript with point at infinity not accepted (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 3 - 5: Transcript with point at infinity IS accepted (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    for (int i=0; i<n; i++) {
+        point_free(points[i]);
+    }
+    nizk_dl_eq_proof_free(&pi);
+    BN_CTX_free(ctx);
+
+    return !(ret1 == 0 && ret2 && ret3 == 0 && ret7 == 0 && ret8 && ret4 && ret5 == 0 && ret6);
+}
+
+static int dh_pvss_wire_test_4(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+    const int num_valid_indices = 4;
+    const int next_n = 12;
+
+    const int n = 9;
+    int valid_indices[] = { 7, 2, 9, 3 }; // in arrival order
+    EC_POINT *shares[next_n];
+    for (int j=0; j<next_n; j++) {
+        shares[j] = point_random(group, ctx);
+    }
+
+    // round trip
+    size_t len = dh_pvss_wire_aggregate_len(group, num_valid_indices, next_n);
+    unsigned char *buf = malloc(len);
+    size_t written = dh_pvss_wire_encode_aggregate(group, buf, num_valid_indices, valid_indices, next_n, (const EC_POINT **)shares, ctx);
+    int decoded_indices[num_valid_indices];
+    EC_POINT *decoded_shares[next_n];
+    int ret1 = written != len || dh_pvss_wire_decode_aggregate(group, buf, len, n, num_valid_indices, decoded_indices, next_n, decoded_shares, ctx);
+    if (ret1 == 0) {
+        ret1 |= memcmp(valid_indices, decoded_indices, sizeof(valid_indices)) != 0;
+        for (int j=0; j<next_n; j++) {
+            ret1 |= point_cmp(group, shares[j], decoded_shares[j], ctx);
+            point_free(decoded_shares[j]);
+        }
+    }
+    if (print) {
+        printf("%6s Test 4 - 1: Aggregate transcript round trip %s\n", ret1 ? "NOT OK" : "OK", ret1 ? "failed" : "succeeded");
+    }
+
+    // index beyond the committee, repeated index, and a different number of indices
+    int ret2 = dh_pvss_wire_decode_aggregate(group, buf, len, n - 1, num_valid_indices, decoded_indices, next_n, decoded_shares, ctx);
+    buf[DH_PVSS_WIRE_HEADER_LEN + 4 + 2 * 4 + 3] = 7;
+    ret2 &= dh_pvss_wire_decode_aggregate(group, buf, len, n, num_valid_indices, decoded_indices, next_n, decoded_shares, ctx);
+    ret2 &= dh_pvss_wire_decode_aggregate(group, buf, len, n, num_valid_indices - 1, decoded_indices, next_n, decoded_shares, ctx);
+    if (print) {
+        printf("%6s Test 4 - 2: Malformed aggregate transcript %s\n", ret2 ? "OK" : "NOT OK", ret2 ? "rejected" : "ACCEPTED");
+    }
+
+    // cleanup
+    free(buf);
+    for (int j=0; j<next_n; j++) {
+        point_free(shares[j]);
+    }
+    BN_CTX_free(ctx);
+
+    return ret1 || !ret2;
+}
+
+typedef int (*test_function)(int);
+
+static test_function test_suite[] = {
+    &dh_pvss_wire_test_1,
+    &dh_pvss_wire_test_2,
+    &dh_pvss_wire_test_3,
+    &dh_pvss_wire_test_4
+};
+
+// return test results
+//   0 = passed (all individual tests passed)
+//   1 = failed (one or more individual tests failed)
+// setting print to 0 (zero) suppresses stdio printouts, while print 1 is 'verbose'
+int dh_pvss_wire_test_suite(int print) {
+    if (print) {
+        printf("DH PVSS wire format test suite BEGIN ----------------\n");
+    }
+    int num_tests = sizeof(test_suite)/sizeof(test_function);
+    int ret = 0;
+    for (int i=0; i<num_tests; i++) {
+        if (test_suite[i](print)) {
+            ret = 1;
+        }
+    }
+    if (print) {
+        printf("DH PVSS wire format test suite END ------------------\n");
+#ifdef DEBUG
+        print_allocation_status();
+#endif
+        fflush(stdout);
+    }
+    return ret;
+}
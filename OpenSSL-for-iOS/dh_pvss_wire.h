@@ -0,0 +1,81 @@
+//
+//  dh_pvss_wire.h
+//  OpenSSL-for-iOS
+//
+
+#ifndef DH_PVSS_WIRE_H
+#define DH_PVSS_WIRE_H
+#include "P256.h"
+#include "nizk_dl_eq.h"
+#include "nizk_reshare.h"
+
+/* compact binary encoding of transcripts
+ * every transcript starts with an 8 byte header: magic "PV", version, type, and a 32 bit big-endian count
+ * points are compressed in fixed-width slots (33 bytes for P-256, an all-zero slot is the point at infinity)
+ * and scalars are fixed-width big-endian (32 bytes for P-256), so every field is at a fixed offset
+ *
+ *   distribution: header(n) | pub_dist | enc_shares[n] | Ra | Rb | z
+ *   decryption:   header(1) | decrypted_share | Ra | Rb | z
+ *   reshare:      header(n) | party_index (32 bit) | party_dist_pub_key | enc_re_shares[n] | R1 | R2 | R3 | z1 | z2
+ *                 (n is the size of the next committee)
+ *   aggregate:    header(n) | num_valid_indices (32 bit) | valid_indices[num_valid_indices] (32 bit) | reconstructed_shares[n]
+ *                 (n is the size of the next committee, see dh_pvss_reshare_aggregate_verify_share)
+ *
+ * encoders return the number of bytes written, which is given by the corresponding _len function
+ * decoders return 0 on success and 1 if the input is malformed, in which case nothing is allocated
+ * transcript decoders validate all points (see dh_pvss_wire_decode_points_validated) and reject the point at infinity */
+
+#define DH_PVSS_WIRE_VERSION 1
+#define DH_PVSS_WIRE_HEADER_LEN 8
+
+typedef enum {
+    DH_PVSS_WIRE_DISTRIBUTION = 1,
+    DH_PVSS_WIRE_DECRYPTION = 2,
+    DH_PVSS_WIRE_RESHARE = 3,
+    DH_PVSS_WIRE_AGGREGATE = 4
+} dh_pvss_wire_type;
+
+size_t dh_pvss_wire_point_len(const EC_GROUP *group);
+size_t dh_pvss_wire_scalar_len(const EC_GROUP *group);
+
+// header
+void dh_pvss_wire_encode_header(unsigned char *buf, dh_pvss_wire_type type, int count);
+int dh_pvss_wire_decode_header(const unsigned char *buf, size_t len, dh_pvss_wire_type type, int *count);
+
+// bulk point encoding (points are made affine in batches, sharing one field inversion per batch)
+void dh_pvss_wire_encode_points(const EC_GROUP *group, unsigned char *buf, int num_points, const EC_POINT *points[], BN_CTX *ctx);
+int dh_pvss_wire_decode_points(const EC_GROUP *group, const unsigned char *buf, int num_points, EC_POINT *points[], BN_CTX *ctx);
+
+// validation of incoming points, in order of cost: structure of the encodings, curve membership (by decoding), subgroup
+int dh_pvss_wire_scan_points(const EC_GROUP *group, const unsigned char *buf, int num_points, int allow_infinity, BN_CTX *ctx);
+int dh_pvss_wire_check_subgroup(const EC_GROUP *group, int num_points, const EC_POINT *points[], BN_CTX *ctx);
+int dh_pvss_wire_decode_points_validated(const EC_GROUP *group, const unsigned char *buf, int num_points, EC_POINT *points[], int allow_infinity, BN_CTX *ctx);
+
+// scalars, decoding rejects values that are not reduced modulo the group order
+void dh_pvss_wire_encode_scalar(const EC_GROUP *group, unsigned char *buf, const BIGNUM *scalar);
+BIGNUM *dh_pvss_wire_decode_scalar(const EC_GROUP *group, const unsigned char *buf);
+
+// distribution transcripts
+size_t dh_pvss_wire_distribution_len(const EC_GROUP *group, int n);
+size_t dh_pvss_wire_encode_distribution(const EC_GROUP *group, unsigned char *buf, int n, const EC_POINT *pub_dist, const EC_POINT *enc_shares[], const nizk_dl_eq_proof *pi, BN_CTX *ctx);
+int dh_pvss_wire_decode_distribution(const EC_GROUP *group, const unsigned char *buf, size_t len, int n, EC_POINT **pub_dist, EC_POINT *enc_shares[], nizk_dl_eq_proof *pi, BN_CTX *ctx);
+
+// decryption transcripts (decrypted share and its proof)
+size_t dh_pvss_wire_decryption_len(const EC_GROUP *group);
+size_t dh_pvss_wire_encode_decryption(const EC_GROUP *group, unsigned char *buf, const EC_POINT *decrypted_share, const nizk_dl_eq_proof *pi, BN_CTX *ctx);
+int dh_pvss_wire_decode_decryption(const EC_GROUP *group, const unsigned char *buf, size_t len, EC_POINT **decrypted_share, nizk_dl_eq_proof *pi, BN_CTX *ctx);
+
+// reshare transcripts
+size_t dh_pvss_wire_reshare_len(const EC_GROUP *group, int next_n);
+size_t dh_pvss_wire_encode_reshare(const EC_GROUP *group, unsigned char *buf, int next_n, int party_index, const EC_POINT *party_dist_pub_key, const EC_POINT *enc_re_shares[], const nizk_reshare_proof *pi, BN_CTX *ctx);
+int dh_pvss_wire_decode_reshare(const EC_GROUP *group, const unsigned char *buf, size_t len, int next_n, int *party_index, EC_POINT **party_dist_pub_key, EC_POINT *enc_re_shares[], nizk_reshare_proof *pi, BN_CTX *ctx);
+
+// reshare aggregates (valid indices and reconstructed shares), in any order
+// decoding rejects indices that are repeated or outside 1..n, n being the size of the committee that reshared
+size_t dh_pvss_wire_aggregate_len(const EC_GROUP *group, int num_valid_indices, int next_n);
+size_t dh_pvss_wire_encode_aggregate(const EC_GROUP *group, unsigned char *buf, int num_valid_indices, const int *valid_indices, int next_n, const EC_POINT *reconstructed_shares[], BN_CTX *ctx);
+int dh_pvss_wire_decode_aggregate(const EC_GROUP *group, const unsigned char *buf, size_t len, int n, int num_valid_indices, int *valid_indices, int next_n, EC_POINT *reconstructed_shares[], BN_CTX *ctx);
+
+int dh_pvss_wire_test_suite(int print);
+
+#endif /* DH_PVSS_WIRE_H */
@@ -4,6 +4,12 @@
 #include "nizk_dl_eq.h"
 #include "nizk_reshare.h"
 #include "dh_pvss.h"
+#include "dh_pvss_wire.h"
+#include "dh_pvss_cache.h"
+#include "dh_pvss_accumulator.h"
+#include "dh_pvss_handover.h"
+#include "dh_pvss_registry.h"
+#include "dh_pvss_remote.h"
 
 static void test_suite_correctness(void) {
     const int print = 1;
@@ -11,6 +17,12 @@ static void test_suite_correctness(void) {
     nizk_dl_eq_test_suite(print);
     nizk_reshare_test_suite(print);
     dh_pvss_test_suite(print);
+    dh_pvss_wire_test_suite(print);
+    dh_pvss_cache_test_suite(print);
+    dh_pvss_accumulator_test_suite(print);
+    dh_pvss_handover_test_suite(print);
+    dh_pvss_registry_test_suite(print);
+    dh_pvss_remote_test_suite(print);
 }
 
 static void print_committee_size_vector(int len, int *v) {
@@ -6,11 +6,12 @@
 //
 #include "nizk_dl.h"
 #include <assert.h>
+#include <stdatomic.h>
 #include "openssl_hashing_tools.h"
 
 #ifdef DEBUG
-static int num_initialized = 0;
-static int num_freed = 0;
+static atomic_int num_initialized = 0;
+static atomic_int num_freed = 0;
 
 void nizk_dl_print_allocation_status(void) {
     printf("nizk_dl: initalized %d, freed %d (%d diff)\n", num_initialized, num_freed, num_initialized - num_freed);
@@ -86,6 +87,91 @@ int nizk_dl_verify(const EC_GROUP *group, const EC_POINT *X, const nizk_dl_proof
     return ret;
 }
 
+/* check proofs lo..hi-1 with the precomputed challenges c, by the random linear combination
+ *   sum_i r_i * (z_i*G - c_i*X_i - u_i) = 0
+ * evaluated as a single multi-scalar multiplication, where the generator terms fold into a single term (which
+ * uses the precomputed generator table), giving 1 + 2*(hi-lo) terms */
+static int nizk_dl_verify_combined(const EC_GROUP *group, int lo, int hi, const EC_POINT *X[], const nizk_dl_proof *pi[], BIGNUM *c[], BN_CTX *ctx) {
+    const BIGNUM *order = get0_order(group);
+    const int num_terms = 2 * (hi - lo);
+
+    const EC_POINT **points = malloc(num_terms * sizeof(EC_POINT *));
+    assert(points && "nizk_dl_verify_combined: allocation error (points)");
+    BIGNUM **scalars = bn_new_array(num_terms);
+    BIGNUM *z_sum = bn_new(); // sum_i r_i * z_i
+    BIGNUM *tmp = bn_new();
+    for (int i=lo; i<hi; i++) {
+        int j = 2 * (i - lo);
+        BIGNUM *weight = bn_random(order, ctx);
+        BN_mod_mul(tmp, weight, pi[i]->z, order, ctx);
+        BN_mod_add(z_sum, z_sum, tmp, order, ctx);
+        BN_mod_mul(tmp, weight, c[i], order, ctx);
+        points[j] = X[i];
+        BN_mod_sub(scalars[j], order, tmp, order, ctx); // -r_i * c_i
+        points[j + 1] = pi[i]->u;
+        BN_mod_sub(scalars[j + 1], order, weight, order, ctx); // -r_i
+        bn_free(weight);
+    }
+    EC_POINT *sum = point_new(group);
+    int ret = EC_POINTs_mul(group, sum, z_sum, num_terms, points, (const BIGNUM **)scalars, ctx); // no wrapper for EC_POINTs_mul
+    assert(ret == 1 && "nizk_dl_verify_combined: EC_POINTs_mul failed");
+    ret = EC_POINT_is_at_infinity(group, sum) ? 0 : 1;
+
+    // cleanup
+    point_free(sum);
+    bn_free(tmp);
+    bn_free(z_sum);
+    bn_free_array(num_terms, scalars);
+    free(points);
+
+    return ret;
+}
+
+// split a failing range in halves until the failing proofs are found
+static int nizk_dl_verify_bisect(const EC_GROUP *group, int lo, int hi, const EC_POINT *X[], const nizk_dl_proof *pi[], BIGNUM *c[], int *results, BN_CTX *ctx) {
+    int ret = nizk_dl_verify_combined(group, lo, hi, X, pi, c, ctx);
+    if (ret == 0 || hi - lo == 1) {
+        for (int i=lo; i<hi; i++) {
+            results[i] = ret;
+        }
+        return ret;
+    }
+    int mid = lo + (hi - lo) / 2;
+    int ret_lo = nizk_dl_verify_bisect(group, lo, mid, X, pi, c, results, ctx);
+    int ret_hi = nizk_dl_verify_bisect(group, mid, hi, X, pi, c, results, ctx);
+    return ret_lo | ret_hi;
+}
+
+/* verify num_proofs proofs of knowledge of the discrete logarithms of X[i]
+ * returns 0 if all proofs are valid (up to a probability of error of about num_proofs/order) and 1 otherwise
+ * if results is not NULL, a failing batch is bisected and results[i] is set to 0 (valid) or 1 (invalid) for proof i */
+int nizk_dl_verify_batch(const EC_GROUP *group, int num_proofs, const EC_POINT *X[], const nizk_dl_proof *pi[], int *results, BN_CTX *ctx) {
+    assert(num_proofs > 0 && "nizk_dl_verify_batch: usage error, no proofs passed");
+    const EC_POINT *generator = get0_generator(group);
+
+    // compute challenges
+    BIGNUM **c = malloc(num_proofs * sizeof(BIGNUM *));
+    assert(c && "nizk_dl_verify_batch: allocation error (challenges)");
+    for (int i=0; i<num_proofs; i++) {
+        c[i] = openssl_hash_points2bn(group, ctx, 3, generator, X[i], pi[i]->u);
+    }
+
+    int ret;
+    if (results) {
+        ret = nizk_dl_verify_bisect(group, 0, num_proofs, X, pi, c, results, ctx);
+    } else {
+        ret = nizk_dl_verify_combined(group, 0, num_proofs, X, pi, c, ctx);
+    }
+
+    // cleanup
+    for (int i=0; i<num_proofs; i++) {
+        bn_free(c[i]);
+    }
+    free(c);
+
+    return ret;
+}
+
 /*
  *
  *  nizk_dl tests
@@ -195,12 +281,66 @@ static int nizk_dl_test_3(int print) {
     return !(ret1 == 0 && ret2 != 0);
 }
 
+static int nizk_dl_test_4(int print) {
+    const EC_GROUP *group = get0_group();
+    const BIGNUM *order = get0_order(group);
+    BN_CTX *ctx = BN_CTX_new();
+    const int num_proofs = 20;
+
+    // correct proofs
+    BIGNUM *x[num_proofs];
+    EC_POINT *X[num_proofs];
+    nizk_dl_proof proofs[num_proofs];
+    const nizk_dl_proof *pi[num_proofs];
+    for (int i=0; i<num_proofs; i++) {
+        x[i] = bn_random(order, ctx);
+        X[i] = bn2point(group, x[i], ctx);
+        nizk_dl_prove(group, x[i], &proofs[i], ctx);
+        pi[i] = &proofs[i];
+    }
+    int ret1 = nizk_dl_verify_batch(group, num_proofs, (const EC_POINT **)X, pi, NULL, ctx);
+    if (print) {
+        printf("%6s Test 4 - 1: Correct NIZK DL Proofs %s accepted in batch\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT" : "indeed");
+    }
+
+    // two incorrect proofs are found by bisection
+    const int bad_1 = 3;
+    const int bad_2 = 16;
+    pi[bad_1] = &proofs[bad_1 + 1];
+    BN_add_word(proofs[bad_2].z, 1);
+    int results[num_proofs];
+    int ret2 = nizk_dl_verify_batch(group, num_proofs, (const EC_POINT **)X, pi, results, ctx);
+    int num_misjudged = 0;
+    for (int i=0; i<num_proofs; i++) {
+        num_misjudged += results[i] != (i == bad_1 || i == bad_2);
+    }
+    if (print) {
+        if (ret2 && num_misjudged == 0) {
+            printf("    OK Test 4 - 2: Incorrect NIZK DL Proofs not accepted in batch, and found (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 4 - 2: Incorrect NIZK DL Proofs accepted in batch, or not found (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    for (int i=0; i<num_proofs; i++) {
+        nizk_dl_proof_free(&proofs[i]);
+        point_free(X[i]);
+        bn_free(x[i]);
+    }
+    BN_CTX_free(ctx);
+
+    // return test results
+    return !(ret1 == 0 && ret2 != 0 && num_misjudged == 0);
+}
+
 typedef int (*test_function)(int);
 
 static test_function test_suite[] = {
     &nizk_dl_test_1,
     &nizk_dl_test_2,
-    &nizk_dl_test_3
+    &nizk_dl_test_3,
+    &nizk_dl_test_4
 };
 
 // return test results
@@ -16,6 +16,7 @@ typedef struct {
 
 void nizk_dl_prove(const EC_GROUP *group, const BIGNUM *x, nizk_dl_proof *pi, BN_CTX *ctx);
 int nizk_dl_verify(const EC_GROUP *group, const EC_POINT *X, const nizk_dl_proof *pi, BN_CTX *ctx);
+int nizk_dl_verify_batch(const EC_GROUP *group, int num_proofs, const EC_POINT *X[], const nizk_dl_proof *pi[], int *results, BN_CTX *ctx);
 void nizk_dl_proof_free(nizk_dl_proof *pi);
 
 int nizk_dl_test_suite(int print);
@@ -6,11 +6,12 @@
 //
 #include "nizk_dl_eq.h"
 #include <assert.h>
+#include <stdatomic.h>
 #include "openssl_hashing_tools.h"
 
 #ifdef DEBUG
-static int num_initialized = 0;
-static int num_freed = 0;
+static atomic_int num_initialized = 0;
+static atomic_int num_freed = 0;
 
 void nizk_dl_eq_print_allocation_status(void) {
     printf("nizk_dl_eq: initalized %d, freed %d (%d diff)\n", num_initialized, num_freed, num_initialized - num_freed);
@@ -98,6 +99,131 @@ int nizk_dl_eq_verify(const EC_GROUP *group, const EC_POINT *a, const EC_POINT *
     return 0; // verification successful
 }
 
+// proofs that log_a(A[i]) = log_b(B[i]), with a common first base a, and a second base b that is either common or b_list[i]
+typedef struct {
+    const EC_POINT *a;
+    const EC_POINT *b; // NULL if b_list is used
+    const EC_POINT **A;
+    const EC_POINT **b_list;
+    const EC_POINT **B;
+    const nizk_dl_eq_proof **pi;
+    BIGNUM **c; // challenges
+} nizk_dl_eq_batch;
+
+/* check proofs lo..hi-1 of batch, by the random linear combination
+ * sum_i rho_i * (z_i*a + c_i*A_i - Ra_i) + sigma_i * (z_i*b_i + c_i*B_i - Rb_i) = 0
+ * evaluated as a single multi-scalar multiplication, where a common base (a, and b if common) is a single term,
+ * giving 1 + 5*(hi-lo) terms, or 2 + 4*(hi-lo) terms with a common b */
+static int nizk_dl_eq_verify_combined(const EC_GROUP *group, const nizk_dl_eq_batch *batch, int lo, int hi, BN_CTX *ctx) {
+    const BIGNUM *order = get0_order(group);
+    const int num_fixed = batch->b ? 2 : 1;
+    const int num_per_proof = batch->b ? 4 : 5;
+    const int num_terms = num_fixed + num_per_proof * (hi - lo);
+
+    const EC_POINT **points = malloc(num_terms * sizeof(EC_POINT *));
+    assert(points && "nizk_dl_eq_verify_combined: allocation error (points)");
+    BIGNUM **scalars = bn_new_array(num_terms);
+    points[0] = batch->a;
+    BN_zero(scalars[0]); // sum_i rho_i * z_i
+    if (batch->b) {
+        points[1] = batch->b;
+        BN_zero(scalars[1]); // sum_i sigma_i * z_i
+    }
+    BIGNUM *tmp = bn_new();
+    for (int i=lo; i<hi; i++) {
+        const nizk_dl_eq_proof *pi = batch->pi[i];
+        int j = num_fixed + num_per_proof * (i - lo);
+        BIGNUM *rho = bn_random(order, ctx);
+        BIGNUM *sigma = bn_random(order, ctx);
+        BN_mod_mul(tmp, rho, pi->z, order, ctx);
+        BN_mod_add(scalars[0], scalars[0], tmp, order, ctx);
+        points[j] = batch->A[i];
+        BN_mod_mul(scalars[j++], rho, batch->c[i], order, ctx);
+        points[j] = pi->Ra;
+        BN_mod_sub(scalars[j++], order, rho, order, ctx); // -rho
+        if (batch->b) {
+            BN_mod_mul(tmp, sigma, pi->z, order, ctx);
+            BN_mod_add(scalars[1], scalars[1], tmp, order, ctx);
+        } else {
+            points[j] = batch->b_list[i];
+            BN_mod_mul(scalars[j++], sigma, pi->z, order, ctx);
+        }
+        points[j] = batch->B[i];
+        BN_mod_mul(scalars[j++], sigma, batch->c[i], order, ctx);
+        points[j] = pi->Rb;
+        BN_mod_sub(scalars[j++], order, sigma, order, ctx); // -sigma
+        bn_free(rho);
+        bn_free(sigma);
+    }
+    EC_POINT *sum = point_new(group);
+    int ret = EC_POINTs_mul(group, sum, NULL, num_terms, points, (const BIGNUM **)scalars, ctx); // no wrapper for EC_POINTs_mul
+    assert(ret == 1 && "nizk_dl_eq_verify_combined: EC_POINTs_mul failed");
+    ret = EC_POINT_is_at_infinity(group, sum) ? 0 : 1;
+
+    // cleanup
+    point_free(sum);
+    bn_free(tmp);
+    bn_free_array(num_terms, scalars);
+    free(points);
+
+    return ret;
+}
+
+// split a failing range in halves until the failing proofs are found
+static int nizk_dl_eq_verify_bisect(const EC_GROUP *group, const nizk_dl_eq_batch *batch, int lo, int hi, int *results, BN_CTX *ctx) {
+    int ret = nizk_dl_eq_verify_combined(group, batch, lo, hi, ctx);
+    if (ret == 0 || hi - lo == 1) {
+        for (int i=lo; i<hi; i++) {
+            results[i] = ret;
+        }
+        return ret;
+    }
+    int mid = lo + (hi - lo) / 2;
+    int ret_lo = nizk_dl_eq_verify_bisect(group, batch, lo, mid, results, ctx);
+    int ret_hi = nizk_dl_eq_verify_bisect(group, batch, mid, hi, results, ctx);
+    return ret_lo | ret_hi;
+}
+
+static int nizk_dl_eq_verify_batch_run(const EC_GROUP *group, nizk_dl_eq_batch *batch, int num_proofs, int *results, BN_CTX *ctx) {
+    assert(num_proofs > 0 && "nizk_dl_eq_verify_batch: usage error, no proofs passed");
+
+    // compute challenges
+    BIGNUM *c[num_proofs];
+    for (int i=0; i<num_proofs; i++) {
+        const EC_POINT *b = batch->b ? batch->b : batch->b_list[i];
+        c[i] = openssl_hash_points2bn(group, ctx, 6, batch->a, batch->A[i], b, batch->B[i], batch->pi[i]->Ra, batch->pi[i]->Rb);
+    }
+    batch->c = c;
+
+    int ret;
+    if (results) {
+        ret = nizk_dl_eq_verify_bisect(group, batch, 0, num_proofs, results, ctx);
+    } else {
+        ret = nizk_dl_eq_verify_combined(group, batch, 0, num_proofs, ctx);
+    }
+
+    // cleanup
+    for (int i=0; i<num_proofs; i++) {
+        bn_free(c[i]);
+    }
+
+    return ret;
+}
+
+/* verify num_proofs proofs that share the first base a, i.e., proofs that log_a(A[i]) = log_b[i](B[i])
+ * returns 0 if all proofs are valid (up to a probability of error of about num_proofs/order) and 1 otherwise
+ * if results is not NULL, a failing batch is bisected and results[i] is set to 0 (valid) or 1 (invalid) for proof i */
+int nizk_dl_eq_verify_batch(const EC_GROUP *group, const EC_POINT *a, int num_proofs, const EC_POINT *A[], const EC_POINT *b[], const EC_POINT *B[], const nizk_dl_eq_proof *pi[], int *results, BN_CTX *ctx) {
+    nizk_dl_eq_batch batch = { a, NULL, A, b, B, pi, NULL };
+    return nizk_dl_eq_verify_batch_run(group, &batch, num_proofs, results, ctx);
+}
+
+// same as nizk_dl_eq_verify_batch, for proofs that share both bases, i.e., proofs that log_a(A[i]) = log_b(B[i])
+int nizk_dl_eq_verify_batch_same_bases(const EC_GROUP *group, const EC_POINT *a, const EC_POINT *b, int num_proofs, const EC_POINT *A[], const EC_POINT *B[], const nizk_dl_eq_proof *pi[], int *results, BN_CTX *ctx) {
+    nizk_dl_eq_batch batch = { a, b, A, NULL, B, pi, NULL };
+    return nizk_dl_eq_verify_batch_run(group, &batch, num_proofs, results, ctx);
+}
+
 /*
  *
  *  nizk_dl_eq tests
@@ -209,11 +335,70 @@ static int nizk_dl_eq_test_2(int print) {
     return !(ret1 == 0 && ret2 != 0);
 }
 
+static int nizk_dl_eq_test_3(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+    const EC_POINT *a = get0_generator(group);
+    const int num_proofs = 7;
+    const int bad_index = 5;
+
+    // produce correct proofs
+    BIGNUM *exp[num_proofs];
+    EC_POINT *A[num_proofs];
+    EC_POINT *b[num_proofs];
+    EC_POINT *B[num_proofs];
+    nizk_dl_eq_proof pi[num_proofs];
+    const nizk_dl_eq_proof *pi_list[num_proofs];
+    for (int i=0; i<num_proofs; i++) {
+        exp[i] = bn_random(get0_order(group), ctx);
+        A[i] = bn2point(group, exp[i], ctx);
+        b[i] = point_random(group, ctx);
+        B[i] = point_new(group);
+        point_mul(group, B[i], exp[i], b[i], ctx);
+        nizk_dl_eq_prove(group, exp[i], a, A[i], b[i], B[i], &pi[i], ctx);
+        pi_list[i] = &pi[i];
+    }
+    int ret1 = nizk_dl_eq_verify_batch(group, a, num_proofs, (const EC_POINT **)A, (const EC_POINT **)b, (const EC_POINT **)B, pi_list, NULL, ctx);
+    if (print) {
+        printf("%6s Test 3 - 1: Batch of correct NIZK DL EQ Proofs %s accepted\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT" : "indeed");
+    }
+
+    // negative test, one bad B-value, which should be located by bisection
+    point_add(group, B[bad_index], B[bad_index], b[bad_index], ctx);
+    int results[num_proofs];
+    int ret2 = nizk_dl_eq_verify_batch(group, a, num_proofs, (const EC_POINT **)A, (const EC_POINT **)b, (const EC_POINT **)B, pi_list, results, ctx);
+    int num_misplaced = 0;
+    for (int i=0; i<num_proofs; i++) {
+        num_misplaced += results[i] != (i == bad_index);
+    }
+    if (print) {
+        if (ret2 && num_misplaced == 0) {
+            printf("    OK Test 3 - 2: Batch with incorrect NIZK DL EQ Proof not accepted, and bad proof located (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 3 - 2: Batch with incorrect NIZK DL EQ Proof IS accepted, or bad proof not located (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    for (int i=0; i<num_proofs; i++) {
+        nizk_dl_eq_proof_free(&pi[i]);
+        bn_free(exp[i]);
+        point_free(A[i]);
+        point_free(b[i]);
+        point_free(B[i]);
+    }
+    BN_CTX_free(ctx);
+
+    // return test results
+    return !(ret1 == 0 && ret2 != 0 && num_misplaced == 0);
+}
+
 typedef int (*test_function)(int);
 
 static test_function test_suite[] = {
     &nizk_dl_eq_test_1,
-    &nizk_dl_eq_test_2
+    &nizk_dl_eq_test_2,
+    &nizk_dl_eq_test_3
 };
 
 int nizk_dl_eq_test_suite(int print) {
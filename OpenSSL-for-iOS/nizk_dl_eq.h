@@ -17,6 +17,8 @@ typedef struct {
 
 void nizk_dl_eq_prove(const EC_GROUP *group, const BIGNUM *exp, const EC_POINT *a, const EC_POINT *A, const EC_POINT *b, const EC_POINT *B, nizk_dl_eq_proof *pi, BN_CTX *ctx);
 int nizk_dl_eq_verify(const EC_GROUP *group, const EC_POINT *a, const EC_POINT *A, const EC_POINT *b, const EC_POINT *B, const nizk_dl_eq_proof *pi, BN_CTX *ctx);
+int nizk_dl_eq_verify_batch(const EC_GROUP *group, const EC_POINT *a, int num_proofs, const EC_POINT *A[], const EC_POINT *b[], const EC_POINT *B[], const nizk_dl_eq_proof *pi[], int *results, BN_CTX *ctx);
+int nizk_dl_eq_verify_batch_same_bases(const EC_GROUP *group, const EC_POINT *a, const EC_POINT *b, int num_proofs, const EC_POINT *A[], const EC_POINT *B[], const nizk_dl_eq_proof *pi[], int *results, BN_CTX *ctx);
 void nizk_dl_eq_proof_free(nizk_dl_eq_proof *pi);
 
 int nizk_dl_eq_test_suite(int print);
@@ -6,11 +6,12 @@
 //
 #include "nizk_reshare.h"
 #include <assert.h>
+#include <stdatomic.h>
 #include "openssl_hashing_tools.h"
 
 #ifdef DEBUG
-static int num_initialized = 0;
-static int num_freed = 0;
+static atomic_int num_initialized = 0;
+static atomic_int num_freed = 0;
 
 void nizk_reshare_print_allocation_status(void) {
     printf("nizk_reshare: initalized %d, freed %d (%d diff)\n", num_initialized, num_freed, num_initialized - num_freed);
@@ -81,56 +82,155 @@ void nizk_reshare_prove(const EC_GROUP *group, const BIGNUM *w1, const BIGNUM *w
     // implicitly return proof pi
 }
 
+/* the three verification equations, each as one multi-scalar multiplication that shares its doublings
+ *   z1*ga - c*Y1 = R1,   z2*ga - c*Y2 = R2,   z2*gb - z1*gc - c*Y3 = R3
+ * the negated scalars are taken from ctx, so that a single point is all that is allocated */
 int nizk_reshare_verify(const EC_GROUP *group, const EC_POINT *ga, const EC_POINT *gb, const EC_POINT *gc, const EC_POINT *Y1, const EC_POINT *Y2, const EC_POINT *Y3, const nizk_reshare_proof *pi, BN_CTX *ctx) {
+    const BIGNUM *order = get0_order(group);
+
     // compute c
     BIGNUM *c = openssl_hash_points2bn(group, ctx, 9, ga, gb, gc, Y1, Y2, Y3, pi->R1, pi->R2, pi->R3);
 
+    BN_CTX_start(ctx);
+    BIGNUM *neg_c = BN_CTX_get(ctx);
+    BIGNUM *neg_z1 = BN_CTX_get(ctx);
+    assert(neg_z1 && "nizk_reshare_verify: BN_CTX_get failed");
+    BN_mod_sub(neg_c, order, c, order, ctx);
+    BN_mod_sub(neg_z1, order, pi->z1, order, ctx);
+    EC_POINT *lhs = point_new(group);
+
     // check dl for Y1
-    EC_POINT *cY1 = point_new(group);
-    point_mul(group, cY1, c, Y1, ctx);
-    EC_POINT *R1cY1 = point_new(group);
-    point_add(group, R1cY1, pi->R1, cY1, ctx);
-    EC_POINT *z1ga = point_new(group);
-    point_mul(group, z1ga, pi->z1, ga, ctx);
-    int ret1 = point_cmp(group, R1cY1, z1ga, ctx);
-    
+    const EC_POINT *points[3] = { ga, Y1 };
+    const BIGNUM *scalars[3] = { pi->z1, neg_c };
+    int ret = EC_POINTs_mul(group, lhs, NULL, 2, points, scalars, ctx); // no wrapper for EC_POINTs_mul
+    assert(ret == 1 && "nizk_reshare_verify: EC_POINTs_mul failed");
+    int ret1 = point_cmp(group, lhs, pi->R1, ctx);
+
     // check dl for Y2
-    EC_POINT *cY2 = point_new(group);
-    point_mul(group, cY2, c, Y2, ctx);
-    EC_POINT *R2cY2 = point_new(group);
-    point_add(group, R2cY2, pi->R2, cY2, ctx);
-    EC_POINT *z2ga = point_new(group);
-    point_mul(group, z2ga, pi->z2, ga, ctx);
-    int ret2 = point_cmp(group, R2cY2, z2ga, ctx);
+    points[1] = Y2;
+    scalars[0] = pi->z2;
+    ret = EC_POINTs_mul(group, lhs, NULL, 2, points, scalars, ctx);
+    assert(ret == 1 && "nizk_reshare_verify: EC_POINTs_mul failed");
+    int ret2 = point_cmp(group, lhs, pi->R2, ctx);
 
     // check pedersen commitment for Y3
-    EC_POINT *cY3 = point_new(group);
-    point_mul(group, cY3, c, Y3, ctx);
-    EC_POINT *R3cY3 = point_new(group);
-    point_add(group, R3cY3, pi->R3, cY3, ctx);
-    EC_POINT *z2gb = point_new(group);
-    point_mul(group, z2gb, pi->z2, gb, ctx);
-    EC_POINT *z1gc = point_new(group);
-    point_mul(group, z1gc, pi->z1, gc, ctx);
-    EC_POINT *z2gb_z1gc = point_new(group);
-    point_sub(group, z2gb_z1gc, z2gb, z1gc, ctx);
-    int ret3 = point_cmp(group, R3cY3, z2gb_z1gc, ctx);
+    points[0] = gb;
+    points[1] = gc;
+    points[2] = Y3;
+    scalars[0] = pi->z2;
+    scalars[1] = neg_z1;
+    scalars[2] = neg_c;
+    ret = EC_POINTs_mul(group, lhs, NULL, 3, points, scalars, ctx);
+    assert(ret == 1 && "nizk_reshare_verify: EC_POINTs_mul failed");
+    int ret3 = point_cmp(group, lhs, pi->R3, ctx);
 
     // cleanup
-    point_free(z2gb_z1gc);
-    point_free(z1gc);
-    point_free(z2gb);
-    point_free(R3cY3);
-    point_free(cY3);
-    point_free(z2ga);
-    point_free(R2cY2);
-    point_free(cY2);
-    point_free(z1ga);
-    point_free(R1cY1);
-    point_free(cY1);
+    point_free(lhs);
+    BN_CTX_end(ctx);
     bn_free(c);
 
-    return !(ret1 == 0 && ret2 == 0 & ret3 == 0);
+    return !(ret1 == 0 && ret2 == 0 && ret3 == 0);
+}
+
+/* check proofs lo..hi-1 with the precomputed challenges c, by the random linear combination over i of
+ *   alpha_i * (z1_i*ga - c_i*Y1_i - R1_i) + beta_i * (z2_i*ga - c_i*Y2_i - R2_i) + gamma_i * (z2_i*gb - z1_i*gc - c_i*Y3_i - R3_i) = 0
+ * evaluated as a single multi-scalar multiplication, where the common bases ga, gb and gc are single terms,
+ * giving 3 + 6*(hi-lo) terms */
+static int nizk_reshare_verify_combined(const EC_GROUP *group, const EC_POINT *ga, const EC_POINT *gb, const EC_POINT *gc, int lo, int hi, const EC_POINT *Y1[], const EC_POINT *Y2[], const EC_POINT *Y3[], const nizk_reshare_proof *pi[], BIGNUM *c[], BN_CTX *ctx) {
+    const BIGNUM *order = get0_order(group);
+    const int num_terms = 3 + 6 * (hi - lo);
+
+    const EC_POINT **points = malloc(num_terms * sizeof(EC_POINT *));
+    assert(points && "nizk_reshare_verify_combined: allocation error (points)");
+    BIGNUM **scalars = bn_new_array(num_terms);
+    points[0] = ga; // sum_i alpha_i * z1_i + beta_i * z2_i
+    points[1] = gb; // sum_i gamma_i * z2_i
+    points[2] = gc; // -sum_i gamma_i * z1_i
+    BN_zero(scalars[0]);
+    BN_zero(scalars[1]);
+    BN_zero(scalars[2]);
+    BIGNUM *tmp = bn_new();
+    for (int i=lo; i<hi; i++) {
+        int j = 3 + 6 * (i - lo);
+        BIGNUM *weights[3];
+        for (int k=0; k<3; k++) {
+            weights[k] = bn_random(order, ctx);
+        }
+        // common bases
+        BN_mod_mul(tmp, weights[0], pi[i]->z1, order, ctx);
+        BN_mod_add(scalars[0], scalars[0], tmp, order, ctx);
+        BN_mod_mul(tmp, weights[1], pi[i]->z2, order, ctx);
+        BN_mod_add(scalars[0], scalars[0], tmp, order, ctx);
+        BN_mod_mul(tmp, weights[2], pi[i]->z2, order, ctx);
+        BN_mod_add(scalars[1], scalars[1], tmp, order, ctx);
+        BN_mod_mul(tmp, weights[2], pi[i]->z1, order, ctx);
+        BN_mod_sub(scalars[2], scalars[2], tmp, order, ctx);
+        // per proof terms
+        const EC_POINT *Y[3] = { Y1[i], Y2[i], Y3[i] };
+        const EC_POINT *R[3] = { pi[i]->R1, pi[i]->R2, pi[i]->R3 };
+        for (int k=0; k<3; k++) {
+            BN_mod_mul(tmp, weights[k], c[i], order, ctx);
+            points[j] = Y[k];
+            BN_mod_sub(scalars[j++], order, tmp, order, ctx); // -weight * c
+            points[j] = R[k];
+            BN_mod_sub(scalars[j++], order, weights[k], order, ctx); // -weight
+            bn_free(weights[k]);
+        }
+    }
+    EC_POINT *sum = point_new(group);
+    int ret = EC_POINTs_mul(group, sum, NULL, num_terms, points, (const BIGNUM **)scalars, ctx); // no wrapper for EC_POINTs_mul
+    assert(ret == 1 && "nizk_reshare_verify_combined: EC_POINTs_mul failed");
+    ret = EC_POINT_is_at_infinity(group, sum) ? 0 : 1;
+
+    // cleanup
+    point_free(sum);
+    bn_free(tmp);
+    bn_free_array(num_terms, scalars);
+    free(points);
+
+    return ret;
+}
+
+// split a failing range in halves until the failing proofs are found
+static int nizk_reshare_verify_bisect(const EC_GROUP *group, const EC_POINT *ga, const EC_POINT *gb, const EC_POINT *gc, int lo, int hi, const EC_POINT *Y1[], const EC_POINT *Y2[], const EC_POINT *Y3[], const nizk_reshare_proof *pi[], BIGNUM *c[], int *results, BN_CTX *ctx) {
+    int ret = nizk_reshare_verify_combined(group, ga, gb, gc, lo, hi, Y1, Y2, Y3, pi, c, ctx);
+    if (ret == 0 || hi - lo == 1) {
+        for (int i=lo; i<hi; i++) {
+            results[i] = ret;
+        }
+        return ret;
+    }
+    int mid = lo + (hi - lo) / 2;
+    int ret_lo = nizk_reshare_verify_bisect(group, ga, gb, gc, lo, mid, Y1, Y2, Y3, pi, c, results, ctx);
+    int ret_hi = nizk_reshare_verify_bisect(group, ga, gb, gc, mid, hi, Y1, Y2, Y3, pi, c, results, ctx);
+    return ret_lo | ret_hi;
+}
+
+/* verify num_proofs proofs that share the bases ga, gb and gc
+ * returns 0 if all proofs are valid (up to a probability of error of about num_proofs/order) and 1 otherwise
+ * if results is not NULL, a failing batch is bisected and results[i] is set to 0 (valid) or 1 (invalid) for proof i */
+int nizk_reshare_verify_batch(const EC_GROUP *group, const EC_POINT *ga, const EC_POINT *gb, const EC_POINT *gc, int num_proofs, const EC_POINT *Y1[], const EC_POINT *Y2[], const EC_POINT *Y3[], const nizk_reshare_proof *pi[], int *results, BN_CTX *ctx) {
+    assert(num_proofs > 0 && "nizk_reshare_verify_batch: usage error, no proofs passed");
+
+    // compute challenges
+    BIGNUM *c[num_proofs];
+    for (int i=0; i<num_proofs; i++) {
+        c[i] = openssl_hash_points2bn(group, ctx, 9, ga, gb, gc, Y1[i], Y2[i], Y3[i], pi[i]->R1, pi[i]->R2, pi[i]->R3);
+    }
+
+    int ret;
+    if (results) {
+        ret = nizk_reshare_verify_bisect(group, ga, gb, gc, 0, num_proofs, Y1, Y2, Y3, pi, c, results, ctx);
+    } else {
+        ret = nizk_reshare_verify_combined(group, ga, gb, gc, 0, num_proofs, Y1, Y2, Y3, pi, c, ctx);
+    }
+
+    // cleanup
+    for (int i=0; i<num_proofs; i++) {
+        bn_free(c[i]);
+    }
+
+    return ret;
 }
 
 int nizk_reshare_test_1(int print) {
@@ -257,11 +357,85 @@ int nizk_reshare_test_2(int print) {
     return ret1 != 0 && neg_ret_sum == 6;
 }
 
+int nizk_reshare_test_3(int print) {
+    const EC_GROUP *group = get0_group();
+    BN_CTX *ctx = BN_CTX_new();
+
+    // proofs for random witnesses over common bases
+    const int num_proofs = 7;
+    const int bad_proof = 4;
+    EC_POINT *ga = point_random(group, ctx);
+    EC_POINT *gb = point_random(group, ctx);
+    EC_POINT *gc = point_random(group, ctx);
+    EC_POINT *Y1[num_proofs];
+    EC_POINT *Y2[num_proofs];
+    EC_POINT *Y3[num_proofs];
+    nizk_reshare_proof pis[num_proofs];
+    const nizk_reshare_proof *pi_list[num_proofs];
+    EC_POINT *w2gb = point_new(group);
+    EC_POINT *w1gc = point_new(group);
+    for (int i=0; i<num_proofs; i++) {
+        BIGNUM *w1 = bn_random(get0_order(group), ctx);
+        BIGNUM *w2 = bn_random(get0_order(group), ctx);
+        Y1[i] = point_new(group);
+        Y2[i] = point_new(group);
+        Y3[i] = point_new(group);
+        point_mul(group, Y1[i], w1, ga, ctx);
+        point_mul(group, Y2[i], w2, ga, ctx);
+        point_mul(group, w2gb, w2, gb, ctx);
+        point_mul(group, w1gc, w1, gc, ctx);
+        point_sub(group, Y3[i], w2gb, w1gc, ctx);
+        nizk_reshare_prove(group, w1, w2, ga, gb, gc, Y1[i], Y2[i], Y3[i], &pis[i], ctx);
+        pi_list[i] = &pis[i];
+        bn_free(w1);
+        bn_free(w2);
+    }
+
+    // positive test
+    int ret1 = nizk_reshare_verify_batch(group, ga, gb, gc, num_proofs, (const EC_POINT**)Y1, (const EC_POINT**)Y2, (const EC_POINT**)Y3, pi_list, NULL, ctx);
+    if (print) {
+        printf("%6s Test 3 - 1: Batch of correct NIZK Reshare Proofs %s accepted\n", ret1 ? "NOT OK" : "OK", ret1 ? "NOT" : "indeed");
+    }
+
+    // negative test, one proof with a bad Y3, which is located
+    point_add(group, Y3[bad_proof], Y3[bad_proof], ga, ctx);
+    int results[num_proofs];
+    int ret2 = nizk_reshare_verify_batch(group, ga, gb, gc, num_proofs, (const EC_POINT**)Y1, (const EC_POINT**)Y2, (const EC_POINT**)Y3, pi_list, results, ctx);
+    int num_misplaced = 0;
+    for (int i=0; i<num_proofs; i++) {
+        num_misplaced += results[i] != (i == bad_proof);
+    }
+    if (print) {
+        if (ret2 && num_misplaced == 0) {
+            printf("    OK Test 3 - 2: Batch with incorrect NIZK Reshare Proof not accepted, and bad proof located (which is CORRECT)\n");
+        } else {
+            printf("NOT OK Test 3 - 2: Batch with incorrect NIZK Reshare Proof IS accepted, or bad proof not located (which is an ERROR)\n");
+        }
+    }
+
+    // cleanup
+    for (int i=0; i<num_proofs; i++) {
+        nizk_reshare_proof_free(&pis[i]);
+        point_free(Y1[i]);
+        point_free(Y2[i]);
+        point_free(Y3[i]);
+    }
+    point_free(w2gb);
+    point_free(w1gc);
+    point_free(ga);
+    point_free(gb);
+    point_free(gc);
+    BN_CTX_free(ctx);
+
+    return !(ret1 == 0 && ret2 != 0 && num_misplaced == 0);
+}
+
 typedef int (*test_function)(int);
 
 static test_function test_suite[] = {
     &nizk_reshare_test_1,
-    &nizk_reshare_test_2
+    &nizk_reshare_test_2,
+    &nizk_reshare_test_3
 };
 
 int nizk_reshare_test_suite(int print) {
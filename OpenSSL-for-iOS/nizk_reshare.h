@@ -19,6 +19,7 @@ typedef struct {
 
 void nizk_reshare_prove(const EC_GROUP *group, const BIGNUM *w1, const BIGNUM *w2, const EC_POINT *ga, const EC_POINT *gb, const EC_POINT *gc, const EC_POINT *Y1, const EC_POINT *Y2, const EC_POINT *Y3, nizk_reshare_proof *pi, BN_CTX *ctx);
 int nizk_reshare_verify(const EC_GROUP *group, const EC_POINT *ga, const EC_POINT *gb, const EC_POINT *gc, const EC_POINT *Y1, const EC_POINT *Y2, const EC_POINT *Y3, const nizk_reshare_proof *pi, BN_CTX *ctx);
+int nizk_reshare_verify_batch(const EC_GROUP *group, const EC_POINT *ga, const EC_POINT *gb, const EC_POINT *gc, int num_proofs, const EC_POINT *Y1[], const EC_POINT *Y2[], const EC_POINT *Y3[], const nizk_reshare_proof *pi[], int *results, BN_CTX *ctx);
 void nizk_reshare_proof_free(nizk_reshare_proof *pi);
 
 int nizk_reshare_test_suite(int print);
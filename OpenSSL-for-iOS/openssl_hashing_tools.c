@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <string.h>
 #include "openssl_hashing_tools.h"
 
 void openssl_hash_init(SHA256_CTX *ctx) {
@@ -131,17 +132,71 @@ BIGNUM *openssl_hash_point_lists2bn(const EC_GROUP *group, BN_CTX *bn_ctx, int n
     return bn;
 }
 
-void openssl_hash_points2poly(const EC_GROUP *group, BN_CTX *ctx, int num_coeffs, BIGNUM *poly_coeff[], int num_point_lists, int *num_points, const EC_POINT ***point_list) {
-    const BIGNUM *order = get0_order(group);
+size_t openssl_point_encoding_len(const EC_GROUP *group) {
+    size_t len = (EC_GROUP_get_degree(group) + 7) / 8 + 1;
+    return len;
+}
+
+// write compressed encoding of point to buf (openssl_point_encoding_len(group) bytes)
+// the encoding is the same as the one hashed by openssl_hash_update_point
+void openssl_point_encode(const EC_GROUP *group, const EC_POINT *point, unsigned char *buf, BN_CTX *bn_ctx) {
+    size_t len = openssl_point_encoding_len(group);
+    if (EC_POINT_is_at_infinity(group, point)) {
+        memset(buf, 0, len); // infinity is encoded as a single zero byte, pad the slot
+        return;
+    }
+    size_t ret = EC_POINT_point2oct(group, point, POINT_CONVERSION_COMPRESSED, buf, len, bn_ctx);
+    assert(ret == len && "openssl_point_encode: unexpected length");
+}
+
+// same as calling openssl_hash_update_point for each of the encoded points
+void openssl_hash_update_encoded_points(SHA256_CTX *sha_ctx, size_t encoding_len, int num_points, const unsigned char *encoded_points) {
+    const unsigned char *run = encoded_points; // hash runs of consecutive finite points in one go
+    const unsigned char *p = encoded_points;
+    for (int i=0; i<num_points; i++, p += encoding_len) {
+        if (p[0] == 0x00) { // point at infinity
+            SHA256_Update(sha_ctx, run, p - run);
+            SHA256_Update(sha_ctx, p, 1);
+            run = p + encoding_len;
+        }
+    }
+    SHA256_Update(sha_ctx, run, p - run);
+}
+
+// same as openssl_hash_point_list2bn, but for encoded points
+BIGNUM *openssl_hash_encoded_points2bn(size_t encoding_len, int num_points, const unsigned char *encoded_points) {
+    SHA256_CTX sha_ctx;
+    openssl_hash_init(&sha_ctx);
+    openssl_hash_update_encoded_points(&sha_ctx, encoding_len, num_points, encoded_points);
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    openssl_hash_final(hash, &sha_ctx);
+    BIGNUM *bn = openssl_hash2bignum(hash);
+    return bn;
+}
 
+void openssl_hash_points2poly(const EC_GROUP *group, BN_CTX *ctx, int num_coeffs, BIGNUM *poly_coeff[], int num_point_lists, int *num_points, const EC_POINT ***point_list) {
     assert(num_point_lists > 0 && "openssl_hash_points2poly: usage error, no point lists passed");
     BIGNUM *list_digest[num_point_lists];
     for (int i=0; i<num_point_lists; i++) {
         list_digest[i] = openssl_hash_point_list2bn(group, ctx, num_points[i], point_list[i]);
     }
 
+    openssl_hash_digests2poly(group, ctx, num_coeffs, poly_coeff, num_point_lists, (const BIGNUM **)list_digest);
+
+    // cleanup
+    for (int i=0; i<num_point_lists; i++) {
+        bn_free(list_digest[i]);
+    }
+}
+
+// second half of openssl_hash_points2poly, for callers that have already hashed the point lists
+void openssl_hash_digests2poly(const EC_GROUP *group, BN_CTX *ctx, int num_coeffs, BIGNUM *poly_coeff[], int num_digests, const BIGNUM *list_digest[]) {
+    const BIGNUM *order = get0_order(group);
+
+    assert(num_digests > 0 && "openssl_hash_digests2poly: usage error, no digests passed");
+
     // hash chain coefficients
-    poly_coeff[0] = openssl_hash_bn_list2bn(num_point_lists, (const BIGNUM**)list_digest);
+    poly_coeff[0] = openssl_hash_bn_list2bn(num_digests, list_digest);
     for (int i=1; i<num_coeffs; i++) {
         poly_coeff[i] = openssl_hash_bn2bn(poly_coeff[i-1]);
     }
@@ -150,9 +205,4 @@ void openssl_hash_points2poly(const EC_GROUP *group, BN_CTX *ctx, int num_coeffs
     for (int i=0; i<num_coeffs; i++) {
         BN_nnmod(poly_coeff[i], poly_coeff[i], order, ctx);
     }
-
-    // cleanup
-    for (int i=0; i<num_point_lists; i++) {
-        bn_free(list_digest[i]);
-    }
 }
@@ -29,7 +29,15 @@ BIGNUM *openssl_hash_points2bn(const EC_GROUP *group, BN_CTX *bn_ctx, int num_po
 BIGNUM *openssl_hash_point_list2bn(const EC_GROUP *group, BN_CTX *bn_ctx, int list_len, const EC_POINT *point_list[]);
 BIGNUM *openssl_hash_point_lists2bn(const EC_GROUP *group, BN_CTX *bn_ctx, int num_lists, int *list_len, const EC_POINT **point_list[]);
 
+// hashing encoded points
+// (point encodings are compressed and stored in fixed-width slots, a slot starting with 0x00 holds the point at infinity)
+size_t openssl_point_encoding_len(const EC_GROUP *group);
+void openssl_point_encode(const EC_GROUP *group, const EC_POINT *point, unsigned char *buf, BN_CTX *bn_ctx);
+void openssl_hash_update_encoded_points(SHA256_CTX *sha_ctx, size_t encoding_len, int num_points, const unsigned char *encoded_points);
+BIGNUM *openssl_hash_encoded_points2bn(size_t encoding_len, int num_points, const unsigned char *encoded_points);
+
 // hash points to polynomial
 void openssl_hash_points2poly(const EC_GROUP *group, BN_CTX *ctx, int num_coeffs, BIGNUM *poly_coeff[], int num_point_lists, int *num_points, const EC_POINT ***point_list);
+void openssl_hash_digests2poly(const EC_GROUP *group, BN_CTX *ctx, int num_coeffs, BIGNUM *poly_coeff[], int num_digests, const BIGNUM *list_digest[]);
 
 #endif
@@ -0,0 +1,72 @@
+//
+//  parallel_tools.c
+//  OpenSSL-for-iOS
+//
+
+#include "parallel_tools.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+typedef struct {
+    parallel_chunk_function fn;
+    void *arg;
+    int chunk;
+    int from;
+    int to;
+} parallel_chunk;
+
+static void *parallel_chunk_run(void *p) {
+    parallel_chunk *c = (parallel_chunk *)p;
+    BN_CTX *ctx = BN_CTX_new(); // BN_CTX is not thread safe, so each worker gets its own
+    assert(ctx && "parallel_chunk_run: BN_CTX allocation failed");
+    c->fn(c->chunk, c->from, c->to, ctx, c->arg);
+    BN_CTX_free(ctx);
+    return NULL;
+}
+
+int parallel_num_chunks(int num_threads, int num_items) {
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    if (num_items < 1) {
+        return 1;
+    }
+    return num_threads < num_items ? num_threads : num_items;
+}
+
+void parallel_for(int num_threads, int num_items, parallel_chunk_function fn, void *arg, BN_CTX *ctx) {
+    assert(fn && "parallel_for: usage error, no work function");
+    assert(ctx && "parallel_for: usage error, no BIGNUM context specified");
+    const int num_chunks = parallel_num_chunks(num_threads, num_items);
+    if (num_chunks == 1) {
+        fn(0, 0, num_items, ctx, arg); // serial case, no threads involved
+        return;
+    }
+
+    // chunk boundaries differ by at most one item
+    parallel_chunk chunks[num_chunks];
+    for (int c=0; c<num_chunks; c++) {
+        chunks[c].fn = fn;
+        chunks[c].arg = arg;
+        chunks[c].chunk = c;
+        chunks[c].from = (int)((long long)num_items * c / num_chunks);
+        chunks[c].to = (int)((long long)num_items * (c+1) / num_chunks);
+    }
+
+    // run chunks 1.. in worker threads, and chunk 0 on the calling thread
+    pthread_t threads[num_chunks];
+    int started[num_chunks];
+    for (int c=1; c<num_chunks; c++) {
+        started[c] = pthread_create(&threads[c], NULL, parallel_chunk_run, &chunks[c]) == 0;
+        if (!started[c]) {
+            parallel_chunk_run(&chunks[c]); // could not create thread, so do the work here instead
+        }
+    }
+    fn(0, chunks[0].from, chunks[0].to, ctx, arg);
+    for (int c=1; c<num_chunks; c++) {
+        if (started[c]) {
+            pthread_join(threads[c], NULL);
+        }
+    }
+}
@@ -0,0 +1,21 @@
+//
+//  parallel_tools.h
+//  OpenSSL-for-iOS
+//
+
+#ifndef PARALLEL_TOOLS_H
+#define PARALLEL_TOOLS_H
+#include <openssl/bn.h>
+
+// work function for one chunk [from, to) of a parallel loop, chunk is the chunk number (0, 1, ...)
+typedef void (*parallel_chunk_function)(int chunk, int from, int to, BN_CTX *ctx, void *arg);
+
+// number of chunks that parallel_for splits num_items into when using num_threads
+int parallel_num_chunks(int num_threads, int num_items);
+
+// split [0, num_items) into contiguous chunks and run fn on each chunk in a thread of its own
+// every worker thread gets its own BN_CTX, the first chunk is run on the calling thread using ctx
+// returns when all chunks are done
+void parallel_for(int num_threads, int num_items, parallel_chunk_function fn, void *arg, BN_CTX *ctx);
+
+#endif /* PARALLEL_TOOLS_H */
@@ -4,6 +4,7 @@
 #include <mach/mach_time.h>
 #include <mach/mach.h>
 #include <mach/mach_init.h>
+#include <time.h>
 //#include <mach/task_info.h>
 //#include <mach/vm_statistics.h>
 #include <unistd.h>
@@ -51,6 +52,20 @@ double platform_utils_get_wall_time_diff(platform_time_type start_time, platform
 #endif
 }
 
+double platform_utils_get_thread_cpu_time(void) {
+#if PLATFORM_TYPE == PLATFORM_TYPE_MAC || PLATFORM_TYPE == PLATFORM_TYPE_UNIX
+    struct timespec t;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t)) {
+        return -1; // error, could not get time
+    }
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+#elif PLATFORM_TYPE == PLATFORM_TYPE_WINDOWS
+  return (double)clock() / CLOCKS_PER_SEC;
+#else
+#error "unsupported platform type (not implemented for this platform)"
+#endif
+}
+
 // measure the max RAM memory footprint of the current process
 uint64_t platform_utils_get_max_memory_usage(void) {
 #if PLATFORM_TYPE == PLATFORM_TYPE_MAC
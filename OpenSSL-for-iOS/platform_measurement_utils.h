@@ -19,6 +19,9 @@ typedef clock_t platform_time_type;
 platform_time_type platform_utils_get_wall_time(void);
 double platform_utils_get_wall_time_diff(platform_time_type start_time, platform_time_type end_time);
 
+// CPU time of the calling thread, in seconds (process CPU time on Windows)
+double platform_utils_get_thread_cpu_time(void);
+
 uint64_t platform_utils_get_max_memory_usage(void);
 
 #endif